@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/SoAHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+using Bin = EPHist::DoubleBinWithError;
+
+static void DoubleBinWithError_Add(benchmark::State &state) {
+  EPHist::EPHist<Bin> h1(state.range(0), 0.0, 1.0);
+  EPHist::EPHist<Bin> h2(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    h1.Add(h2);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(DoubleBinWithError_Add)->Range(1024, 1 << 22);
+
+static void DoubleBinWithError_SoA_Add(benchmark::State &state) {
+  EPHist::SoAHist<Bin> h1(state.range(0), 0.0, 1.0);
+  EPHist::SoAHist<Bin> h2(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    h1.Add(h2);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(DoubleBinWithError_SoA_Add)->Range(1024, 1 << 22);
+
+// Sum the weights of all bins, without the squared weights.
+static void DoubleBinWithError_SumOfWeights(benchmark::State &state) {
+  EPHist::EPHist<Bin> h1(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+      sum += h1.GetBinContent(i).fSum;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(DoubleBinWithError_SumOfWeights)->Range(1024, 1 << 22);
+
+static void DoubleBinWithError_SoA_SumOfWeights(benchmark::State &state) {
+  EPHist::SoAHist<Bin> h1(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    double sum = 0;
+    for (double w : h1.GetColumn(0)) {
+      sum += w;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(DoubleBinWithError_SoA_SumOfWeights)->Range(1024, 1 << 22);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -0,0 +1,8 @@
+#define ALL_BENCHMARKS
+#include "int_categorical1D_ComputeBinLinear.cxx"
+#include "int_categorical1D_Fill.cxx"
+#include "int_intcategorical1D_Fill.cxx"
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
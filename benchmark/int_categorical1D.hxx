@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef INT_CATEGORICAL_1D
+#define INT_CATEGORICAL_1D
+
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct IntCategorical1D : public benchmark::Fixture {
+  // The histogram is constructed in SetUp because the number of categories is
+  // a parameter of the benchmark, given by state.range(0).
+  std::unique_ptr<EPHist::EPHist<int>> h1;
+  std::vector<std::string> fCategories;
+  std::vector<std::string_view> fValues;
+
+  void SetUp(benchmark::State &state) {
+    // Names similar to trigger paths, with a long common prefix.
+    const std::size_t numCategories = state.range(0);
+    fCategories.clear();
+    for (std::size_t i = 0; i < numCategories; i++) {
+      fCategories.push_back("HLT_IsoMu24_eta2p1_v" + std::to_string(i));
+    }
+    h1.reset(new EPHist::EPHist<int>(EPHist::CategoricalAxis(fCategories)));
+
+    // Pick random categories, including some that are not on the axis.
+    static const std::string Unknown = "HLT_Unknown";
+    std::mt19937 gen;
+    std::uniform_int_distribution<std::size_t> dis(0, numCategories);
+    fValues.resize(32768);
+    for (std::size_t i = 0; i < fValues.size(); i++) {
+      const std::size_t c = dis(gen);
+      fValues[i] = c < numCategories ? fCategories[c] : Unknown;
+    }
+  }
+
+  void TearDown(benchmark::State &) { h1.reset(); }
+};
+
+#endif
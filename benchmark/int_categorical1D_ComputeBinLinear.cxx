@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_categorical1D.hxx"
+
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+#include <utility>
+#include <variant>
+
+// Compare the lookup of CategoricalAxis::ComputeBin with a plain linear search
+// over all categories.
+BENCHMARK_DEFINE_F(IntCategorical1D, ComputeBin)(benchmark::State &state) {
+  const auto &axis = std::get<EPHist::CategoricalAxis>(h1->GetAxes()[0]);
+  for (auto _ : state) {
+    for (auto value : fValues) {
+      benchmark::DoNotOptimize(axis.ComputeBin(value));
+    }
+  }
+}
+BENCHMARK_REGISTER_F(IntCategorical1D, ComputeBin)
+    ->RangeMultiplier(2)
+    ->Range(2, 1024);
+
+static std::pair<std::size_t, bool>
+ComputeBinLinear(const EPHist::CategoricalAxis &axis, std::string_view x) {
+  const auto &categories = axis.GetCategories();
+  for (std::size_t bin = 0; bin < categories.size(); bin++) {
+    if (categories[bin] == x) {
+      return {bin, true};
+    }
+  }
+  return {categories.size(), axis.IsOverflowBinEnabled()};
+}
+
+BENCHMARK_DEFINE_F(IntCategorical1D, ComputeBinLinear)
+(benchmark::State &state) {
+  const auto &axis = std::get<EPHist::CategoricalAxis>(h1->GetAxes()[0]);
+  for (auto _ : state) {
+    for (auto value : fValues) {
+      benchmark::DoNotOptimize(ComputeBinLinear(axis, value));
+    }
+  }
+}
+BENCHMARK_REGISTER_F(IntCategorical1D, ComputeBinLinear)
+    ->RangeMultiplier(2)
+    ->Range(2, 1024);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_categorical1D.hxx"
+
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntCategorical1D, Fill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (auto value : fValues) {
+      h1->Fill(value);
+    }
+    h1->Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntCategorical1D, Fill)
+    ->RangeMultiplier(2)
+    ->Range(2, 1024);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
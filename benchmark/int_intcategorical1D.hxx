@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef INT_INTCATEGORICAL_1D
+#define INT_INTCATEGORICAL_1D
+
+#include <EPHist/EPHist.hxx>
+#include <EPHist/IntCategoricalAxis.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct IntIntCategorical1D : public benchmark::Fixture {
+  // The histogram is constructed in SetUp because the number of categories is
+  // a parameter of the benchmark, given by state.range(0). If state.range(1)
+  // is non-zero, the categories are spread out to use the hash table instead
+  // of the dense table.
+  std::unique_ptr<EPHist::EPHist<int>> h1;
+  std::vector<std::int64_t> fValues;
+
+  void SetUp(benchmark::State &state) {
+    const std::size_t numCategories = state.range(0);
+    const std::int64_t stride = state.range(1) ? 1000003 : 1;
+    std::vector<std::int64_t> categories;
+    for (std::size_t i = 0; i < numCategories; i++) {
+      categories.push_back(100000 + i * stride);
+    }
+    h1.reset(
+        new EPHist::EPHist<int>(EPHist::IntCategoricalAxis(categories)));
+
+    // Pick random categories, including some that are not on the axis.
+    std::mt19937 gen;
+    std::uniform_int_distribution<std::size_t> dis(0, numCategories);
+    fValues.resize(32768);
+    for (std::size_t i = 0; i < fValues.size(); i++) {
+      const std::size_t c = dis(gen);
+      fValues[i] = c < numCategories ? categories[c] : -1;
+    }
+  }
+
+  void TearDown(benchmark::State &) { h1.reset(); }
+};
+
+#endif
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_intcategorical1D.hxx"
+
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntIntCategorical1D, Fill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (auto value : fValues) {
+      h1->Fill(value);
+    }
+    h1->Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntIntCategorical1D, Fill)
+    ->ArgsProduct({benchmark::CreateRange(2, 1024, /*multi=*/2), {0, 1}});
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -4,6 +4,8 @@
 #define INT_REGULAR_1D
 
 #include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/StaticHist.hxx>
 
 #include <benchmark/benchmark.h>
 
@@ -15,6 +17,8 @@ struct IntRegular1D : public benchmark::Fixture {
   // optimizations in the benchmark body taking advantage of the (constant)
   // constructor parameters.
   EPHist::EPHist<int> h1{20, 0.0, 1.0};
+  EPHist::StaticHist<int, EPHist::RegularAxis> h1Static{
+      EPHist::RegularAxis(20, 0.0, 1.0)};
   std::vector<double> fNumbers;
 
   void SetUp(benchmark::State &state) {
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+static constexpr std::size_t NumHists = 16;
+
+static void IntRegular1D_Add(benchmark::State &state) {
+  EPHist::EPHist<int> h1(state.range(0), 0.0, 1.0);
+  EPHist::EPHist<int> h2(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    h1.Add(h2);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(IntRegular1D_Add)->Range(1024, 1 << 24);
+
+static void IntRegular1D_Add_Threads(benchmark::State &state) {
+  EPHist::EPHist<int> h1(state.range(0), 0.0, 1.0);
+  EPHist::EPHist<int> h2(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    h1.Add(h2, /*numThreads=*/0);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(IntRegular1D_Add_Threads)->Range(1024, 1 << 24)->UseRealTime();
+
+// Add NumHists histograms one after the other.
+static void IntRegular1D_Add_Sequential(benchmark::State &state) {
+  EPHist::EPHist<int> h1(state.range(0), 0.0, 1.0);
+  std::vector<EPHist::EPHist<int>> hists;
+  for (std::size_t i = 0; i < NumHists; i++) {
+    hists.emplace_back(state.range(0), 0.0, 1.0);
+  }
+  for (auto _ : state) {
+    for (auto &h : hists) {
+      h1.Add(h);
+    }
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(IntRegular1D_Add_Sequential)->Range(1024, 1 << 22);
+
+static void IntRegular1D_Merge(benchmark::State &state) {
+  EPHist::EPHist<int> h1(state.range(0), 0.0, 1.0);
+  std::vector<EPHist::EPHist<int>> hists;
+  std::vector<const EPHist::EPHist<int> *> others;
+  for (std::size_t i = 0; i < NumHists; i++) {
+    hists.emplace_back(state.range(0), 0.0, 1.0);
+  }
+  for (auto &h : hists) {
+    others.push_back(&h);
+  }
+  for (auto _ : state) {
+    h1.Merge(others);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(IntRegular1D_Merge)->Range(1024, 1 << 22);
+
+static void IntRegular1D_Clone(benchmark::State &state) {
+  EPHist::EPHist<int> h1(state.range(0), 0.0, 1.0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(h1.Clone());
+  }
+}
+BENCHMARK(IntRegular1D_Clone)->Range(1024, 1 << 24);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
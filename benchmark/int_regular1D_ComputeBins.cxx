@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_regular1D.hxx"
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/SIMD.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <variant>
+#include <vector>
+
+// Compare the kernels for the batched bin computation of a RegularAxis.
+template <void (*Kernel)(const EPHist::Internal::RegularAxisParameters &,
+                         const double *, std::size_t, std::size_t *)>
+static void ComputeBinsRegular(IntRegular1D &f, benchmark::State &state) {
+  const auto &axis = std::get<EPHist::RegularAxis>(f.h1.GetAxes()[0]);
+  EPHist::Internal::RegularAxisParameters p;
+  p.fLow = axis.GetLow();
+  p.fHigh = axis.GetHigh();
+  p.fInvBinWidth = axis.GetNumBins() / (axis.GetHigh() - axis.GetLow());
+  p.fUnderflowBin = axis.GetNumBins();
+  p.fOverflowBin = axis.GetNumBins() + 1;
+
+  std::vector<std::size_t> bins(f.fNumbers.size());
+  for (auto _ : state) {
+    Kernel(p, f.fNumbers.data(), f.fNumbers.size(), bins.data());
+    benchmark::DoNotOptimize(bins.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_DEFINE_F(IntRegular1D, ComputeBinsScalar)(benchmark::State &state) {
+  ComputeBinsRegular<EPHist::Internal::ComputeBinsRegularScalar>(*this, state);
+}
+BENCHMARK_REGISTER_F(IntRegular1D, ComputeBinsScalar)->Range(0, 32768);
+
+#ifdef EPHIST_SIMD_X86
+BENCHMARK_DEFINE_F(IntRegular1D, ComputeBinsAVX2)(benchmark::State &state) {
+  if (EPHist::Internal::GetSIMDLevel() < EPHist::Internal::SIMDLevel::AVX2) {
+    state.SkipWithError("AVX2 not supported");
+    return;
+  }
+  ComputeBinsRegular<EPHist::Internal::ComputeBinsRegularAVX2>(*this, state);
+}
+BENCHMARK_REGISTER_F(IntRegular1D, ComputeBinsAVX2)->Range(0, 32768);
+
+BENCHMARK_DEFINE_F(IntRegular1D, ComputeBinsAVX512)(benchmark::State &state) {
+  if (EPHist::Internal::GetSIMDLevel() < EPHist::Internal::SIMDLevel::AVX512) {
+    state.SkipWithError("AVX-512 not supported");
+    return;
+  }
+  ComputeBinsRegular<EPHist::Internal::ComputeBinsRegularAVX512>(*this, state);
+}
+BENCHMARK_REGISTER_F(IntRegular1D, ComputeBinsAVX512)->Range(0, 32768);
+#endif
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_regular1D.hxx"
+
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntRegular1D, FillN)(benchmark::State &state) {
+  for (auto _ : state) {
+    h1.FillN(fNumbers.size(), fNumbers.data());
+    h1.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular1D, FillN)->Range(0, 32768);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
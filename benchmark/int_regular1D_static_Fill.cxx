@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_regular1D.hxx"
+
+#include <EPHist/StaticHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntRegular1D, StaticFill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (double number : fNumbers) {
+      h1Static.Fill(number);
+    }
+    h1Static.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular1D, StaticFill)->Range(0, 32768);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -4,6 +4,8 @@
 #define INT_REGULAR_2D
 
 #include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/StaticHist.hxx>
 
 #include <benchmark/benchmark.h>
 
@@ -16,7 +18,12 @@ struct IntRegular2D : public benchmark::Fixture {
   // constructor parameters.
   EPHist::RegularAxis axis{20, 0.0, 1.0};
   EPHist::EPHist<int> h2{{axis, axis}};
+  EPHist::StaticHist<int, EPHist::RegularAxis, EPHist::RegularAxis>
+      h2Static{axis, axis};
   std::vector<double> fNumbers;
+  // The same numbers split into one array per dimension, for batched filling.
+  std::vector<double> fNumbersX;
+  std::vector<double> fNumbersY;
 
   void SetUp(benchmark::State &state) {
     std::mt19937 gen;
@@ -25,6 +32,12 @@ struct IntRegular2D : public benchmark::Fixture {
     for (std::size_t i = 0; i < fNumbers.size(); i++) {
       fNumbers[i] = dis(gen);
     }
+    fNumbersX.resize(state.range(0));
+    fNumbersY.resize(state.range(0));
+    for (std::size_t i = 0; i < fNumbersX.size(); i++) {
+      fNumbersX[i] = fNumbers[2 * i];
+      fNumbersY[i] = fNumbers[2 * i + 1];
+    }
   }
 };
 
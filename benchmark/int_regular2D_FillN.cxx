@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_regular2D.hxx"
+
+#include <EPHist/EPHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntRegular2D, FillN)(benchmark::State &state) {
+  for (auto _ : state) {
+    h2.FillN(fNumbersX.size(), fNumbersX.data(), fNumbersY.data());
+    h2.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular2D, FillN)->Range(0, 32768);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -5,6 +5,9 @@
 
 #include <benchmark/benchmark.h>
 
+#include <array>
+#include <cstddef>
+
 static void IntRegular2D_Slice(benchmark::State &state) {
   EPHist::RegularAxis axis{20, 0.0, 1.0};
   EPHist::EPHist<int> h2{{axis, axis}};
@@ -15,6 +18,18 @@ static void IntRegular2D_Slice(benchmark::State &state) {
 }
 BENCHMARK(IntRegular2D_Slice);
 
+static void IntRegular3D_Slice(benchmark::State &state) {
+  EPHist::RegularAxis axis{200, 0.0, 1.0};
+  EPHist::EPHist<int> h3{{axis, axis, axis}};
+  const auto range = EPHist::BinIndexRange(50, 150);
+  const std::array<EPHist::BinIndexRange, 3> ranges = {range, range, range};
+  const std::size_t numThreads = state.range(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(h3.Slice(ranges, numThreads));
+  }
+}
+BENCHMARK(IntRegular3D_Slice)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+
 #ifndef ALL_BENCHMARKS
 BENCHMARK_MAIN();
 #endif
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/SparseHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+struct IntRegular5D : public benchmark::Fixture {
+  // The histograms have 22^5 (about 5 million) bins, most of which stay empty.
+  EPHist::RegularAxis axis{20, 0.0, 1.0};
+  EPHist::EPHist<int> h5{{axis, axis, axis, axis, axis}};
+  EPHist::SparseHist<int> h5Sparse{{axis, axis, axis, axis, axis}};
+  std::vector<double> fNumbers;
+
+  void SetUp(benchmark::State &state) {
+    std::mt19937 gen;
+    std::uniform_real_distribution<> dis;
+    fNumbers.resize(5 * state.range(0));
+    for (std::size_t i = 0; i < fNumbers.size(); i++) {
+      fNumbers[i] = dis(gen);
+    }
+  }
+};
+
+BENCHMARK_DEFINE_F(IntRegular5D, Fill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < state.range(0); i++) {
+      const double *x = &fNumbers[5 * i];
+      h5.Fill(x[0], x[1], x[2], x[3], x[4]);
+    }
+    h5.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular5D, Fill)->Range(0, 32768);
+
+BENCHMARK_DEFINE_F(IntRegular5D, SparseFill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < state.range(0); i++) {
+      const double *x = &fNumbers[5 * i];
+      h5Sparse.Fill(x[0], x[1], x[2], x[3], x[4]);
+    }
+    h5Sparse.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular5D, SparseFill)->Range(0, 32768);
+
+BENCHMARK_DEFINE_F(IntRegular5D, SparseFillAtomic)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < state.range(0); i++) {
+      const double *x = &fNumbers[5 * i];
+      h5Sparse.FillAtomic(x[0], x[1], x[2], x[3], x[4]);
+    }
+    h5Sparse.Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntRegular5D, SparseFillAtomic)->Range(0, 32768);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
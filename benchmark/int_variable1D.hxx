@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef INT_VARIABLE_1D
+#define INT_VARIABLE_1D
+
+#include <EPHist/EPHist.hxx>
+#include <EPHist/StaticHist.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+struct IntVariable1D : public benchmark::Fixture {
+  // The histogram is constructed in SetUp because the number of bins is a
+  // parameter of the benchmark, given by state.range(0).
+  std::unique_ptr<EPHist::EPHist<int>> h1;
+  using StaticHist = EPHist::StaticHist<int, EPHist::VariableBinAxis>;
+  std::unique_ptr<StaticHist> h1Static;
+  std::vector<double> fNumbers;
+
+  void SetUp(benchmark::State &state) {
+    // Create bin edges with increasing widths, similar to a spectrum of
+    // transverse momenta.
+    const std::size_t numBins = state.range(0);
+    std::vector<double> binEdges;
+    for (std::size_t i = 0; i <= numBins; i++) {
+      const double x = static_cast<double>(i) / numBins;
+      binEdges.push_back(x * x);
+    }
+    const EPHist::VariableBinAxis axis(binEdges);
+    h1.reset(new EPHist::EPHist<int>(axis));
+    h1Static.reset(new StaticHist(axis));
+
+    std::mt19937 gen;
+    std::uniform_real_distribution<> dis;
+    fNumbers.resize(32768);
+    for (std::size_t i = 0; i < fNumbers.size(); i++) {
+      fNumbers[i] = dis(gen);
+    }
+  }
+
+  void TearDown(benchmark::State &) {
+    h1.reset();
+    h1Static.reset();
+  }
+};
+
+#endif
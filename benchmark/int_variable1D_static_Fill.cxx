@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_variable1D.hxx"
+
+#include <EPHist/StaticHist.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntVariable1D, StaticFill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (double number : fNumbers) {
+      h1Static->Fill(number);
+    }
+    h1Static->Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntVariable1D, StaticFill)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "int_variable1D.hxx"
+
+#include <EPHist/EPHist.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_DEFINE_F(IntVariable1D, TemplatedFill)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (double number : fNumbers) {
+      h1->Fill<EPHist::VariableBinAxis>(number);
+    }
+    h1->Clear();
+  }
+}
+BENCHMARK_REGISTER_F(IntVariable1D, TemplatedFill)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+
+#ifndef ALL_BENCHMARKS
+BENCHMARK_MAIN();
+#endif
@@ -16,7 +16,8 @@ static constexpr std::size_t NumNumbers = 128 * 1024 * 1024;
 
 int main(int argc, char *argv[]) {
   if (argc < 4) {
-    fprintf(stderr, "Arguments: bins fills threads <mode> <distribution>\n");
+    fprintf(stderr,
+            "Arguments: bins fills threads <mode> <distribution> <shards>\n");
     return 1;
   }
 
@@ -30,9 +31,13 @@ int main(int argc, char *argv[]) {
   // mode = 1: histograms for each thread + Fill, merge with AddAtomic
   // mode = 2: local histogram per thread + Fill, merge with AddAtomic
   // mode = 3: one histogram with FillAtomic
-  // mode = 10: ParallelHelper + FillContext per thread (Automatic strategy)
+  // mode = 10: ParallelHelper + FillContext per thread (Automatic strategy);
+  //            prints the chosen strategy to compare with modes 11 to 13
   // mode = 11: ParallelHelper + FillContext per thread (Atomic strategy)
   // mode = 12: ParallelHelper + FillContext per thread (PerFillContext strat.)
+  // mode = 13: ParallelHelper + FillContext per thread (Sharded strategy)
+  // mode = 14: ParallelHelper + FillContext per thread (HotBinCache strategy)
+  // mode = 15: ParallelHelper + FillContext per thread (Buffered strategy)
   int mode = 10;
   if (argc > 4) {
     mode = std::atoi(argv[4]);
@@ -49,7 +54,10 @@ int main(int argc, char *argv[]) {
                                 NULL,
                                 "ParallelHelper (Automatic)",
                                 "ParallelHelper (Atomic)",
-                                "ParallelHelper (PerFillContext)"};
+                                "ParallelHelper (PerFillContext)",
+                                "ParallelHelper (Sharded)",
+                                "ParallelHelper (HotBinCache)",
+                                "ParallelHelper (Buffered)"};
   // distribution = 0: single value across all threads
   // distribution = 1: blocks of equidistributed values, to minimize collisions
   // distribution = 2: uniform distribution
@@ -62,6 +70,11 @@ int main(int argc, char *argv[]) {
                                         "normal"};
   printf("mode = %d = '%s', distribution = %d = '%s'\n", mode, Modes[mode],
          distribution, Distributions[distribution]);
+  // shards = 0: default number of shards for the Sharded strategy
+  long shards = 0;
+  if (argc > 6) {
+    shards = std::atol(argv[6]);
+  }
 
   // First prepare an array of numbers outside of the timed section. We do this
   // even for the single values to generate the same memory traffic.
@@ -179,7 +192,7 @@ int main(int argc, char *argv[]) {
     const auto strategy = EPHist::ParallelFillStrategy(mode - 10);
 
     auto h1 = std::make_shared<EPHist::EPHist<int>>(bins, 0.0, 1.0);
-    EPHist::ParallelHelper helper(h1, strategy);
+    EPHist::ParallelHelper helper(h1, strategy, shards);
     auto callFill = [&](unsigned int t) {
       auto context = helper.CreateFillContext();
       std::size_t numberOffset = t * NumNumbers / threads;
@@ -196,6 +209,10 @@ int main(int argc, char *argv[]) {
     for (auto &t : threadsV) {
       t.join();
     }
+
+    printf("strategy = '%s' (%s)\n",
+           EPHist::GetParallelFillStrategyName(helper.GetStrategy()),
+           helper.GetStrategyReason().c_str());
   }
 
   auto end = std::chrono::steady_clock::now();
@@ -2,10 +2,15 @@
 #include "int_regular1D_Fill.cxx"
 #include "int_regular1D_Fill_tuple.cxx"
 #include "int_regular1D_templated_Fill.cxx"
+#include "int_regular1D_static_Fill.cxx"
+#include "int_regular1D_FillN.cxx"
+#include "int_regular1D_ComputeBins.cxx"
 #include "int_regular1D_Slice.cxx"
 #include "int_regular2D_Fill.cxx"
 #include "int_regular2D_Fill_tuple.cxx"
 #include "int_regular2D_templated_Fill.cxx"
+#include "int_regular2D_static_Fill.cxx"
+#include "int_regular2D_FillN.cxx"
 #include "int_regular2D_Slice.cxx"
 
 #include "double_regular1D_Fill.cxx"
@@ -0,0 +1,8 @@
+#define ALL_BENCHMARKS
+#include "int_variable1D_Fill.cxx"
+#include "int_variable1D_templated_Fill.cxx"
+#include "int_variable1D_static_Fill.cxx"
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
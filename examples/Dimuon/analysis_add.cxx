@@ -37,8 +37,40 @@
 #include "TLatex.h"
 #include "TStyle.h"
 
+#include <chrono>
+#include <iostream>
+
 using namespace ROOT::VecOps;
 
+// Wrap EPHistFillAddHelper to report the time to merge the histograms of all slots.
+template <typename T>
+class TimedFillAddHelper : public ROOT::Detail::RDF::RActionImpl<TimedFillAddHelper<T>>
+{
+   EPHist::Util::EPHistFillAddHelper<T> fHelper;
+
+public:
+   using Result_t = typename EPHist::Util::EPHistFillAddHelper<T>::Result_t;
+
+   template <typename... Args>
+   TimedFillAddHelper(unsigned int nSlots, const Args &...args) : fHelper(nSlots, args...) {}
+   TimedFillAddHelper(const TimedFillAddHelper &) = delete;
+   TimedFillAddHelper(TimedFillAddHelper &&) = default;
+   std::shared_ptr<Result_t> GetResultPtr() const { return fHelper.GetResultPtr(); }
+   void Initialize() { fHelper.Initialize(); }
+   void InitTask(TTreeReader *r, unsigned int slot) { fHelper.InitTask(r, slot); }
+   template <typename... ColumnTypes>
+   void Exec(unsigned int slot, ColumnTypes... values) { fHelper.Exec(slot, values...); }
+   void Finalize()
+   {
+      auto start = std::chrono::steady_clock::now();
+      fHelper.Finalize();
+      std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+      std::cout << "Finalize: " << duration.count() << " ms" << std::endl;
+   }
+
+   std::string GetActionName() const { return "TimedFillAddHelper"; }
+};
+
 void df102_NanoAODDimuonAnalysis()
 {
    // Enable multi-threading
@@ -56,7 +88,7 @@ void df102_NanoAODDimuonAnalysis()
    auto df_mass = df_os.Define("Dimuon_mass", InvariantMass<float>, {"Muon_pt", "Muon_eta", "Muon_phi", "Muon_mass"});
 
    // Make histogram of dimuon mass spectrum
-   EPHist::Util::EPHistFillAddHelper<double> helper(df.GetNSlots(), 30000, 0.25, 300);
+   TimedFillAddHelper<double> helper(df.GetNSlots(), 30000, 0.25, 300);
    auto hist = df_mass.Book<float>(std::move(helper), {"Dimuon_mass"});
 
    // Request cut-flow report
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_ALIGNEDDOUBLEBINWITHERROR
+#define EPHIST_ALIGNEDDOUBLEBINWITHERROR
+
+#include "Atomic.hxx"
+
+namespace EPHist {
+
+// A variant of DoubleBinWithError that is aligned to 16 bytes, so that atomic
+// updates change fSum and fSum2 together with a single double-width
+// compare-and-swap if the CPU supports it. This halves the number of atomic
+// instructions per fill. Otherwise, both fields are updated atomically one
+// after the other. In both cases, concurrent atomic updates never lose or tear
+// each other's updates, but the bin content must not be read concurrently
+// with fills.
+struct alignas(16) AlignedDoubleBinWithError {
+  double fSum = 0;
+  double fSum2 = 0;
+
+  AlignedDoubleBinWithError &operator++() {
+    fSum++;
+    fSum2++;
+    return *this;
+  }
+
+  AlignedDoubleBinWithError operator++(int) {
+    AlignedDoubleBinWithError old = *this;
+    operator++();
+    return old;
+  }
+
+  AlignedDoubleBinWithError &operator+=(const AlignedDoubleBinWithError &rhs) {
+    fSum += rhs.fSum;
+    fSum2 += rhs.fSum2;
+    return *this;
+  }
+
+  AlignedDoubleBinWithError &operator+=(double w) {
+    fSum += w;
+    fSum2 += w * w;
+    return *this;
+  }
+
+  void AtomicInc() { AtomicAddPair(1, 1); }
+
+  void AtomicAdd(const AlignedDoubleBinWithError &rhs) {
+    AtomicAddPair(rhs.fSum, rhs.fSum2);
+  }
+
+  void AtomicAddDouble(double w) { AtomicAddPair(w, w * w); }
+
+private:
+  void AtomicAddPair(double sum, double sum2) {
+#ifdef EPHIST_ATOMIC_CMPXCHG16B
+    static_assert(sizeof(AlignedDoubleBinWithError) == 16);
+    if (Internal::HasCmpxchg16b()) {
+      Internal::AtomicAddDoublePair(&fSum, sum, sum2);
+      return;
+    }
+#endif
+    Internal::AtomicAdd(&fSum, sum);
+    Internal::AtomicAdd(&fSum2, sum2);
+  }
+};
+
+} // namespace EPHist
+
+#endif
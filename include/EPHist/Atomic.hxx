@@ -3,11 +3,58 @@
 #ifndef EPHIST_ATOMIC
 #define EPHIST_ATOMIC
 
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <type_traits>
 
+// The backend for atomic additions of floating point types is selected at
+// compile time: with C++20, std::atomic_ref<T>::fetch_add is used, which
+// compilers can lower to native instructions where available. Define
+// EPHIST_ATOMIC_CAS to always use a compare-and-swap loop instead. Multi-word
+// bins, such as DoubleBinWithError, update each word atomically by default;
+// define EPHIST_ATOMIC_STRIPED_LOCK to protect each bin with one of a fixed
+// number of striped locks instead, which avoids retrying compare-and-swap
+// loops under heavy contention and updates all words consistently.
+#if defined(__cpp_lib_atomic_ref) && __cpp_lib_atomic_ref >= 201806L &&        \
+    !defined(EPHIST_ATOMIC_CAS)
+#define EPHIST_ATOMIC_REF 1
+#endif
+
+// Double-width compare-and-swap (cmpxchg16b) is compiled with a function
+// attribute and only used if the CPU supports it, so it does not require
+// compiling the entire application with -mcx16.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EPHIST_ATOMIC_CMPXCHG16B 1
+#include <cpuid.h>
+#endif
+
 namespace EPHist {
 namespace Internal {
 
+// The assumed size of a cache line, to avoid false sharing.
+static constexpr std::size_t CacheLineSize = 64;
+
+// Get the lock for the object at ptr, from a fixed number of striped locks.
+// The locks are blocking mutexes, not spin locks, so waiting threads do not
+// burn cycles on a contended bin.
+inline std::mutex &GetStripedLock(const void *ptr) {
+  static constexpr unsigned StripeBits = 8;
+  static constexpr std::size_t NumStripes = std::size_t(1) << StripeBits;
+  struct alignas(CacheLineSize) Stripe {
+    std::mutex fMutex;
+  };
+  static Stripe stripes[NumStripes];
+
+  // Fibonacci hashing of the address; the high bits are well mixed.
+  const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+  const std::uint64_t h = address * 0x9E3779B97F4A7C15ull;
+  return stripes[h >> (64 - StripeBits)].fMutex;
+}
+
 // A simple version of the functionality provided by C++20 std::atomic_ref.
 
 template <typename T>
@@ -24,6 +71,9 @@ std::enable_if_t<std::is_integral_v<T>> AtomicInc(T *ptr) {
 
 template <typename T>
 std::enable_if_t<std::is_floating_point_v<T>> AtomicAdd(T *ptr, T add) {
+#ifdef EPHIST_ATOMIC_REF
+  std::atomic_ref<T>(*ptr).fetch_add(add, std::memory_order_relaxed);
+#else
   T expected;
   __atomic_load(ptr, &expected, __ATOMIC_RELAXED);
   T desired = expected + add;
@@ -32,6 +82,7 @@ std::enable_if_t<std::is_floating_point_v<T>> AtomicAdd(T *ptr, T add) {
     // expected holds the new value; try again.
     desired = expected + add;
   }
+#endif
 }
 
 template <typename T>
@@ -45,9 +96,10 @@ std::enable_if_t<std::is_floating_point_v<T>> AtomicInc(T *ptr) {
   AtomicAdd(ptr, static_cast<T>(1));
 }
 
+// Checks the call instead of taking the address of the member function, which
+// also works for bins with overloads of AtomicAdd, such as those of Profile.
 template <typename T>
-std::enable_if_t<std::is_member_function_pointer_v<decltype(&T::AtomicAdd)>>
-AtomicAdd(T *ptr, const T &add) {
+auto AtomicAdd(T *ptr, const T &add) -> decltype(ptr->AtomicAdd(add)) {
   ptr->AtomicAdd(add);
 }
 
@@ -64,6 +116,49 @@ AtomicInc(T *ptr) {
   ptr->AtomicInc();
 }
 
+#ifdef EPHIST_ATOMIC_CMPXCHG16B
+inline bool HasCmpxchg16b() {
+  static const bool hasCmpxchg16b = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    return (ecx & bit_CMPXCHG16B) != 0;
+  }();
+  return hasCmpxchg16b;
+}
+
+// Atomically add to a pair of doubles with a single double-width
+// compare-and-swap. The pair must be aligned to 16 bytes, and the caller must
+// check that the CPU supports cmpxchg16b.
+__attribute__((target("cx16"))) inline void
+AtomicAddDoublePair(double *pair, double add0, double add1) {
+  assert(reinterpret_cast<std::uintptr_t>(pair) % 16 == 0);
+  auto *ptr = reinterpret_cast<unsigned __int128 *>(pair);
+
+  // The two halves may be read inconsistently, but then the compare-and-swap
+  // fails and returns the current value.
+  double values[2];
+  __atomic_load(&pair[0], &values[0], __ATOMIC_RELAXED);
+  __atomic_load(&pair[1], &values[1], __ATOMIC_RELAXED);
+  unsigned __int128 expected;
+  std::memcpy(&expected, values, sizeof(expected));
+  while (true) {
+    std::memcpy(values, &expected, sizeof(expected));
+    values[0] += add0;
+    values[1] += add1;
+    unsigned __int128 desired;
+    std::memcpy(&desired, values, sizeof(desired));
+    const unsigned __int128 previous =
+        __sync_val_compare_and_swap(ptr, expected, desired);
+    if (previous == expected) {
+      return;
+    }
+    expected = previous;
+  }
+}
+#endif
+
 } // namespace Internal
 } // namespace EPHist
 
@@ -5,11 +5,15 @@
 
 #include "BinIndex.hxx"
 #include "BinIndexRange.hxx"
+#include "BulkOperations.hxx"
 #include "CategoricalAxis.hxx"
+#include "IntCategoricalAxis.hxx"
 #include "RegularAxis.hxx"
 #include "VariableBinAxis.hxx"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
@@ -22,9 +26,15 @@
 namespace EPHist {
 
 template <typename T> class EPHist;
+template <typename T> class FillContext;
+template <typename T> class PagedHist;
 template <bool WithError> class Profile;
+template <typename T> class SoAHist;
+template <bool WithError> class SoAProfile;
+template <typename T> class SparseHist;
 
-using AxisVariant = std::variant<RegularAxis, VariableBinAxis, CategoricalAxis>;
+using AxisVariant = std::variant<RegularAxis, VariableBinAxis, CategoricalAxis,
+                                 IntCategoricalAxis>;
 
 namespace Internal {
 // Explicit specializations are only allowed at namespace scope.
@@ -38,13 +48,143 @@ template <> struct AxisVariantIndex<VariableBinAxis> {
 template <> struct AxisVariantIndex<CategoricalAxis> {
   static constexpr std::size_t value = 2;
 };
+template <> struct AxisVariantIndex<IntCategoricalAxis> {
+  static constexpr std::size_t value = 3;
+};
+
+// Only integral types are accepted for an IntCategoricalAxis, to avoid silently
+// truncating floating point values.
+template <typename A>
+static constexpr bool IsIntCategoricalArgument =
+    std::is_integral_v<std::remove_cv_t<std::remove_reference_t<A>>>;
 } // namespace Internal
 
 namespace Detail {
 
+// Map the bins of axes to the bins of sliced axes, see
+// Axes::ComputeSliceBinMap.
+template <std::size_t N> struct SliceBinMap final {
+  // For each dimension, the bin of the sliced axis for every bin of the
+  // original axis.
+  std::array<std::vector<std::size_t>, N> fAxisMaps;
+  // For each dimension, the total number of bins of the sliced axis.
+  std::array<std::size_t, N> fSliceNumBins;
+
+  std::size_t operator()(std::size_t origBin) const {
+    // Decompose the original bin, starting with the innermost dimension.
+    std::size_t sliceBin = 0;
+    std::size_t stride = 1;
+    for (std::size_t j = 0; j < N; j++) {
+      const std::size_t i = N - 1 - j;
+      const auto &axisMap = fAxisMaps[i];
+      sliceBin += axisMap[origBin % axisMap.size()] * stride;
+      origBin /= axisMap.size();
+      stride *= fSliceNumBins[i];
+    }
+    return sliceBin;
+  }
+
+  // Call f(origBin, sliceBin, n) for runs of n consecutive original bins that
+  // map to n consecutive bins of the sliced axes, together covering all bins
+  // of the original axes. The runs are found once along the innermost
+  // dimension, and the outer dimensions are walked with strides instead of
+  // mapping every bin. With more than one thread (see BulkOperations.hxx), f
+  // is called concurrently for disjoint ranges of the outermost sliced
+  // dimension, so concurrent calls never map into the same sliced bins.
+  template <typename F> void ForEachRun(std::size_t numThreads, F &&f) const {
+    struct Run {
+      std::size_t fOrigBin;
+      std::size_t fSliceBin;
+      std::size_t fNumBins;
+    };
+    std::vector<Run> runs;
+    const auto &innerMap = fAxisMaps[N - 1];
+    for (std::size_t k = 0; k < innerMap.size(); k++) {
+      if (!runs.empty() &&
+          runs.back().fSliceBin + runs.back().fNumBins == innerMap[k]) {
+        runs.back().fNumBins++;
+      } else {
+        runs.push_back({k, innerMap[k], 1});
+      }
+    }
+
+    if constexpr (N == 1) {
+      for (const Run &run : runs) {
+        f(run.fOrigBin, run.fSliceBin, run.fNumBins);
+      }
+    } else {
+      std::array<std::size_t, N> origStrides;
+      std::array<std::size_t, N> sliceStrides;
+      std::size_t origStride = 1;
+      std::size_t sliceStride = 1;
+      for (std::size_t j = 0; j < N; j++) {
+        const std::size_t i = N - 1 - j;
+        origStrides[i] = origStride;
+        sliceStrides[i] = sliceStride;
+        origStride *= fAxisMaps[i].size();
+        sliceStride *= fSliceNumBins[i];
+      }
+
+      // Walk the original bins that map into the sliced bins [begin, end) of
+      // the outermost dimension.
+      auto walk = [&](std::size_t begin, std::size_t end) {
+        const auto &outerMap = fAxisMaps[0];
+        for (std::size_t k = 0; k < outerMap.size(); k++) {
+          if (outerMap[k] < begin || outerMap[k] >= end) {
+            continue;
+          }
+          // The original bins of the dimensions between the outermost and
+          // the innermost one, advanced like an odometer.
+          std::array<std::size_t, N> indexes{};
+          std::size_t origBin = k * origStrides[0];
+          std::size_t sliceBin = outerMap[k] * sliceStrides[0];
+          for (std::size_t i = 1; i < N - 1; i++) {
+            sliceBin += fAxisMaps[i][0] * sliceStrides[i];
+          }
+          while (true) {
+            for (const Run &run : runs) {
+              f(origBin + run.fOrigBin, sliceBin + run.fSliceBin,
+                run.fNumBins);
+            }
+            // Within one bin of the outermost dimension, the original bins
+            // are contiguous, so only the sliced bin needs to be updated.
+            origBin += origStrides[N - 2];
+            std::size_t i = N - 2;
+            for (; i > 0; i--) {
+              const auto &axisMap = fAxisMaps[i];
+              sliceBin -= axisMap[indexes[i]] * sliceStrides[i];
+              indexes[i]++;
+              if (indexes[i] == axisMap.size()) {
+                indexes[i] = 0;
+              }
+              sliceBin += axisMap[indexes[i]] * sliceStrides[i];
+              if (indexes[i] != 0) {
+                break;
+              }
+            }
+            if (i == 0) {
+              break;
+            }
+          }
+        }
+      };
+
+      const std::size_t outerSliceNumBins = fSliceNumBins[0];
+      numThreads = std::min(Internal::GetNumThreads(origStride, numThreads),
+                            outerSliceNumBins);
+      Internal::RunInChunks(outerSliceNumBins, numThreads, walk);
+    }
+  }
+};
+
 class Axes final {
   template <typename T> friend class ::EPHist::EPHist;
+  template <typename T> friend class ::EPHist::FillContext;
+  template <typename T> friend class ::EPHist::PagedHist;
   template <bool WithError> friend class ::EPHist::Profile;
+  template <typename T> friend class ::EPHist::SoAHist;
+  template <bool WithError> friend class ::EPHist::SoAProfile;
+  template <typename T> friend class ::EPHist::SparseHist;
 
   std::vector<AxisVariant> fAxes;
 
@@ -63,6 +203,9 @@ public:
         totalNumBins *= variable->GetTotalNumBins();
       } else if (auto *categorical = std::get_if<CategoricalAxis>(&axis)) {
         totalNumBins *= categorical->GetTotalNumBins();
+      } else if (auto *intCategorical =
+                     std::get_if<IntCategoricalAxis>(&axis)) {
+        totalNumBins *= intCategorical->GetTotalNumBins();
       }
     }
     return totalNumBins;
@@ -109,6 +252,16 @@ private:
       }
       break;
     }
+    case Internal::AxisVariantIndex<IntCategoricalAxis>::value: {
+      if constexpr (Internal::IsIntCategoricalArgument<ArgumentType>) {
+        const auto *intCategorical = std::get_if<IntCategoricalAxis>(&axis);
+        bin *= intCategorical->GetTotalNumBins();
+        axisBin = intCategorical->ComputeBin(std::get<I>(args));
+      } else {
+        throw std::invalid_argument("cannot convert argument");
+      }
+      break;
+    }
     }
     if (!axisBin.second) {
       return {0, false};
@@ -149,7 +302,98 @@ private:
     return {bin, true};
   }
 
+  template <std::size_t I, typename... P>
+  void ComputeBins(const std::tuple<P...> &args, std::size_t offset,
+                   std::size_t n, std::size_t *bins,
+                   std::size_t *axisBins) const {
+    using PointerType = std::tuple_element_t<I, std::tuple<P...>>;
+    using ArgumentType = std::remove_cv_t<std::remove_pointer_t<PointerType>>;
+    const ArgumentType *x = std::get<I>(args) + offset;
+    // The first axis computes directly into the output array.
+    std::size_t *out = I == 0 ? bins : axisBins;
+    std::size_t totalNumBins = 0;
+    const auto &axis = fAxes[I];
+    switch (axis.index()) {
+    case Internal::AxisVariantIndex<RegularAxis>::value: {
+      if constexpr (std::is_convertible_v<ArgumentType,
+                                          RegularAxis::ArgumentType>) {
+        const auto *regular = std::get_if<RegularAxis>(&axis);
+        totalNumBins = regular->GetTotalNumBins();
+        regular->ComputeBins(x, n, out);
+      } else {
+        throw std::invalid_argument("cannot convert argument");
+      }
+      break;
+    }
+    case Internal::AxisVariantIndex<VariableBinAxis>::value: {
+      if constexpr (std::is_convertible_v<ArgumentType,
+                                          VariableBinAxis::ArgumentType>) {
+        const auto *variable = std::get_if<VariableBinAxis>(&axis);
+        totalNumBins = variable->GetTotalNumBins();
+        variable->ComputeBins(x, n, out);
+      } else {
+        throw std::invalid_argument("cannot convert argument");
+      }
+      break;
+    }
+    case Internal::AxisVariantIndex<CategoricalAxis>::value: {
+      if constexpr (std::is_convertible_v<ArgumentType,
+                                          CategoricalAxis::ArgumentType>) {
+        const auto *categorical = std::get_if<CategoricalAxis>(&axis);
+        totalNumBins = categorical->GetTotalNumBins();
+        categorical->ComputeBins(x, n, out);
+      } else {
+        throw std::invalid_argument("cannot convert argument");
+      }
+      break;
+    }
+    case Internal::AxisVariantIndex<IntCategoricalAxis>::value: {
+      if constexpr (Internal::IsIntCategoricalArgument<ArgumentType>) {
+        const auto *intCategorical = std::get_if<IntCategoricalAxis>(&axis);
+        totalNumBins = intCategorical->GetTotalNumBins();
+        intCategorical->ComputeBins(x, n, out);
+      } else {
+        throw std::invalid_argument("cannot convert argument");
+      }
+      break;
+    }
+    }
+    if constexpr (I > 0) {
+      for (std::size_t i = 0; i < n; i++) {
+        if (bins[i] == Internal::InvalidBin ||
+            axisBins[i] == Internal::InvalidBin) {
+          bins[i] = Internal::InvalidBin;
+        } else {
+          bins[i] = bins[i] * totalNumBins + axisBins[i];
+        }
+      }
+    }
+    if constexpr (I + 1 < sizeof...(P)) {
+      ComputeBins<I + 1>(args, offset, n, bins, axisBins);
+    }
+  }
+
 public:
+  // The maximum number of entries for one call to ComputeBins.
+  static constexpr std::size_t MaxBatchSize = 256;
+
+  // Compute the bins for n entries at once, starting at offset into the
+  // arrays of arguments (one pointer per dimension). The switch on the axis
+  // type is done only once per dimension and batch. Entries that do not map
+  // to a bin are marked with Internal::InvalidBin.
+  template <typename... P>
+  void ComputeBins(const std::tuple<P...> &args, std::size_t offset,
+                   std::size_t n, std::size_t *bins) const {
+    static_assert((std::is_pointer_v<P> && ...),
+                  "arguments must be pointers to arrays");
+    if (sizeof...(P) != fAxes.size()) {
+      throw std::invalid_argument("invalid number of arguments to ComputeBins");
+    }
+    assert(n <= MaxBatchSize);
+    std::size_t axisBins[sizeof...(P) > 1 ? MaxBatchSize : 1];
+    ComputeBins<0>(args, offset, n, bins, axisBins);
+  }
+
   template <typename... A>
   std::pair<std::size_t, bool> ComputeBin(const std::tuple<A...> &args) const {
     if (sizeof...(A) != fAxes.size()) {
@@ -158,11 +402,14 @@ public:
     return ComputeBin<0, sizeof...(A)>(0, args);
   }
 
+  // Callers check the number of arguments and throw with their own message.
+  // Returning here instead of throwing lets the optimizer see that fAxes is
+  // never indexed past its end, which otherwise triggers -Warray-bounds.
   template <class... Axes>
   std::pair<std::size_t, bool>
   ComputeBin(const typename Axes::ArgumentType &...args) const {
     if (sizeof...(Axes) != fAxes.size()) {
-      throw std::invalid_argument("invalid number of arguments to ComputeBin");
+      return {0, false};
     }
     return ComputeBin<0, Axes...>(0, args...);
   }
@@ -197,6 +444,12 @@ public:
         axisBin = categorical->GetBin(index);
         break;
       }
+      case Internal::AxisVariantIndex<IntCategoricalAxis>::value: {
+        const auto *intCategorical = std::get_if<IntCategoricalAxis>(&axis);
+        bin *= intCategorical->GetTotalNumBins();
+        axisBin = intCategorical->GetBin(index);
+        break;
+      }
       }
       if (!axisBin.second) {
         return {0, false};
@@ -232,12 +485,179 @@ public:
         axes.push_back(categorical->Slice(range));
         break;
       }
+      case Internal::AxisVariantIndex<IntCategoricalAxis>::value: {
+        const auto *intCategorical = std::get_if<IntCategoricalAxis>(&axis);
+        axes.push_back(intCategorical->Slice(range));
+        break;
+      }
       }
     }
     assert(axes.size() == N);
     return axes;
   }
 
+  // Call f(origBin, sliceBin) for every bin of these axes, with the bin of the
+  // sliced axes (as returned by Slice(ranges)) that it is accumulated into.
+  template <std::size_t N, typename F>
+  void ForEachSliceBin(const std::array<BinIndexRange, N> &ranges,
+                       const Axes &sliced, F &&f) const {
+    assert(N == fAxes.size());
+    assert(sliced.fAxes.size() == N);
+
+    // Collect full ranges of the original histogram and normalize the full
+    // ranges potentially passed in by the user.
+    std::array<BinIndexRange, N> fullRanges;
+    std::array<BinIndexRange, N> normalRanges;
+    // Categorical axes have no underflow bin; the sliced axis collects all
+    // other categories in its overflow bin.
+    std::array<bool, N> hasUnderflowBin;
+    hasUnderflowBin.fill(true);
+    for (std::size_t i = 0; i < N; i++) {
+      const auto &axis = fAxes[i];
+      switch (axis.index()) {
+      case Internal::AxisVariantIndex<RegularAxis>::value: {
+        const auto *regular = std::get_if<RegularAxis>(&axis);
+        const std::size_t numBins = regular->GetNumBins();
+        if (regular->AreFlowBinsEnabled()) {
+          fullRanges[i] = BinIndexRange::Full(numBins);
+        } else {
+          fullRanges[i] = BinIndexRange(0, numBins);
+        }
+        normalRanges[i] = ranges[i].GetNormalRange(numBins);
+        break;
+      }
+      case Internal::AxisVariantIndex<VariableBinAxis>::value: {
+        const auto *variable = std::get_if<VariableBinAxis>(&axis);
+        const std::size_t numBins = variable->GetNumBins();
+        if (variable->AreFlowBinsEnabled()) {
+          fullRanges[i] = BinIndexRange::Full(numBins);
+        } else {
+          fullRanges[i] = BinIndexRange(0, numBins);
+        }
+        normalRanges[i] = ranges[i].GetNormalRange(numBins);
+        break;
+      }
+      case Internal::AxisVariantIndex<CategoricalAxis>::value: {
+        const auto *categorical = std::get_if<CategoricalAxis>(&axis);
+        const std::size_t numBins = categorical->GetNumBins();
+        if (categorical->IsOverflowBinEnabled()) {
+          fullRanges[i] = BinIndexRange::FullCategorical(numBins);
+        } else {
+          fullRanges[i] = BinIndexRange(0, numBins);
+        }
+        normalRanges[i] = ranges[i].GetNormalRange(numBins);
+        hasUnderflowBin[i] = false;
+        break;
+      }
+      case Internal::AxisVariantIndex<IntCategoricalAxis>::value: {
+        const auto *intCategorical = std::get_if<IntCategoricalAxis>(&axis);
+        const std::size_t numBins = intCategorical->GetNumBins();
+        if (intCategorical->IsOverflowBinEnabled()) {
+          fullRanges[i] = BinIndexRange::FullCategorical(numBins);
+        } else {
+          fullRanges[i] = BinIndexRange(0, numBins);
+        }
+        normalRanges[i] = ranges[i].GetNormalRange(numBins);
+        hasUnderflowBin[i] = false;
+        break;
+      }
+      }
+    }
+
+    auto getSliceIndex = [&](std::size_t i, BinIndex index) {
+      if (index.IsNormal()) {
+        // Compare the index to normalRanges[i] and map into the underflow or
+        // overflow bin if outside.
+        if (index < normalRanges[i].GetBegin()) {
+          return hasUnderflowBin[i] ? BinIndex::Underflow()
+                                    : BinIndex::Overflow();
+        } else if (index >= normalRanges[i].GetEnd()) {
+          return BinIndex::Overflow();
+        }
+
+        // Otherwise adjust the index by the begin index.
+        const auto beginIndex = normalRanges[i].GetBegin().GetIndex();
+        return BinIndex(index.GetIndex() - beginIndex);
+      }
+
+      // All other bins map to themselves, in particular the underflow and
+      // overflow bins.
+      return index;
+    };
+
+    // Walk all bins of the original axes.
+    std::array<BinIndexRange::Iterator, N> origIndexIterator;
+    std::array<BinIndex, N> origIndexes;
+    std::array<BinIndex, N> sliceIndexes;
+    for (std::size_t i = 0; i < N; i++) {
+      origIndexIterator[i] = fullRanges[i].begin();
+      origIndexes[i] = *origIndexIterator[i];
+      sliceIndexes[i] = getSliceIndex(i, origIndexes[i]);
+    }
+
+    while (true) {
+      const auto origBin = ComputeBin(origIndexes);
+      assert(origBin.second);
+      const auto sliceBin = sliced.ComputeBin(sliceIndexes);
+      assert(sliceBin.second);
+      f(origBin.first, sliceBin.first);
+
+      // Advance the indices.
+      bool shouldContinueAdvance = true;
+      for (std::size_t j = 0; j < N; j++) {
+        // Reverse iteration order to improve performance by advancing the
+        // innermost index first.
+        const std::size_t i = N - 1 - j;
+
+        shouldContinueAdvance = false;
+        // Advance this iterator.
+        origIndexIterator[i]++;
+        // If we reached the end, wrap around.
+        if (origIndexIterator[i] == fullRanges[i].end()) {
+          origIndexIterator[i] = fullRanges[i].begin();
+          shouldContinueAdvance = true;
+        }
+        // Get the index by dereferencing the iterator.
+        origIndexes[i] = *origIndexIterator[i];
+        sliceIndexes[i] = getSliceIndex(i, origIndexes[i]);
+
+        if (!shouldContinueAdvance) {
+          break;
+        }
+      }
+      if (shouldContinueAdvance) {
+        // No more index found to advance, we are done.
+        break;
+      }
+    }
+  }
+
+  // Compute the map of bins to the bins of the sliced axes, as passed to
+  // f(origBin, sliceBin) by ForEachSliceBin, but without walking all bins.
+  // This is useful for storages that only store a subset of the bins.
+  template <std::size_t N>
+  SliceBinMap<N> ComputeSliceBinMap(const std::array<BinIndexRange, N> &ranges,
+                                    const Axes &sliced) const {
+    assert(N == fAxes.size());
+    assert(sliced.fAxes.size() == N);
+
+    // The slicing of each dimension is independent of the others.
+    SliceBinMap<N> map;
+    for (std::size_t i = 0; i < N; i++) {
+      const Axes origAxis({fAxes[i]});
+      const Axes sliceAxis({sliced.fAxes[i]});
+      auto &axisMap = map.fAxisMaps[i];
+      axisMap.resize(origAxis.ComputeTotalNumBins());
+      origAxis.ForEachSliceBin(std::array<BinIndexRange, 1>{ranges[i]},
+                               sliceAxis,
+                               [&](std::size_t origBin, std::size_t sliceBin) {
+                                 axisMap[origBin] = sliceBin;
+                               });
+      map.fSliceNumBins[i] = sliceAxis.ComputeTotalNumBins();
+    }
+    return map;
+  }
+
   friend bool operator==(const Axes &lhs, const Axes &rhs) {
     return lhs.fAxes == rhs.fAxes;
   }
@@ -8,6 +8,11 @@
 
 namespace EPHist {
 
+namespace Internal {
+// Marker for entries that do not map to a bin in the batched bin computations.
+static constexpr std::size_t InvalidBin = -1;
+} // namespace Internal
+
 class BinIndex final {
   static constexpr std::size_t UnderflowIndex = -3;
   static constexpr std::size_t OverflowIndex = -2;
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_BINSTORAGE
+#define EPHIST_BINSTORAGE
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// The dense array of bins of an EPHist. Usually the bins are owned in a
+// std::vector, but they may also live in external memory, for example a file
+// mapped into memory (see Util/FileBackedHist.hxx), that is kept alive by an
+// owner object. The interface mirrors the parts of std::vector used by EPHist.
+// Copies always own their bins in memory.
+template <typename T> class BinStorage final {
+  std::vector<T> fVector;
+  T *fData;
+  std::size_t fSize;
+  std::shared_ptr<void> fOwner;
+
+public:
+  explicit BinStorage(std::size_t size)
+      : fVector(size), fData(fVector.data()), fSize(size) {}
+  BinStorage(T *data, std::size_t size, std::shared_ptr<void> owner)
+      : fData(data), fSize(size), fOwner(std::move(owner)) {
+    assert(fOwner);
+  }
+
+  BinStorage(const BinStorage<T> &other)
+      : fVector(other.fData, other.fData + other.fSize),
+        fData(fVector.data()), fSize(other.fSize) {}
+  BinStorage(BinStorage<T> &&other)
+      : fVector(std::move(other.fVector)), fData(other.fData),
+        fSize(other.fSize), fOwner(std::move(other.fOwner)) {
+    other.fData = nullptr;
+    other.fSize = 0;
+  }
+  BinStorage<T> &operator=(const BinStorage<T> &) = delete;
+  BinStorage<T> &operator=(BinStorage<T> &&other) {
+    if (this == &other) {
+      return *this;
+    }
+    // Moving the vector keeps its buffer, so fData stays valid.
+    fVector = std::move(other.fVector);
+    fData = other.fData;
+    fSize = other.fSize;
+    fOwner = std::move(other.fOwner);
+    other.fData = nullptr;
+    other.fSize = 0;
+    return *this;
+  }
+
+  // Whether the bins live in external memory.
+  bool IsExternal() const { return fOwner != nullptr; }
+  const void *GetOwner() const { return fOwner.get(); }
+
+  T *data() { return fData; }
+  const T *data() const { return fData; }
+  std::size_t size() const { return fSize; }
+
+  T &operator[](std::size_t bin) {
+    assert(bin < fSize);
+    return fData[bin];
+  }
+  const T &operator[](std::size_t bin) const {
+    assert(bin < fSize);
+    return fData[bin];
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
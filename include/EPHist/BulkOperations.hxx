@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_BULKOPERATIONS
+#define EPHIST_BULKOPERATIONS
+
+#include "Atomic.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// Kernels for operations on all bins. They are plain loops over arrays that
+// the compiler vectorizes (with a runtime check that the arrays do not
+// overlap, so adding an array to itself is allowed).
+template <typename T> void AddArray(T *dst, const T *src, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    dst[i] += src[i];
+  }
+}
+
+template <typename T> void AtomicAddArray(T *dst, const T *src, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    AtomicAdd(&dst[i], src[i]);
+  }
+}
+
+template <typename T> void ClearArray(T *dst, std::size_t n) {
+  std::fill(dst, dst + n, T{});
+}
+
+// The minimum number of bins per thread for bulk operations, to amortize the
+// cost of starting the thread.
+static constexpr std::size_t MinBinsPerThread = 64 * 1024;
+
+// Get the number of threads to use for an operation on n bins; numThreads = 0
+// selects the number of hardware threads.
+inline std::size_t GetNumThreads(std::size_t n, std::size_t numThreads) {
+  if (numThreads == 0) {
+    // Querying the number of hardware threads may read from the filesystem.
+    static const std::size_t HardwareConcurrency =
+        std::thread::hardware_concurrency();
+    numThreads = HardwareConcurrency;
+  }
+  const std::size_t maxThreads = std::max<std::size_t>(1, n / MinBinsPerThread);
+  return std::clamp<std::size_t>(numThreads, 1, maxThreads);
+}
+
+// Split the range [0, n) into numThreads contiguous chunks and call
+// f(begin, end) for each of them in parallel. The last chunk is processed by
+// the calling thread.
+template <typename F>
+void RunInChunks(std::size_t n, std::size_t numThreads, F &&f) {
+  assert(numThreads >= 1);
+  if (numThreads == 1) {
+    f(std::size_t(0), n);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < numThreads - 1; t++) {
+    threads.emplace_back(f, t * n / numThreads, (t + 1) * n / numThreads);
+  }
+  f((numThreads - 1) * n / numThreads, n);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// Call f(begin, end) for chunks of the n bins, in parallel with up to
+// numThreads threads (see GetNumThreads).
+template <typename F>
+void ForEachChunk(std::size_t n, std::size_t numThreads, F &&f) {
+  RunInChunks(n, GetNumThreads(n, numThreads), std::forward<F>(f));
+}
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -8,6 +8,8 @@
 
 #include <cassert>
 #include <cstddef>
+#include <functional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <unordered_set>
@@ -21,9 +23,38 @@ public:
   using ArgumentType = std::string_view;
 
 private:
+  // Up to this number of categories, a linear search is fastest.
+  static constexpr std::size_t MaxCategoriesLinearSearch = 4;
+
   std::vector<std::string> fCategories;
   bool fEnableOverflowBin;
 
+  // Open-addressing hash table with linear probing, storing the bin index
+  // plus one for each category (zero marks empty slots). The size is a power
+  // of two and at least twice the number of categories.
+  std::vector<std::size_t> fHashTable;
+  std::size_t fHashMask = 0;
+
+  static std::size_t Hash(std::string_view x) {
+    return std::hash<std::string_view>{}(x);
+  }
+
+  void BuildHashTable() {
+    std::size_t size = 1;
+    while (size < 2 * fCategories.size()) {
+      size *= 2;
+    }
+    fHashTable.assign(size, 0);
+    fHashMask = size - 1;
+    for (std::size_t bin = 0; bin < fCategories.size(); bin++) {
+      std::size_t slot = Hash(fCategories[bin]) & fHashMask;
+      while (fHashTable[slot] != 0) {
+        slot = (slot + 1) & fHashMask;
+      }
+      fHashTable[slot] = bin + 1;
+    }
+  }
+
 public:
   explicit CategoricalAxis(std::vector<std::string> categories,
                            bool enableOverflowBin = true)
@@ -33,6 +64,9 @@ public:
     if (set.size() != fCategories.size()) {
       throw std::invalid_argument("duplicate categories");
     }
+    if (fCategories.size() > MaxCategoriesLinearSearch) {
+      BuildHashTable();
+    }
   }
 
   std::size_t GetNumBins() const { return fCategories.size(); }
@@ -57,10 +91,20 @@ public:
   }
 
   std::pair<std::size_t, bool> ComputeBin(std::string_view x) const {
-    // FIXME: Optimize with hashing... (?)
-    for (std::size_t bin = 0; bin < fCategories.size(); bin++) {
-      if (fCategories[bin] == x) {
-        return {bin, true};
+    if (fHashTable.empty()) {
+      for (std::size_t bin = 0; bin < fCategories.size(); bin++) {
+        if (fCategories[bin] == x) {
+          return {bin, true};
+        }
+      }
+    } else {
+      std::size_t slot = Hash(x) & fHashMask;
+      while (fHashTable[slot] != 0) {
+        const std::size_t bin = fHashTable[slot] - 1;
+        if (fCategories[bin] == x) {
+          return {bin, true};
+        }
+        slot = (slot + 1) & fHashMask;
       }
     }
 
@@ -68,6 +112,16 @@ public:
     return {fCategories.size(), fEnableOverflowBin};
   }
 
+  // Compute the bins for n arguments at once; arguments outside of the axis
+  // (and without enabled flow bins) are marked with Internal::InvalidBin.
+  template <typename A>
+  void ComputeBins(const A *x, std::size_t n, std::size_t *bins) const {
+    for (std::size_t i = 0; i < n; i++) {
+      auto bin = ComputeBin(x[i]);
+      bins[i] = bin.second ? bin.first : Internal::InvalidBin;
+    }
+  }
+
   CategoricalAxis Slice(const BinIndexRange &range) const {
     const auto normalRange = range.GetNormalRange(fCategories.size());
 
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_COLUMNSTORAGE
+#define EPHIST_COLUMNSTORAGE
+
+#include "Atomic.hxx"
+#include "BulkOperations.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// Storage of bins with multiple moments as a structure of arrays: each member
+// listed by T::GetColumns() is stored in its own contiguous array of doubles.
+// Operations on all bins work column by column on plain arrays, which the
+// compiler can vectorize, and reading a single moment of all bins only streams
+// the memory of that column.
+template <typename T> class ColumnStorage final {
+  static constexpr auto Columns = T::GetColumns();
+
+public:
+  static constexpr std::size_t NumColumns = Columns.size();
+
+private:
+  std::array<std::vector<double>, NumColumns> fColumns;
+
+public:
+  explicit ColumnStorage(std::size_t numBins) {
+    for (auto &column : fColumns) {
+      column.resize(numBins);
+    }
+  }
+
+  std::size_t GetSize() const { return fColumns[0].size(); }
+
+  const std::vector<double> &GetColumn(std::size_t column) const {
+    assert(column < NumColumns);
+    return fColumns[column];
+  }
+
+  // Gather the moments of one bin.
+  T Get(std::size_t bin) const {
+    T value;
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      value.*Columns[c] = fColumns[c][bin];
+    }
+    return value;
+  }
+
+  void Add(std::size_t bin, const T &value) {
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      fColumns[c][bin] += value.*Columns[c];
+    }
+  }
+
+  void AddAtomic(std::size_t bin, const T &value) {
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      AtomicAdd(&fColumns[c][bin], value.*Columns[c]);
+    }
+  }
+
+  void Add(const ColumnStorage<T> &other) {
+    assert(GetSize() == other.GetSize());
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      AddArray(fColumns[c].data(), other.fColumns[c].data(), GetSize());
+    }
+  }
+
+  void AddAtomic(const ColumnStorage<T> &other) {
+    assert(GetSize() == other.GetSize());
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      AtomicAddArray(fColumns[c].data(), other.fColumns[c].data(), GetSize());
+    }
+  }
+
+  // Add the bins of other into this storage along the runs of a map from the
+  // bins of other to the bins of this storage, see Detail::SliceBinMap. The
+  // runs are walked once per column so that each addition works on plain
+  // arrays of doubles.
+  template <typename M>
+  void AddSlice(const ColumnStorage<T> &other, const M &map) {
+    for (std::size_t c = 0; c < NumColumns; c++) {
+      double *dst = fColumns[c].data();
+      const double *src = other.fColumns[c].data();
+      map.ForEachRun(1, [&](std::size_t origBin, std::size_t sliceBin,
+                            std::size_t n) {
+        AddArray(dst + sliceBin, src + origBin, n);
+      });
+    }
+  }
+
+  void Clear() {
+    for (auto &column : fColumns) {
+      ClearArray(column.data(), column.size());
+    }
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
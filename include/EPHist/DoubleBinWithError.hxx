@@ -5,12 +5,20 @@
 
 #include "Atomic.hxx"
 
+#include <array>
+#include <mutex>
+
 namespace EPHist {
 
 struct DoubleBinWithError {
   double fSum = 0;
   double fSum2 = 0;
 
+  // The members for the column-wise storage of SoAHist.
+  static constexpr std::array<double DoubleBinWithError::*, 2> GetColumns() {
+    return {&DoubleBinWithError::fSum, &DoubleBinWithError::fSum2};
+  }
+
   DoubleBinWithError &operator++() {
     fSum++;
     fSum2++;
@@ -35,6 +43,22 @@ struct DoubleBinWithError {
     return *this;
   }
 
+#ifdef EPHIST_ATOMIC_STRIPED_LOCK
+  void AtomicInc() {
+    std::lock_guard g(Internal::GetStripedLock(this));
+    operator++();
+  }
+
+  void AtomicAdd(const DoubleBinWithError &rhs) {
+    std::lock_guard g(Internal::GetStripedLock(this));
+    operator+=(rhs);
+  }
+
+  void AtomicAddDouble(double w) {
+    std::lock_guard g(Internal::GetStripedLock(this));
+    operator+=(w);
+  }
+#else
   void AtomicInc() {
     Internal::AtomicInc(&fSum);
     Internal::AtomicInc(&fSum2);
@@ -49,6 +73,7 @@ struct DoubleBinWithError {
     Internal::AtomicAdd(&fSum, w);
     Internal::AtomicAdd(&fSum2, w * w);
   }
+#endif
 };
 
 } // namespace EPHist
@@ -3,13 +3,18 @@
 #ifndef EPHIST_EPHIST
 #define EPHIST_EPHIST
 
+#include "AlignedDoubleBinWithError.hxx"
 #include "Atomic.hxx"
 #include "Axes.hxx"
 #include "BinIndex.hxx"
+#include "BinStorage.hxx"
+#include "BulkOperations.hxx"
 #include "DoubleBinWithError.hxx"
+#include "FixedPointBin.hxx"
 #include "TypeTraits.hxx"
 #include "Weight.hxx"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
@@ -22,23 +27,42 @@
 namespace EPHist {
 
 template <typename T> class FillContext;
+template <typename T> class PagedHist;
+template <typename T> class SoAHist;
+template <typename T> class SparseHist;
+template <typename T, class... Axes> class StaticHist;
+namespace Util {
+template <typename H> class BinaryIO;
+}
 
 template <typename T> class EPHist final {
   friend class FillContext<T>;
+  friend class PagedHist<T>;
+  friend class SoAHist<T>;
+  friend class SparseHist<T>;
+  template <typename U, class... Axes> friend class StaticHist;
+  friend class Util::BinaryIO<EPHist<T>>;
 
 public:
   using BinContentType = T;
 
 private:
-  std::vector<T> fData;
-
+  // The axes are declared first to compute the number of bins.
   Detail::Axes fAxes;
 
-public:
-  explicit EPHist(std::vector<AxisVariant> axes) : fAxes(std::move(axes)) {
-    fData.resize(fAxes.ComputeTotalNumBins());
+  Internal::BinStorage<T> fData;
+
+  // For Clone(), to copy the data without initializing it first, and for bins
+  // in external memory.
+  EPHist(const Detail::Axes &axes, Internal::BinStorage<T> data)
+      : fAxes(axes), fData(std::move(data)) {
+    assert(fData.size() == fAxes.ComputeTotalNumBins());
   }
 
+public:
+  explicit EPHist(std::vector<AxisVariant> axes)
+      : fAxes(std::move(axes)), fData(fAxes.ComputeTotalNumBins()) {}
+
   EPHist(std::size_t numBins, double low, double high)
       : EPHist({RegularAxis(numBins, low, high)}) {}
   explicit EPHist(const RegularAxis &axis)
@@ -47,6 +71,8 @@ public:
       : EPHist(std::vector<AxisVariant>{axis}) {}
   explicit EPHist(const CategoricalAxis &axis)
       : EPHist(std::vector<AxisVariant>{axis}) {}
+  explicit EPHist(const IntCategoricalAxis &axis)
+      : EPHist(std::vector<AxisVariant>{axis}) {}
 
   // Copy constructor and assignment operator are deleted to avoid surprises.
   // Use the explicit Clone() function to create a copy.
@@ -56,36 +82,68 @@ public:
   EPHist<T> &operator=(EPHist<T> &&) = default;
   ~EPHist() = default;
 
-  void Add(const EPHist<T> &other) {
+  // The bulk operations optionally run with multiple threads for large
+  // histograms; numThreads = 0 selects the number of hardware threads. See
+  // BulkOperations.hxx for details.
+  void Add(const EPHist<T> &other, std::size_t numThreads = 1) {
     if (fAxes != other.fAxes) {
       throw std::invalid_argument("axes configuration not identical");
     }
-    for (std::size_t i = 0; i < fData.size(); i++) {
-      fData[i] += other.fData[i];
-    }
+    Internal::ForEachChunk(
+        fData.size(), numThreads, [&](std::size_t begin, std::size_t end) {
+          Internal::AddArray(fData.data() + begin, other.fData.data() + begin,
+                             end - begin);
+        });
   }
 
-  void AddAtomic(const EPHist<T> &other) {
+  void AddAtomic(const EPHist<T> &other, std::size_t numThreads = 1) {
     if (fAxes != other.fAxes) {
       throw std::invalid_argument("axes configuration not identical");
     }
-    for (std::size_t i = 0; i < fData.size(); i++) {
-      Internal::AtomicAdd(&fData[i], other.fData[i]);
-    }
+    Internal::ForEachChunk(
+        fData.size(), numThreads, [&](std::size_t begin, std::size_t end) {
+          Internal::AtomicAddArray(fData.data() + begin,
+                                   other.fData.data() + begin, end - begin);
+        });
   }
 
-  void Clear() {
-    for (std::size_t i = 0; i < fData.size(); i++) {
-      fData[i] = {};
+  // The number of bins that Merge() sums from all histograms before moving on
+  // to the next block, so that the block stays in the cache.
+  static constexpr std::size_t MergeBlockSize =
+      std::max<std::size_t>(1, 16 * 1024 / sizeof(T));
+
+  // Add multiple histograms in one pass over the memory of this histogram.
+  void Merge(const std::vector<const EPHist<T> *> &others,
+             std::size_t numThreads = 1) {
+    for (const EPHist<T> *other : others) {
+      if (fAxes != other->fAxes) {
+        throw std::invalid_argument("axes configuration not identical");
+      }
     }
+    Internal::ForEachChunk(
+        fData.size(), numThreads, [&](std::size_t begin, std::size_t end) {
+          for (std::size_t block = begin; block < end;
+               block += MergeBlockSize) {
+            const std::size_t n = std::min(end - block, MergeBlockSize);
+            for (const EPHist<T> *other : others) {
+              Internal::AddArray(fData.data() + block,
+                                 other->fData.data() + block, n);
+            }
+          }
+        });
   }
 
-  EPHist<T> Clone() {
-    EPHist<T> h(fAxes.GetVector());
-    for (std::size_t i = 0; i < fData.size(); i++) {
-      h.fData[i] += fData[i];
-    }
-    return h;
+  void Clear(std::size_t numThreads = 1) {
+    Internal::ForEachChunk(fData.size(), numThreads,
+                           [&](std::size_t begin, std::size_t end) {
+                             Internal::ClearArray(fData.data() + begin,
+                                                  end - begin);
+                           });
+  }
+
+  // The clone always stores its bins in memory.
+  EPHist<T> Clone() const {
+    return EPHist<T>(fAxes, Internal::BinStorage<T>(fData));
   }
 
   const T &GetBinContent(std::size_t bin) const {
@@ -118,7 +176,9 @@ public:
   std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
 
   static constexpr bool SupportsWeightedFill =
-      std::is_floating_point_v<T> || std::is_same_v<T, DoubleBinWithError>;
+      std::is_floating_point_v<T> || std::is_same_v<T, DoubleBinWithError> ||
+      std::is_same_v<T, AlignedDoubleBinWithError> ||
+      std::is_same_v<T, FixedPointBin>;
 
 private:
   template <std::size_t N, typename... A>
@@ -281,128 +341,112 @@ public:
     }
   }
 
-  template <std::size_t N>
-  EPHist<T> Slice(const std::array<BinIndexRange, N> &ranges) const {
-    if (N != fAxes.GetNumDimensions()) {
-      throw std::invalid_argument("invalid number of arguments to Slice");
-    }
-
-    // Create the sliced axes.
-    std::vector<AxisVariant> slicedAxes = fAxes.Slice(ranges);
-
-    // Collect full ranges of the original histogram and normalize the full
-    // ranges potentially passed in by the user.
-    std::array<BinIndexRange, N> fullRanges;
-    std::array<BinIndexRange, N> normalRanges;
-    for (std::size_t i = 0; i < N; i++) {
-      const auto &axis = fAxes.GetVector()[i];
-      switch (axis.index()) {
-      case Internal::AxisVariantIndex<RegularAxis>::value: {
-        const auto *regular = std::get_if<RegularAxis>(&axis);
-        const std::size_t numBins = regular->GetNumBins();
-        if (regular->AreFlowBinsEnabled()) {
-          fullRanges[i] = BinIndexRange::Full(numBins);
-        } else {
-          fullRanges[i] = BinIndexRange(0, numBins);
-        }
-        normalRanges[i] = ranges[i].GetNormalRange(numBins);
-        break;
-      }
-      case Internal::AxisVariantIndex<VariableBinAxis>::value: {
-        const auto *variable = std::get_if<VariableBinAxis>(&axis);
-        const std::size_t numBins = variable->GetNumBins();
-        if (variable->AreFlowBinsEnabled()) {
-          fullRanges[i] = BinIndexRange::Full(numBins);
-        } else {
-          fullRanges[i] = BinIndexRange(0, numBins);
-        }
-        normalRanges[i] = ranges[i].GetNormalRange(numBins);
-        break;
-      }
-      case Internal::AxisVariantIndex<CategoricalAxis>::value: {
-        const auto *categorical = std::get_if<CategoricalAxis>(&axis);
-        const std::size_t numBins = categorical->GetNumBins();
-        if (categorical->IsOverflowBinEnabled()) {
-          fullRanges[i] = BinIndexRange::FullCategorical(numBins);
-        } else {
-          fullRanges[i] = BinIndexRange(0, numBins);
+private:
+  template <bool Atomic, bool Weighted, typename... P>
+  void FillNImpl(std::size_t n, const std::tuple<P...> &args,
+                 const double *weights) {
+    assert(sizeof...(P) == fAxes.GetNumDimensions());
+    static constexpr std::size_t BatchSize = Detail::Axes::MaxBatchSize;
+    std::size_t bins[BatchSize];
+    for (std::size_t offset = 0; offset < n; offset += BatchSize) {
+      const std::size_t count = std::min(n - offset, BatchSize);
+      fAxes.ComputeBins(args, offset, count, bins);
+      for (std::size_t i = 0; i < count; i++) {
+        const std::size_t bin = bins[i];
+        if (bin != Internal::InvalidBin) {
+          if constexpr (Atomic && Weighted) {
+            Internal::AtomicAddDouble(&fData[bin], weights[offset + i]);
+          } else if constexpr (Atomic) {
+            Internal::AtomicInc(&fData[bin]);
+          } else if constexpr (Weighted) {
+            fData[bin] += weights[offset + i];
+          } else {
+            fData[bin]++;
+          }
         }
-        normalRanges[i] = ranges[i].GetNormalRange(numBins);
-        break;
-      }
       }
     }
+  }
 
-    auto getSliceIndex = [&](std::size_t i, BinIndex index) {
-      if (index.IsNormal()) {
-        // Compare the index to normalRanges[i] and map into the underflow or
-        // overflow bin if outside.
-        if (index < normalRanges[i].GetBegin()) {
-          return BinIndex::Underflow();
-        } else if (index >= normalRanges[i].GetEnd()) {
-          return BinIndex::Overflow();
-        }
+public:
+  // Fill n entries from contiguous arrays, one pointer per dimension. The
+  // arguments are validated and the axis types are dispatched once per batch.
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args) {
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    FillNImpl</*Atomic=*/false, /*Weighted=*/false>(n, args, nullptr);
+  }
 
-        // Otherwise adjust the index by the begin index.
-        const auto beginIndex = normalRanges[i].GetBegin().GetIndex();
-        return BinIndex(index.GetIndex() - beginIndex);
-      }
+  template <typename... A> void FillN(std::size_t n, const A *...args) {
+    FillN(n, std::make_tuple(args...));
+  }
 
-      // All other bins map to themselves, in particular the underflow and
-      // overflow bins.
-      return index;
-    };
-
-    // Create the sliced histogram and copy data.
-    EPHist<T> slice(std::move(slicedAxes));
-    std::array<BinIndexRange::Iterator, N> origIndexIterator;
-    std::array<BinIndex, N> origIndexes;
-    std::array<BinIndex, N> sliceIndexes;
-    for (std::size_t i = 0; i < N; i++) {
-      origIndexIterator[i] = fullRanges[i].begin();
-      origIndexes[i] = *origIndexIterator[i];
-      sliceIndexes[i] = getSliceIndex(i, origIndexes[i]);
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args,
+             const double *weights) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
     }
+    FillNImpl</*Atomic=*/false, /*Weighted=*/true>(n, args, weights);
+  }
 
-    while (true) {
-      const auto origBin = fAxes.ComputeBin(origIndexes);
-      assert(origBin.second);
-      const auto sliceBin = slice.fAxes.ComputeBin(sliceIndexes);
-      assert(sliceBin.second);
-      slice.fData[sliceBin.first] += fData[origBin.first];
-
-      // Advance the indices.
-      bool shouldContinueAdvance = true;
-      for (std::size_t j = 0; j < N; j++) {
-        // Reverse iteration order to improve performance by advancing the
-        // innermost index first.
-        const std::size_t i = N - 1 - j;
-
-        shouldContinueAdvance = false;
-        // Advance this iterator.
-        origIndexIterator[i]++;
-        // If we reached the end, wrap around.
-        if (origIndexIterator[i] == fullRanges[i].end()) {
-          origIndexIterator[i] = fullRanges[i].begin();
-          shouldContinueAdvance = true;
-        }
-        // Get the index by dereferencing the iterator.
-        origIndexes[i] = *origIndexIterator[i];
-        sliceIndexes[i] = getSliceIndex(i, origIndexes[i]);
+  template <typename... P>
+  void FillAtomicN(std::size_t n, const std::tuple<P...> &args) {
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    FillNImpl</*Atomic=*/true, /*Weighted=*/false>(n, args, nullptr);
+  }
 
-        if (!shouldContinueAdvance) {
-          break;
-        }
-      }
-      if (shouldContinueAdvance) {
-        // No more index found to advance, we are done.
-        break;
-      }
+  template <typename... A> void FillAtomicN(std::size_t n, const A *...args) {
+    FillAtomicN(n, std::make_tuple(args...));
+  }
+
+  template <typename... P>
+  void FillAtomicN(std::size_t n, const std::tuple<P...> &args,
+                   const double *weights) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
     }
+    FillNImpl</*Atomic=*/true, /*Weighted=*/true>(n, args, weights);
+  }
 
+  // Slice with up to numThreads threads for large histograms (see
+  // BulkOperations.hxx, numThreads = 0 selects the number of hardware
+  // threads). We have to accept numThreads with a template type I, otherwise
+  // Slice(ranges, 4) would select the variadic function template.
+  template <std::size_t N, typename I>
+  EPHist<T> Slice(const std::array<BinIndexRange, N> &ranges,
+                  I numThreads) const {
+    static_assert(std::is_integral_v<I>, "numThreads must be an integer");
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+
+    // Add runs of consecutive bins instead of mapping every bin.
+    EPHist<T> slice(fAxes.Slice(ranges));
+    const auto map = fAxes.ComputeSliceBinMap(ranges, slice.fAxes);
+    map.ForEachRun(numThreads, [&](std::size_t origBin, std::size_t sliceBin,
+                                   std::size_t n) {
+      Internal::AddArray(slice.fData.data() + sliceBin, fData.data() + origBin,
+                         n);
+    });
     return slice;
   }
 
+  template <std::size_t N>
+  EPHist<T> Slice(const std::array<BinIndexRange, N> &ranges) const {
+    return Slice(ranges, 1);
+  }
+
   template <typename... A> EPHist<T> Slice(const A &...args) const {
     if (sizeof...(A) != fAxes.GetNumDimensions()) {
       throw std::invalid_argument("invalid number of arguments to Slice");
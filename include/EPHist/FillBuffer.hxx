@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_FILLBUFFER
+#define EPHIST_FILLBUFFER
+
+#include "Atomic.hxx"
+#include "BinIndex.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace EPHist {
+namespace Internal {
+
+// A fixed-size buffer of fills into a shared histogram, used by
+// ParallelFillStrategy::Buffered. Fills of the same bin are aggregated in the
+// buffer, and when it holds Capacity distinct bins, each of them is committed
+// with a single atomic instruction. For peaked distributions, this reduces the
+// atomic traffic by the average number of fills per bin, while the memory per
+// fill context stays constant.
+//
+// The buffer is an open-addressing hash table with linear probing, which is
+// cheaper than sorting the fills to find duplicates. The table is at most half
+// full to keep the probe sequences short.
+template <typename T> class FillBuffer final {
+public:
+  static constexpr std::size_t Capacity = 1024;
+
+private:
+  static constexpr unsigned TableBits = 11;
+  static constexpr std::size_t TableSize = std::size_t(1) << TableBits;
+  static_assert(TableSize >= 2 * Capacity, "TableSize is too small");
+
+  T *fData;
+
+  // The bin of each slot, or Internal::InvalidBin for empty slots.
+  std::array<std::size_t, TableSize> fBins;
+  std::array<T, TableSize> fValues;
+  // The used slots, in the order of insertion.
+  std::array<std::size_t, Capacity> fUsedSlots;
+  std::size_t fSize = 0;
+
+  static std::size_t Hash(std::size_t bin) {
+    // Fibonacci hashing: the high bits of the product are well mixed.
+    std::uint64_t h = static_cast<std::uint64_t>(bin) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h >> (64 - TableBits));
+  }
+
+public:
+  // The data must stay alive and in place as long as the buffer is used.
+  explicit FillBuffer(T *data) : fData(data) {
+    fBins.fill(InvalidBin);
+    fValues.fill({});
+  }
+  FillBuffer(const FillBuffer &) = delete;
+  FillBuffer(FillBuffer &&) = delete;
+  FillBuffer &operator=(const FillBuffer &) = delete;
+  FillBuffer &operator=(FillBuffer &&) = delete;
+  ~FillBuffer() { Flush(); }
+
+  // Get the number of distinct bins in the buffer.
+  std::size_t GetSize() const { return fSize; }
+
+  // Fill the bin, with weight w if Weighted is true.
+  template <bool Weighted> void Fill(std::size_t bin, double w) {
+    assert(bin != InvalidBin);
+    std::size_t slot = Hash(bin);
+    while (fBins[slot] != bin) {
+      if (fBins[slot] == InvalidBin) {
+        fBins[slot] = bin;
+        fUsedSlots[fSize] = slot;
+        fSize++;
+        break;
+      }
+      slot = (slot + 1) & (TableSize - 1);
+    }
+
+    if constexpr (Weighted) {
+      fValues[slot] += w;
+    } else {
+      fValues[slot]++;
+    }
+
+    if (fSize == Capacity) {
+      Flush();
+    }
+  }
+
+  // Commit all buffered bins to the histogram, and clear the buffer.
+  void Flush() {
+    for (std::size_t i = 0; i < fSize; i++) {
+      const std::size_t slot = fUsedSlots[i];
+      AtomicAdd(&fData[fBins[slot]], fValues[slot]);
+      fBins[slot] = InvalidBin;
+      fValues[slot] = {};
+    }
+    fSize = 0;
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
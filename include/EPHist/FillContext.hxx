@@ -3,11 +3,20 @@
 #ifndef EPHIST_FILLCONTEXT
 #define EPHIST_FILLCONTEXT
 
+#include "Atomic.hxx"
 #include "EPHist.hxx"
+#include "FillBuffer.hxx"
+#include "HotBinCache.hxx"
+#include "LocalBins.hxx"
+#include "PagedHist.hxx"
 #include "ParallelFillStrategy.hxx"
+#include "Profile.hxx"
 #include "TypeTraits.hxx"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <tuple>
@@ -19,27 +28,190 @@ template <typename T> class ParallelHelper;
 template <typename T> class FillContext final {
   friend class ParallelHelper<T>;
 
+public:
+  // The number of fills sampled by the contention probe of the Automatic
+  // strategy, and the number of previous fills each one is compared to.
+  static constexpr std::size_t ProbeFills = 4096;
+  static constexpr std::size_t ProbeHistory = 8;
+  // The minimum size of the histogram in bytes for which the PerFillContext
+  // strategy allocates the local histogram lazily in pages, see PagedHist.
+  // Smaller histograms use a dense local copy, which is faster to fill.
+  static constexpr std::size_t MinBytesPagedLocalHist = 4 * 1024 * 1024;
+
 private:
   EPHist<T> *fHist;
   ParallelFillStrategy fStrategy;
+  ParallelHelper<T> *fHelper;
+
+  std::unique_ptr<Internal::LocalBins<T>> fLocalBins;
+  std::unique_ptr<PagedHist<T>> fLocalPagedHist;
+  std::unique_ptr<Internal::HotBinCache<T>> fHotBinCache;
+  std::unique_ptr<Internal::FillBuffer<T>> fFillBuffer;
 
-  std::unique_ptr<EPHist<T>> fLocalHist;
+  // For the Automatic strategy: the context fills atomically while probing how
+  // often fills hit the same cache line as one of the previous fills.
+  std::size_t fProbeFills = 0;
+  std::size_t fProbeCollisions = 0;
+  std::array<std::size_t, ProbeHistory> fProbeLines;
 
-  explicit FillContext(EPHist<T> &hist, ParallelFillStrategy strategy)
-      : fHist(&hist), fStrategy(strategy) {
+  // Large local copies are PagedHist, which only allocates the pages that are
+  // filled. EPHist itself stays dense: atomic fills, HotBinCache, FillBuffer,
+  // the bulk operations and the binary format all rely on contiguous bins,
+  // and GetBinContent returns references to them.
+  void CreateLocalHist() {
+    if (fHist->GetTotalNumBins() * sizeof(T) >= MinBytesPagedLocalHist) {
+      fLocalPagedHist.reset(new PagedHist<T>(fHist->GetAxes()));
+    } else {
+      fLocalBins.reset(
+          new Internal::LocalBins<T>(fHist->fData.data(), fHist->fData.size()));
+    }
+  }
+
+  explicit FillContext(EPHist<T> &hist, ParallelFillStrategy strategy,
+                       ParallelHelper<T> *helper)
+      : fHist(&hist), fStrategy(strategy), fHelper(helper) {
     switch (fStrategy) {
     case ParallelFillStrategy::Automatic:
-      assert(0);
-      // Graceful switch to atomic strategy, in case assertions are disabled.
-      fStrategy = ParallelFillStrategy::Atomic;
+      assert(fHelper);
+      fProbeLines.fill(Internal::InvalidBin);
+      break;
     case ParallelFillStrategy::Atomic:
       // Nothing to do...
       break;
     case ParallelFillStrategy::PerFillContext:
-      fLocalHist.reset(new EPHist<T>(fHist->GetAxes()));
+      CreateLocalHist();
+      break;
+    case ParallelFillStrategy::Sharded:
+      // The passed histogram is the shard assigned by the ParallelHelper,
+      // which is shared with other contexts and filled atomically.
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      fHotBinCache.reset(new Internal::HotBinCache<T>(fHist->fData.data()));
+      break;
+    case ParallelFillStrategy::Buffered:
+      fFillBuffer.reset(new Internal::FillBuffer<T>(fHist->fData.data()));
+      break;
+    }
+  }
+  // Switch to the strategy chosen by the ParallelHelper after the probe.
+  void AdoptStrategy(ParallelFillStrategy strategy) {
+    switch (strategy) {
+    case ParallelFillStrategy::Automatic:
+      // Still probing.
+      return;
+    case ParallelFillStrategy::Atomic:
+      break;
+    case ParallelFillStrategy::PerFillContext:
+      CreateLocalHist();
+      break;
+    case ParallelFillStrategy::Sharded:
+      fHist = fHelper->AssignShard();
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      fHotBinCache.reset(new Internal::HotBinCache<T>(fHist->fData.data()));
       break;
+    case ParallelFillStrategy::Buffered:
+      fFillBuffer.reset(new Internal::FillBuffer<T>(fHist->fData.data()));
+      break;
+    }
+    fStrategy = strategy;
+  }
+
+  template <bool Weighted>
+  void ProbeFill(std::pair<std::size_t, bool> bin, double w) {
+    assert(fStrategy == ParallelFillStrategy::Automatic);
+    if (!bin.second) {
+      return;
+    }
+    if constexpr (Weighted) {
+      Internal::AtomicAddDouble(&fHist->fData[bin.first], w);
+    } else {
+      Internal::AtomicInc(&fHist->fData[bin.first]);
+    }
+
+    const std::size_t line = bin.first * sizeof(T) / Internal::CacheLineSize;
+    for (std::size_t previous : fProbeLines) {
+      if (previous == line) {
+        fProbeCollisions++;
+      }
+    }
+    fProbeLines[fProbeFills % ProbeHistory] = line;
+    fProbeFills++;
+
+    if (fProbeFills == ProbeFills) {
+      fHelper->FinishProbe(ProbeFills * ProbeHistory, fProbeCollisions);
+    }
+    // Another context may have finished its probe before this one.
+    AdoptStrategy(fHelper->GetStrategy());
+  }
+
+  template <bool Weighted, typename... P>
+  void ProbeFillN(std::size_t n, const std::tuple<P...> &args,
+                  const double *weights) {
+    static constexpr std::size_t BatchSize = Detail::Axes::MaxBatchSize;
+    std::size_t bins[BatchSize];
+    std::size_t offset = 0;
+    while (offset < n && fStrategy == ParallelFillStrategy::Automatic) {
+      const std::size_t count = std::min(n - offset, BatchSize);
+      fHist->fAxes.ComputeBins(args, offset, count, bins);
+      for (std::size_t i = 0; i < count; i++) {
+        const bool valid = bins[i] != Internal::InvalidBin;
+        if constexpr (Weighted) {
+          ProbeFill<true>({bins[i], valid}, weights[offset + i]);
+        } else {
+          ProbeFill<false>({bins[i], valid}, 0);
+        }
+        if (fStrategy != ParallelFillStrategy::Automatic) {
+          // Fill the remaining entries with the chosen strategy.
+          offset += i + 1;
+          break;
+        }
+      }
+      if (fStrategy == ParallelFillStrategy::Automatic) {
+        offset += count;
+      }
+    }
+    if (offset < n) {
+      auto remaining = std::apply(
+          [offset](const auto *...p) { return std::make_tuple(p + offset...); },
+          args);
+      if constexpr (Weighted) {
+        FillN(n - offset, remaining, weights + offset);
+      } else {
+        FillN(n - offset, remaining);
+      }
+    }
+  }
+
+  // Fill a computed bin into a HotBinCache or a FillBuffer.
+  template <bool Weighted, typename Sink>
+  static void FillBin(Sink &sink, std::pair<std::size_t, bool> bin, double w) {
+    if (bin.second) {
+      sink.template Fill<Weighted>(bin.first, w);
     }
   }
+
+  template <bool Weighted, typename Sink, typename... P>
+  void FillBinsN(Sink &sink, std::size_t n, const std::tuple<P...> &args,
+                 const double *weights) {
+    static constexpr std::size_t BatchSize = Detail::Axes::MaxBatchSize;
+    std::size_t bins[BatchSize];
+    for (std::size_t offset = 0; offset < n; offset += BatchSize) {
+      const std::size_t count = std::min(n - offset, BatchSize);
+      fHist->fAxes.ComputeBins(args, offset, count, bins);
+      for (std::size_t i = 0; i < count; i++) {
+        if (bins[i] == Internal::InvalidBin) {
+          continue;
+        }
+        if constexpr (Weighted) {
+          sink.template Fill<true>(bins[i], weights[offset + i]);
+        } else {
+          sink.template Fill<false>(bins[i], 0);
+        }
+      }
+    }
+  }
+
   FillContext(const FillContext<T> &) = delete;
   FillContext(FillContext<T> &&) = default;
   FillContext<T> &operator=(const FillContext<T> &) = delete;
@@ -50,8 +222,21 @@ public:
 
   void Flush() {
     if (fStrategy == ParallelFillStrategy::PerFillContext) {
-      assert(fLocalHist);
-      fHist->AddAtomic(*fLocalHist);
+      // Only the filled pages or blocks are added, and cleared so that
+      // flushing again does not add them twice.
+      if (fLocalPagedHist) {
+        fLocalPagedHist->AddAtomicTo(*fHist);
+        fLocalPagedHist->Clear();
+      } else {
+        assert(fLocalBins);
+        fLocalBins->Flush();
+      }
+    } else if (fStrategy == ParallelFillStrategy::HotBinCache) {
+      assert(fHotBinCache);
+      fHotBinCache->Flush();
+    } else if (fStrategy == ParallelFillStrategy::Buffered) {
+      assert(fFillBuffer);
+      fFillBuffer->Flush();
     }
   }
 
@@ -66,12 +251,27 @@ private:
     assert(N == fHist->GetNumDimensions());
     switch (fStrategy) {
     case ParallelFillStrategy::Automatic:
+      ProbeFill<true>(fHist->fAxes.template ComputeBin<N>(args), w.fValue);
+      break;
     case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
       fHist->template FillAtomicImpl<N>(args, w);
       break;
     case ParallelFillStrategy::PerFillContext:
-      assert(fLocalHist);
-      fLocalHist->template FillImpl<N>(args, w);
+      if (fLocalPagedHist) {
+        fLocalPagedHist->template FillImpl<N>(args, w);
+      } else {
+        FillBin<true>(*fLocalBins, fHist->fAxes.template ComputeBin<N>(args),
+                      w.fValue);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBin<true>(*fHotBinCache, fHist->fAxes.template ComputeBin<N>(args),
+                    w.fValue);
+      break;
+    case ParallelFillStrategy::Buffered:
+      FillBin<true>(*fFillBuffer, fHist->fAxes.template ComputeBin<N>(args),
+                    w.fValue);
       break;
     }
   }
@@ -83,12 +283,24 @@ public:
     }
     switch (fStrategy) {
     case ParallelFillStrategy::Automatic:
+      ProbeFill<false>(fHist->fAxes.ComputeBin(args), 0);
+      break;
     case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
       fHist->FillAtomic(args);
       break;
     case ParallelFillStrategy::PerFillContext:
-      assert(fLocalHist);
-      fLocalHist->Fill(args);
+      if (fLocalPagedHist) {
+        fLocalPagedHist->Fill(args);
+      } else {
+        FillBin<false>(*fLocalBins, fHist->fAxes.ComputeBin(args), 0);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBin<false>(*fHotBinCache, fHist->fAxes.ComputeBin(args), 0);
+      break;
+    case ParallelFillStrategy::Buffered:
+      FillBin<false>(*fFillBuffer, fHist->fAxes.ComputeBin(args), 0);
       break;
     }
   }
@@ -121,12 +333,27 @@ public:
     }
     switch (fStrategy) {
     case ParallelFillStrategy::Automatic:
+      ProbeFill<false>(fHist->fAxes.template ComputeBin<Axes...>(args...), 0);
+      break;
     case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
       fHist->template FillAtomic<Axes...>(args...);
       break;
     case ParallelFillStrategy::PerFillContext:
-      assert(fLocalHist);
-      fLocalHist->template Fill<Axes...>(args...);
+      if (fLocalPagedHist) {
+        fLocalPagedHist->template Fill<Axes...>(args...);
+      } else {
+        FillBin<false>(*fLocalBins,
+                       fHist->fAxes.template ComputeBin<Axes...>(args...), 0);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBin<false>(*fHotBinCache,
+                     fHist->fAxes.template ComputeBin<Axes...>(args...), 0);
+      break;
+    case ParallelFillStrategy::Buffered:
+      FillBin<false>(*fFillBuffer,
+                     fHist->fAxes.template ComputeBin<Axes...>(args...), 0);
       break;
     }
   }
@@ -151,13 +378,226 @@ public:
     }
     switch (fStrategy) {
     case ParallelFillStrategy::Automatic:
+      ProbeFill<true>(fHist->fAxes.template ComputeBin<Axes...>(args...),
+                      w.fValue);
+      break;
     case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
       fHist->template FillAtomic<Axes...>(args..., w);
       break;
     case ParallelFillStrategy::PerFillContext:
-      assert(fLocalHist);
-      fLocalHist->template Fill<Axes...>(args..., w);
+      if (fLocalPagedHist) {
+        fLocalPagedHist->template Fill<Axes...>(args..., w);
+      } else {
+        FillBin<true>(*fLocalBins,
+                      fHist->fAxes.template ComputeBin<Axes...>(args...),
+                      w.fValue);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBin<true>(*fHotBinCache,
+                    fHist->fAxes.template ComputeBin<Axes...>(args...),
+                    w.fValue);
       break;
+    case ParallelFillStrategy::Buffered:
+      FillBin<true>(*fFillBuffer,
+                    fHist->fAxes.template ComputeBin<Axes...>(args...),
+                    w.fValue);
+      break;
+    }
+  }
+
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args) {
+    if (sizeof...(P) != fHist->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    switch (fStrategy) {
+    case ParallelFillStrategy::Automatic:
+      ProbeFillN</*Weighted=*/false>(n, args, nullptr);
+      break;
+    case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
+      fHist->FillAtomicN(n, args);
+      break;
+    case ParallelFillStrategy::PerFillContext:
+      if (fLocalPagedHist) {
+        fLocalPagedHist->FillN(n, args);
+      } else {
+        FillBinsN</*Weighted=*/false>(*fLocalBins, n, args, nullptr);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBinsN</*Weighted=*/false>(*fHotBinCache, n, args, nullptr);
+      break;
+    case ParallelFillStrategy::Buffered:
+      FillBinsN</*Weighted=*/false>(*fFillBuffer, n, args, nullptr);
+      break;
+    }
+  }
+
+  template <typename... A> void FillN(std::size_t n, const A *...args) {
+    FillN(n, std::make_tuple(args...));
+  }
+
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args,
+             const double *weights) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(P) != fHist->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    switch (fStrategy) {
+    case ParallelFillStrategy::Automatic:
+      ProbeFillN</*Weighted=*/true>(n, args, weights);
+      break;
+    case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::Sharded:
+      fHist->FillAtomicN(n, args, weights);
+      break;
+    case ParallelFillStrategy::PerFillContext:
+      if (fLocalPagedHist) {
+        fLocalPagedHist->FillN(n, args, weights);
+      } else {
+        FillBinsN</*Weighted=*/true>(*fLocalBins, n, args, weights);
+      }
+      break;
+    case ParallelFillStrategy::HotBinCache:
+      FillBinsN</*Weighted=*/true>(*fHotBinCache, n, args, weights);
+      break;
+    case ParallelFillStrategy::Buffered:
+      FillBinsN</*Weighted=*/true>(*fFillBuffer, n, args, weights);
+      break;
+    }
+  }
+};
+
+// Profiles support the Atomic and PerFillContext strategies: their bins hold
+// multiple sums, so the bin-based strategies of histograms do not apply. Like
+// for histograms, the local copy of PerFillContext tracks the filled blocks
+// (see LocalBins), so flushing is proportional to the number of filled blocks.
+template <bool WithError> class FillContext<Profile<WithError>> final {
+  friend class ParallelHelper<Profile<WithError>>;
+
+  using BinContentType = typename Profile<WithError>::BinContentType;
+
+private:
+  Profile<WithError> *fProfile;
+  ParallelFillStrategy fStrategy;
+
+  std::unique_ptr<Internal::LocalBins<BinContentType>> fLocalBins;
+
+  explicit FillContext(Profile<WithError> &profile,
+                       ParallelFillStrategy strategy)
+      : fProfile(&profile), fStrategy(strategy) {
+    switch (fStrategy) {
+    case ParallelFillStrategy::Atomic:
+      // Nothing to do...
+      break;
+    case ParallelFillStrategy::PerFillContext:
+      fLocalBins.reset(new Internal::LocalBins<BinContentType>(
+          fProfile->fData.data(), fProfile->fData.size()));
+      break;
+    default:
+      // Rejected by the ParallelHelper.
+      assert(0);
+      break;
+    }
+  }
+
+  FillContext(const FillContext &) = delete;
+  FillContext(FillContext &&) = default;
+  FillContext &operator=(const FillContext &) = delete;
+  FillContext &operator=(FillContext &&) = default;
+
+  template <std::size_t N, typename... A>
+  void FillLocalImpl(const std::tuple<A...> &args, double v) {
+    assert(N == fProfile->GetNumDimensions());
+    auto bin = fProfile->fAxes.template ComputeBin<N>(args);
+    if (bin.second) {
+      fLocalBins->Update(bin.first).Add(v);
+    }
+  }
+
+  template <std::size_t N, typename... A>
+  void FillLocalImpl(const std::tuple<A...> &args, double v, Weight w) {
+    assert(N == fProfile->GetNumDimensions());
+    auto bin = fProfile->fAxes.template ComputeBin<N>(args);
+    if (bin.second) {
+      fLocalBins->Update(bin.first).Add(v, w.fValue);
+    }
+  }
+
+  // The overloads of FillLocal mirror those of Profile::Fill.
+  template <typename... A> void FillLocal(const std::tuple<A...> &args) {
+    if (sizeof...(A) - 1 != fProfile->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillLocalImpl<sizeof...(A) - 1>(args, std::get<sizeof...(A) - 1>(args));
+  }
+
+  template <typename... A, typename V>
+  void FillLocal(const std::tuple<A...> &args, const V &v) {
+    if (sizeof...(A) != fProfile->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillLocalImpl<sizeof...(A)>(args, v);
+  }
+
+  template <typename... A> void FillLocal(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      if (sizeof...(A) - 2 != fProfile->GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillLocalImpl<sizeof...(A) - 2>(t, std::get<sizeof...(A) - 2>(t),
+                                      std::get<sizeof...(A) - 1>(t));
+    } else {
+      if (sizeof...(A) - 1 != fProfile->GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillLocal(t);
+    }
+  }
+
+  template <typename... A>
+  void FillLocal(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) - 1 != fProfile->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillLocalImpl<sizeof...(A) - 1>(args, std::get<sizeof...(A) - 1>(args), w);
+  }
+
+  template <typename... A, typename V>
+  void FillLocal(const std::tuple<A...> &args, const V &v, Weight w) {
+    if (sizeof...(A) != fProfile->GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillLocalImpl<sizeof...(A)>(args, v, w);
+  }
+
+public:
+  ~FillContext() { Flush(); }
+
+  void Flush() {
+    if (fStrategy == ParallelFillStrategy::PerFillContext) {
+      // Only the filled blocks are added, and cleared so that flushing again
+      // does not add them twice.
+      assert(fLocalBins);
+      fLocalBins->Flush();
+    }
+  }
+
+  // Accepts the same arguments as Profile::Fill.
+  template <typename... A> void Fill(const A &...args) {
+    if (fStrategy == ParallelFillStrategy::PerFillContext) {
+      assert(fLocalBins);
+      FillLocal(args...);
+    } else {
+      fProfile->FillAtomic(args...);
     }
   }
 };
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_FIXEDPOINTBIN
+#define EPHIST_FIXEDPOINTBIN
+
+#include "Atomic.hxx"
+
+#include <cmath>
+#include <cstdint>
+
+namespace EPHist {
+
+// A bin content type for weighted fills that accumulates the weights as 64-bit
+// fixed-point integers. Atomic additions are single integer instructions
+// without compare-and-swap loops, and the result does not depend on the order
+// of additions, which makes parallel filling reproducible. With 24 fractional
+// bits, weights are rounded to multiples of 2^-24 (about 6e-8), and the sum of
+// weights must stay below 2^39 (about 5.5e11) in magnitude.
+struct FixedPointBin {
+  static constexpr int FractionalBits = 24;
+  static constexpr double Scale = static_cast<double>(1ll << FractionalBits);
+
+  std::int64_t fValue = 0;
+
+  static std::int64_t FromDouble(double w) { return std::llround(w * Scale); }
+  double GetValue() const { return fValue / Scale; }
+
+  FixedPointBin &operator++() {
+    fValue += std::int64_t(1) << FractionalBits;
+    return *this;
+  }
+
+  FixedPointBin operator++(int) {
+    FixedPointBin old = *this;
+    operator++();
+    return old;
+  }
+
+  FixedPointBin &operator+=(const FixedPointBin &rhs) {
+    fValue += rhs.fValue;
+    return *this;
+  }
+
+  FixedPointBin &operator+=(double w) {
+    fValue += FromDouble(w);
+    return *this;
+  }
+
+  void AtomicInc() {
+    Internal::AtomicAdd(&fValue, std::int64_t(1) << FractionalBits);
+  }
+
+  void AtomicAdd(const FixedPointBin &rhs) {
+    Internal::AtomicAdd(&fValue, rhs.fValue);
+  }
+
+  void AtomicAddDouble(double w) {
+    Internal::AtomicAdd(&fValue, FromDouble(w));
+  }
+};
+
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_HOTBINCACHE
+#define EPHIST_HOTBINCACHE
+
+#include "Atomic.hxx"
+#include "BinIndex.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace EPHist {
+namespace Internal {
+
+// A small private cache of the most frequently filled bins of a shared
+// histogram, used by ParallelFillStrategy::HotBinCache. Hot bins are
+// accumulated locally without atomic instructions, while cold bins are filled
+// atomically into the shared histogram.
+//
+// The cache is direct-mapped: each bin can only be cached in one slot. Every
+// slot has a saturating score that is incremented for each fill of the cached
+// bin and decremented for each fill of another bin mapping to the same slot.
+// Only when the score has dropped to zero and the same other bin is filled
+// twice in a row, the cached bin is evicted (and added atomically to the
+// histogram) and the other bin is promoted. This avoids thrashing the cache
+// for wide distributions without hot bins. Consecutive bins map to different
+// slots, so a narrow peak of neighboring bins is cached completely.
+template <typename T> class HotBinCache final {
+public:
+  static constexpr std::size_t Size = 64;
+  static constexpr std::uint8_t MaxScore = 16;
+
+private:
+  static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+  T *fData;
+
+  std::array<std::size_t, Size> fBins;
+  std::array<T, Size> fValues;
+  std::array<std::uint8_t, Size> fScores;
+  // The last bin that missed the cache, the candidate for promotion.
+  std::array<std::size_t, Size> fCandidates;
+
+  void Evict(std::size_t slot) {
+    if (fBins[slot] != InvalidBin) {
+      AtomicAdd(&fData[fBins[slot]], fValues[slot]);
+    }
+    fBins[slot] = InvalidBin;
+    fValues[slot] = {};
+    fScores[slot] = 0;
+  }
+
+public:
+  // The data must stay alive and in place as long as the cache is used.
+  explicit HotBinCache(T *data) : fData(data) {
+    fBins.fill(InvalidBin);
+    fValues.fill({});
+    fScores.fill(0);
+    fCandidates.fill(InvalidBin);
+  }
+  HotBinCache(const HotBinCache &) = delete;
+  HotBinCache(HotBinCache &&) = delete;
+  HotBinCache &operator=(const HotBinCache &) = delete;
+  HotBinCache &operator=(HotBinCache &&) = delete;
+  ~HotBinCache() { Flush(); }
+
+  // Fill the bin, with weight w if Weighted is true.
+  template <bool Weighted> void Fill(std::size_t bin, double w) {
+    assert(bin != InvalidBin);
+    const std::size_t slot = bin & (Size - 1);
+    if (fBins[slot] != bin) {
+      const bool promote = fBins[slot] == InvalidBin ||
+                           (fScores[slot] == 0 && fCandidates[slot] == bin);
+      if (!promote) {
+        // The cached bin is hotter, fill atomically.
+        if (fScores[slot] > 0) {
+          fScores[slot]--;
+        }
+        fCandidates[slot] = bin;
+        if constexpr (Weighted) {
+          AtomicAddDouble(&fData[bin], w);
+        } else {
+          AtomicInc(&fData[bin]);
+        }
+        return;
+      }
+      // Promote the bin, and give back the cached content.
+      Evict(slot);
+      fBins[slot] = bin;
+    }
+
+    if (fScores[slot] < MaxScore) {
+      fScores[slot]++;
+    }
+    if constexpr (Weighted) {
+      fValues[slot] += w;
+    } else {
+      fValues[slot]++;
+    }
+  }
+
+  // Add all cached bin contents to the histogram, and clear the cache.
+  void Flush() {
+    for (std::size_t slot = 0; slot < Size; slot++) {
+      Evict(slot);
+    }
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_INTCATEGORICALAXIS
+#define EPHIST_INTCATEGORICALAXIS
+
+#include "BinIndex.hxx"
+#include "BinIndexRange.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+// A categorical axis for integer values, for example PDG codes, run numbers,
+// or detector module IDs.
+class IntCategoricalAxis final {
+public:
+  using ArgumentType = std::int64_t;
+
+private:
+  // Use a dense table if the range of values is at most this factor larger
+  // than the number of categories.
+  static constexpr std::uint64_t MaxDenseTableFactor = 4;
+
+  std::vector<std::int64_t> fCategories;
+  bool fEnableOverflowBin;
+
+  // Both tables store the bin index plus one for each category (zero marks
+  // values that are not categories and empty slots, respectively). Only one
+  // of them is filled, depending on the range of values.
+  // The dense table is indexed by the offset of the value from fMin.
+  std::vector<std::size_t> fDenseTable;
+  std::int64_t fMin = 0;
+  // The hash table uses open addressing with linear probing. The size is a
+  // power of two and at least twice the number of categories.
+  std::vector<std::size_t> fHashTable;
+  std::size_t fHashMask = 0;
+  unsigned fHashShift = 64;
+
+  std::size_t Hash(std::int64_t x) const {
+    // Fibonacci hashing: the high bits of the product are well mixed.
+    std::uint64_t h = static_cast<std::uint64_t>(x) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h >> fHashShift);
+  }
+
+  void BuildDenseTable(std::uint64_t range) {
+    fDenseTable.assign(range, 0);
+    for (std::size_t bin = 0; bin < fCategories.size(); bin++) {
+      const std::uint64_t offset =
+          static_cast<std::uint64_t>(fCategories[bin]) -
+          static_cast<std::uint64_t>(fMin);
+      if (fDenseTable[offset] != 0) {
+        throw std::invalid_argument("duplicate categories");
+      }
+      fDenseTable[offset] = bin + 1;
+    }
+  }
+
+  void BuildHashTable() {
+    std::size_t size = 2;
+    fHashShift = 63;
+    while (size < 2 * fCategories.size()) {
+      size *= 2;
+      fHashShift--;
+    }
+    fHashTable.assign(size, 0);
+    fHashMask = size - 1;
+    for (std::size_t bin = 0; bin < fCategories.size(); bin++) {
+      std::size_t slot = Hash(fCategories[bin]) & fHashMask;
+      while (fHashTable[slot] != 0) {
+        if (fCategories[fHashTable[slot] - 1] == fCategories[bin]) {
+          throw std::invalid_argument("duplicate categories");
+        }
+        slot = (slot + 1) & fHashMask;
+      }
+      fHashTable[slot] = bin + 1;
+    }
+  }
+
+public:
+  explicit IntCategoricalAxis(std::vector<std::int64_t> categories,
+                              bool enableOverflowBin = true)
+      : fCategories(std::move(categories)),
+        fEnableOverflowBin(enableOverflowBin) {
+    if (fCategories.empty()) {
+      return;
+    }
+    fMin = fCategories[0];
+    std::int64_t max = fCategories[0];
+    for (auto category : fCategories) {
+      fMin = std::min(fMin, category);
+      max = std::max(max, category);
+    }
+    // Compute in unsigned arithmetic to avoid overflows for large ranges.
+    const std::uint64_t range = static_cast<std::uint64_t>(max) -
+                                static_cast<std::uint64_t>(fMin) + 1;
+    if (range != 0 && range <= MaxDenseTableFactor * fCategories.size()) {
+      BuildDenseTable(range);
+    } else {
+      BuildHashTable();
+    }
+  }
+
+  std::size_t GetNumBins() const { return fCategories.size(); }
+  std::size_t GetTotalNumBins() const {
+    return fEnableOverflowBin ? fCategories.size() + 1 : fCategories.size();
+  }
+  const std::vector<std::int64_t> &GetCategories() const {
+    return fCategories;
+  }
+  std::int64_t GetCategory(std::size_t bin) const { return fCategories[bin]; }
+  bool IsOverflowBinEnabled() const { return fEnableOverflowBin; }
+
+  std::pair<std::size_t, bool> GetBin(BinIndex index) const {
+    if (index.IsUnderflow()) {
+      return {0, false};
+    } else if (index.IsOverflow()) {
+      return {fCategories.size(), fEnableOverflowBin};
+    } else if (index.IsInvalid()) {
+      return {0, false};
+    }
+    assert(index.IsNormal());
+    std::size_t bin = index.GetIndex();
+    return {bin, bin < fCategories.size()};
+  }
+
+  std::pair<std::size_t, bool> ComputeBin(std::int64_t x) const {
+    if (!fDenseTable.empty()) {
+      const std::uint64_t offset =
+          static_cast<std::uint64_t>(x) - static_cast<std::uint64_t>(fMin);
+      if (offset < fDenseTable.size() && fDenseTable[offset] != 0) {
+        return {fDenseTable[offset] - 1, true};
+      }
+    } else if (!fHashTable.empty()) {
+      std::size_t slot = Hash(x) & fHashMask;
+      while (fHashTable[slot] != 0) {
+        const std::size_t bin = fHashTable[slot] - 1;
+        if (fCategories[bin] == x) {
+          return {bin, true};
+        }
+        slot = (slot + 1) & fHashMask;
+      }
+    }
+
+    // Category not found
+    return {fCategories.size(), fEnableOverflowBin};
+  }
+
+  // Compute the bins for n arguments at once; arguments outside of the axis
+  // (and without enabled overflow bin) are marked with Internal::InvalidBin.
+  template <typename A>
+  void ComputeBins(const A *x, std::size_t n, std::size_t *bins) const {
+    for (std::size_t i = 0; i < n; i++) {
+      auto bin = ComputeBin(x[i]);
+      bins[i] = bin.second ? bin.first : Internal::InvalidBin;
+    }
+  }
+
+  IntCategoricalAxis Slice(const BinIndexRange &range) const {
+    const auto normalRange = range.GetNormalRange(fCategories.size());
+
+    const auto begin = normalRange.GetBegin();
+    const auto end = normalRange.GetEnd();
+    assert(begin.IsNormal());
+    assert(end.IsNormal());
+    assert(begin <= end);
+
+    std::vector categories(fCategories.begin() + begin.GetIndex(),
+                           fCategories.begin() + end.GetIndex());
+    // Always enable overflow bin.
+    const auto enableOverflowBin = true;
+    return IntCategoricalAxis(std::move(categories), enableOverflowBin);
+  }
+
+  friend bool operator==(const IntCategoricalAxis &lhs,
+                         const IntCategoricalAxis &rhs) {
+    return lhs.fCategories == rhs.fCategories &&
+           lhs.fEnableOverflowBin == rhs.fEnableOverflowBin;
+  }
+};
+
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_LOCALBINS
+#define EPHIST_LOCALBINS
+
+#include "BinIndex.hxx"
+#include "BulkOperations.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// A private dense copy of the bins of a shared histogram or profile, used by
+// ParallelFillStrategy::PerFillContext. It tracks which blocks of bins were
+// filled, and Flush() only adds those blocks to the histogram, with atomic
+// instructions, and clears them. This makes flushing proportional to the
+// number of filled blocks instead of the total number of bins, and Flush()
+// can be called periodically without adding the same fills again.
+template <typename T> class LocalBins final {
+public:
+  static constexpr unsigned BlockBits = 8;
+  static constexpr std::size_t BlockBins = std::size_t(1) << BlockBits;
+
+private:
+  T *fData;
+  std::vector<T> fBins;
+  // One byte per block instead of one bit, so that marking a block as dirty
+  // is a plain store without reading the previous value.
+  std::vector<unsigned char> fDirty;
+
+public:
+  // The data must stay alive and in place as long as the copy is used.
+  LocalBins(T *data, std::size_t numBins)
+      : fData(data), fBins(numBins),
+        fDirty((numBins + BlockBins - 1) / BlockBins) {}
+  LocalBins(const LocalBins &) = delete;
+  LocalBins(LocalBins &&) = delete;
+  LocalBins &operator=(const LocalBins &) = delete;
+  LocalBins &operator=(LocalBins &&) = delete;
+  ~LocalBins() { Flush(); }
+
+  // Get the number of blocks filled since the last Flush().
+  std::size_t GetNumDirtyBlocks() const {
+    return std::count(fDirty.begin(), fDirty.end(), 1);
+  }
+
+  // Fill the bin, with weight w if Weighted is true.
+  template <bool Weighted> void Fill(std::size_t bin, double w) {
+    assert(bin != InvalidBin);
+    if constexpr (Weighted) {
+      fBins[bin] += w;
+    } else {
+      fBins[bin]++;
+    }
+    fDirty[bin >> BlockBits] = 1;
+  }
+
+  // Get the bin to update it in place, for bins with multiple sums such as
+  // those of Profile.
+  T &Update(std::size_t bin) {
+    assert(bin != InvalidBin);
+    fDirty[bin >> BlockBits] = 1;
+    return fBins[bin];
+  }
+
+  // Add all dirty blocks to the histogram, and clear them.
+  void Flush() {
+    for (std::size_t block = 0; block < fDirty.size(); block++) {
+      if (!fDirty[block]) {
+        continue;
+      }
+      const std::size_t begin = block * BlockBins;
+      const std::size_t n = std::min(BlockBins, fBins.size() - begin);
+      AtomicAddArray(fData + begin, fBins.data() + begin, n);
+      ClearArray(fBins.data() + begin, n);
+      fDirty[block] = 0;
+    }
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_PAGEDHIST
+#define EPHIST_PAGEDHIST
+
+#include "Axes.hxx"
+#include "BinIndex.hxx"
+#include "BulkOperations.hxx"
+#include "EPHist.hxx"
+#include "PagedStorage.hxx"
+#include "TypeTraits.hxx"
+#include "Weight.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+template <typename T> class FillContext;
+
+// A histogram with the same filling interface as EPHist<T>, but allocating
+// its bins lazily in pages, see Internal::PagedStorage. It is meant as a
+// private, single-threaded histogram that is eventually added to an EPHist:
+// construction is cheap, and adding only visits the pages that were filled
+// since the last Clear().
+// Bin contents are returned by value. There is no FillAtomic because pages
+// are allocated without synchronization.
+template <typename T> class PagedHist final {
+  friend class FillContext<T>;
+
+public:
+  using BinContentType = T;
+
+private:
+  // The axes are declared first to compute the number of bins.
+  Detail::Axes fAxes;
+
+  Internal::PagedStorage<T> fData;
+
+public:
+  explicit PagedHist(std::vector<AxisVariant> axes)
+      : fAxes(std::move(axes)), fData(fAxes.ComputeTotalNumBins()) {}
+
+  PagedHist(std::size_t numBins, double low, double high)
+      : PagedHist({RegularAxis(numBins, low, high)}) {}
+  explicit PagedHist(const RegularAxis &axis)
+      : PagedHist(std::vector<AxisVariant>{axis}) {}
+  explicit PagedHist(const VariableBinAxis &axis)
+      : PagedHist(std::vector<AxisVariant>{axis}) {}
+  explicit PagedHist(const CategoricalAxis &axis)
+      : PagedHist(std::vector<AxisVariant>{axis}) {}
+  explicit PagedHist(const IntCategoricalAxis &axis)
+      : PagedHist(std::vector<AxisVariant>{axis}) {}
+
+  // Convert to an EPHist, allocating all bins.
+  EPHist<T> ToEPHist() const {
+    EPHist<T> h(fAxes.GetVector());
+    AddTo(h);
+    return h;
+  }
+
+  // Copy constructor and assignment operator are deleted to avoid surprises.
+  // Use the explicit Clone() function to create a copy.
+  PagedHist(const PagedHist<T> &) = delete;
+  PagedHist(PagedHist<T> &&) = default;
+  PagedHist<T> &operator=(const PagedHist<T> &) = delete;
+  PagedHist<T> &operator=(PagedHist<T> &&) = default;
+  ~PagedHist() = default;
+
+  void Add(const PagedHist<T> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.Add(other.fData);
+  }
+
+  // Add the bins of this histogram to an EPHist, skipping pages that were
+  // never filled.
+  void AddTo(EPHist<T> &h) const {
+    if (fAxes != h.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.ForEachPage([&](std::size_t begin, const T *data, std::size_t n) {
+      Internal::AddArray(h.fData.data() + begin, data, n);
+    });
+  }
+
+  void AddAtomicTo(EPHist<T> &h) const {
+    if (fAxes != h.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.ForEachPage([&](std::size_t begin, const T *data, std::size_t n) {
+      Internal::AtomicAddArray(h.fData.data() + begin, data, n);
+    });
+  }
+
+  // Reset all bins, keeping the allocated pages for reuse.
+  void Clear() { fData.Clear(); }
+
+  PagedHist<T> Clone() const {
+    PagedHist<T> h(fAxes.GetVector());
+    h.fData.Add(fData);
+    return h;
+  }
+
+  T GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < fData.GetSize());
+    const T *value = fData.Find(bin);
+    return value ? *value : T{};
+  }
+  template <std::size_t N>
+  T GetBinContentAt(const std::array<BinIndex, N> &args) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return GetBinContent(bin.first);
+  }
+  template <typename... A> T GetBinContentAt(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    std::array<BinIndex, sizeof...(A)> a{args...};
+    return GetBinContentAt(a);
+  }
+  std::size_t GetTotalNumBins() const { return fData.GetSize(); }
+  std::size_t GetNumPages() const { return fData.GetNumPages(); }
+  // Get the number of pages that were filled since the last Clear().
+  std::size_t GetNumUsedPages() const { return fData.GetNumUsedPages(); }
+
+  const std::vector<AxisVariant> &GetAxes() const { return fAxes.GetVector(); }
+  std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
+
+  static constexpr bool SupportsWeightedFill = EPHist<T>::SupportsWeightedFill;
+
+private:
+  template <std::size_t N, typename... A>
+  void FillImpl(const std::tuple<A...> &args, Weight w) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      fData[bin.first] += w.fValue;
+    }
+  }
+
+  template <bool Weighted, typename... P>
+  void FillNImpl(std::size_t n, const std::tuple<P...> &args,
+                 const double *weights) {
+    assert(sizeof...(P) == fAxes.GetNumDimensions());
+    static constexpr std::size_t BatchSize = Detail::Axes::MaxBatchSize;
+    // Initialized once per call: GCC cannot see that ComputeBins writes all
+    // count bins, and warns about maybe-uninitialized reads otherwise.
+    std::size_t bins[BatchSize] = {};
+    for (std::size_t offset = 0; offset < n; offset += BatchSize) {
+      const std::size_t count = std::min(n - offset, BatchSize);
+      fAxes.ComputeBins(args, offset, count, bins);
+      for (std::size_t i = 0; i < count; i++) {
+        const std::size_t bin = bins[i];
+        if (bin != Internal::InvalidBin) {
+          if constexpr (Weighted) {
+            fData[bin] += weights[offset + i];
+          } else {
+            fData[bin]++;
+          }
+        }
+      }
+    }
+  }
+
+public:
+  template <typename... A> void Fill(const std::tuple<A...> &args) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (bin.second) {
+      fData[bin.first]++;
+    }
+  }
+
+  template <typename... A> void Fill(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    // Could use std::tuple_element_t<sizeof...(A) - 1, decltype(t)>, but that
+    // would be const Weight &
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      static_assert(
+          SupportsWeightedFill,
+          "Fill with Weight is only supported for floating point bin types");
+      if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillImpl<sizeof...(A) - 1>(t, std::get<sizeof...(A) - 1>(t));
+    } else {
+      if (sizeof...(A) != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      Fill(t);
+    }
+  }
+
+  template <class... Axes>
+  void Fill(const typename Axes::ArgumentType &...args) {
+    if (sizeof...(Axes) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    auto bin = fAxes.ComputeBin<Axes...>(args...);
+    if (bin.second) {
+      fData[bin.first]++;
+    }
+  }
+
+  template <typename... A> void Fill(const std::tuple<A...> &args, Weight w) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl<sizeof...(A)>(args, w);
+  }
+
+  template <class... Axes>
+  void Fill(const typename Axes::ArgumentType &...args, Weight w) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(Axes) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    auto bin = fAxes.ComputeBin<Axes...>(args...);
+    if (bin.second) {
+      fData[bin.first] += w.fValue;
+    }
+  }
+
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args) {
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    FillNImpl</*Weighted=*/false>(n, args, nullptr);
+  }
+
+  template <typename... A> void FillN(std::size_t n, const A *...args) {
+    FillN(n, std::make_tuple(args...));
+  }
+
+  template <typename... P>
+  void FillN(std::size_t n, const std::tuple<P...> &args,
+             const double *weights) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    if (sizeof...(P) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to FillN");
+    }
+    FillNImpl</*Weighted=*/true>(n, args, weights);
+  }
+};
+
+} // namespace EPHist
+
+#endif
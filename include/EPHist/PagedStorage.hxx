@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_PAGEDSTORAGE
+#define EPHIST_PAGEDSTORAGE
+
+#include "BulkOperations.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// Dense storage of bins in pages of 4 KiB that are only allocated (and zeroed)
+// when one of their bins is first written. Constructing the storage is cheap
+// even for large histograms, and memory is only touched for the pages that
+// are used. A bitmap of the pages in use allows operations on all bins to skip
+// large ranges of untouched pages without looking at the page pointers.
+// Clearing zeroes the pages and keeps them for reuse, but they are only used
+// again when one of their bins is written, so the pages in use are exactly
+// those written since the last Clear().
+template <typename T> class PagedStorage final {
+public:
+  static constexpr std::size_t PageBins =
+      std::max<std::size_t>(1, 4096 / sizeof(T));
+
+private:
+  static constexpr std::size_t BitmapWordBits = 64;
+
+  std::size_t fSize;
+  std::size_t fNumUsedPages = 0;
+  std::vector<std::unique_ptr<T[]>> fPages;
+  std::vector<std::uint64_t> fUsed;
+  // Zeroed pages from Clear(), to be reused.
+  std::vector<std::unique_ptr<T[]>> fFreePages;
+
+  T *AllocatePage(std::size_t page) {
+    assert(!fPages[page]);
+    if (!fFreePages.empty()) {
+      fPages[page] = std::move(fFreePages.back());
+      fFreePages.pop_back();
+    } else {
+      fPages[page].reset(new T[PageBins]());
+    }
+    fUsed[page / BitmapWordBits] |= std::uint64_t(1)
+                                         << (page % BitmapWordBits);
+    fNumUsedPages++;
+    return fPages[page].get();
+  }
+
+  std::size_t GetPageSize(std::size_t page) const {
+    return std::min(PageBins, fSize - page * PageBins);
+  }
+
+  // Call f(page) for all pages in use, in increasing order.
+  template <typename F> void ForEachUsedPage(F &&f) const {
+    for (std::size_t w = 0; w < fUsed.size(); w++) {
+      // Visit only the set bits, clearing the lowest one in each iteration.
+      for (std::uint64_t word = fUsed[w]; word != 0; word &= word - 1) {
+        f(w * BitmapWordBits + __builtin_ctzll(word));
+      }
+    }
+  }
+
+public:
+  explicit PagedStorage(std::size_t numBins)
+      : fSize(numBins), fPages((numBins + PageBins - 1) / PageBins),
+        fUsed((fPages.size() + BitmapWordBits - 1) / BitmapWordBits) {}
+
+  PagedStorage(const PagedStorage<T> &) = delete;
+  PagedStorage(PagedStorage<T> &&) = default;
+  PagedStorage<T> &operator=(const PagedStorage<T> &) = delete;
+  PagedStorage<T> &operator=(PagedStorage<T> &&) = default;
+
+  std::size_t GetSize() const { return fSize; }
+  std::size_t GetNumPages() const { return fPages.size(); }
+  std::size_t GetNumUsedPages() const { return fNumUsedPages; }
+
+  // Get a bin for writing, allocating its page on first access.
+  T &operator[](std::size_t bin) {
+    assert(bin < fSize);
+    const std::size_t page = bin / PageBins;
+    T *data = fPages[page].get();
+    if (!data) {
+      data = AllocatePage(page);
+    }
+    return data[bin % PageBins];
+  }
+
+  // Find a bin for reading, or return nullptr if its page is not in use.
+  const T *Find(std::size_t bin) const {
+    assert(bin < fSize);
+    const T *data = fPages[bin / PageBins].get();
+    return data ? data + bin % PageBins : nullptr;
+  }
+
+  // Call f(begin, data, n) for all pages in use, where data points to the n
+  // bins starting at bin index begin.
+  template <typename F> void ForEachPage(F &&f) const {
+    ForEachUsedPage([&](std::size_t page) {
+      f(page * PageBins, static_cast<const T *>(fPages[page].get()),
+        GetPageSize(page));
+    });
+  }
+
+  // Add the bins of another storage, only visiting its pages in use.
+  void Add(const PagedStorage<T> &other) {
+    assert(fSize == other.fSize);
+    other.ForEachUsedPage([&](std::size_t page) {
+      T *data = fPages[page].get();
+      if (!data) {
+        data = AllocatePage(page);
+      }
+      AddArray(data, other.fPages[page].get(), GetPageSize(page));
+    });
+  }
+
+  // Reset all bins to zero, but keep the allocated pages for reuse.
+  void Clear() {
+    ForEachUsedPage([&](std::size_t page) {
+      ClearArray(fPages[page].get(), PageBins);
+      fFreePages.push_back(std::move(fPages[page]));
+    });
+    std::fill(fUsed.begin(), fUsed.end(), 0);
+    fNumUsedPages = 0;
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -3,14 +3,113 @@
 #ifndef EPHIST_PARALLELFILLSTRATEGY
 #define EPHIST_PARALLELFILLSTRATEGY
 
+#include <cstddef>
+#include <string>
+
 namespace EPHist {
 
 enum class ParallelFillStrategy {
   Automatic = 0,
   Atomic = 1,
   PerFillContext = 2,
+  // A fixed number of shards owned by the ParallelHelper, each shared by
+  // multiple fill contexts, and reduced in ParallelHelper::Flush().
+  Sharded = 3,
+  // Each fill context keeps a small private cache of the most frequently filled
+  // bins, and fills all other bins atomically.
+  HotBinCache = 4,
+  // Each fill context buffers a fixed number of fills, and commits them with
+  // one atomic instruction per distinct bin when the buffer is full.
+  Buffered = 5,
+};
+
+inline const char *GetParallelFillStrategyName(ParallelFillStrategy strategy) {
+  switch (strategy) {
+  case ParallelFillStrategy::Automatic:
+    return "Automatic";
+  case ParallelFillStrategy::Atomic:
+    return "Atomic";
+  case ParallelFillStrategy::PerFillContext:
+    return "PerFillContext";
+  case ParallelFillStrategy::Sharded:
+    return "Sharded";
+  case ParallelFillStrategy::HotBinCache:
+    return "HotBinCache";
+  case ParallelFillStrategy::Buffered:
+    return "Buffered";
+  }
+  return "unknown";
+}
+
+namespace Internal {
+
+// Heuristics for ParallelFillStrategy::Automatic. Per-context copies avoid
+// atomic instructions, but cost memory and time to allocate and merge. Atomic
+// filling has no such overhead, but is slow if threads often update the same
+// cache lines. The Sharded strategy is used as a hybrid if copies are needed to
+// reduce contention, but only a few of them fit into the memory budget.
+struct AutomaticStrategyDecision {
+  // Histograms up to this size are always copied per context.
+  static constexpr std::size_t MaxSmallHistogramBytes = 256 * 1024;
+  // The maximum memory to spend on copies of a histogram.
+  static constexpr std::size_t MaxCopiesBytes = 512 * 1024 * 1024;
+  // If the probe estimates that a fill conflicts with other threads more often
+  // than this, it is considered contended.
+  static constexpr double MaxConflictProbability = 0.05;
+
+  ParallelFillStrategy fStrategy = ParallelFillStrategy::Automatic;
+  std::size_t fNumShards = 0;
+  std::string fReason;
+
+  // Decide without a probe; fStrategy remains Automatic if a contention probe
+  // is needed.
+  static AutomaticStrategyDecision Decide(std::size_t histogramBytes) {
+    AutomaticStrategyDecision d;
+    const std::string size = std::to_string(histogramBytes) + " bytes";
+    if (histogramBytes <= MaxSmallHistogramBytes) {
+      d.fStrategy = ParallelFillStrategy::PerFillContext;
+      d.fReason = "small histogram (" + size + "), copies are cheap";
+    } else if (histogramBytes > MaxCopiesBytes / 2) {
+      d.fStrategy = ParallelFillStrategy::Atomic;
+      d.fReason = "large histogram (" + size + "), copies are too expensive";
+    } else {
+      d.fReason = "contention probe pending";
+    }
+    return d;
+  }
+
+  // Decide after a contention probe that estimated the probability that two
+  // fills update the same cache line.
+  static AutomaticStrategyDecision Decide(std::size_t histogramBytes,
+                                          std::size_t concurrency,
+                                          double collisionProbability) {
+    AutomaticStrategyDecision d = Decide(histogramBytes);
+    if (d.fStrategy != ParallelFillStrategy::Automatic) {
+      return d;
+    }
+
+    // Each fill may conflict with the fills of all other threads.
+    const std::size_t otherThreads = concurrency > 1 ? concurrency - 1 : 0;
+    const double conflictProbability = collisionProbability * otherThreads;
+    const std::string probe =
+        "estimated conflict probability " + std::to_string(conflictProbability);
+    if (conflictProbability <= MaxConflictProbability) {
+      d.fStrategy = ParallelFillStrategy::Atomic;
+      d.fReason = "low contention (" + probe + ")";
+    } else if (histogramBytes * concurrency <= MaxCopiesBytes) {
+      d.fStrategy = ParallelFillStrategy::PerFillContext;
+      d.fReason = "high contention (" + probe + "), copies fit into memory";
+    } else {
+      d.fStrategy = ParallelFillStrategy::Sharded;
+      d.fNumShards = MaxCopiesBytes / histogramBytes;
+      d.fReason = "high contention (" + probe + "), memory for " +
+                  std::to_string(d.fNumShards) + " shards";
+    }
+    return d;
+  }
 };
 
+} // namespace Internal
 } // namespace EPHist
 
 #endif
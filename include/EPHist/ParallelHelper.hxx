@@ -3,32 +3,148 @@
 #ifndef EPHIST_PARALLELHELPER
 #define EPHIST_PARALLELHELPER
 
+#include "Atomic.hxx"
 #include "EPHist.hxx"
 #include "FillContext.hxx"
 #include "ParallelFillStrategy.hxx"
+#include "Profile.hxx"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace EPHist {
 
 template <typename T> class ParallelHelper final {
+  friend class FillContext<T>;
+
+public:
+  // The number of fill contexts that share one shard by default.
+  static constexpr std::size_t DefaultFillContextsPerShard = 4;
+  // The minimum number of bins to reduce the shards with multiple threads.
+  static constexpr std::size_t MinBinsParallelReduction = 64 * 1024;
+
 private:
   std::shared_ptr<EPHist<T>> fHist;
-  ParallelFillStrategy fStrategy;
+  // For the Automatic strategy, this stays Automatic until the contention
+  // probe of the fill contexts has finished and a strategy was chosen.
+  std::atomic<ParallelFillStrategy> fStrategy;
+  std::string fStrategyReason;
+  std::size_t fConcurrency;
 
-  std::mutex fMutex;
-  std::vector<std::weak_ptr<FillContext<T>>> fFillContexts;
+  mutable std::mutex fMutex;
+
+  // For the Sharded strategy: each shard is aligned to a cache line so that
+  // the histogram objects of different shards do not share one.
+  struct alignas(Internal::CacheLineSize) Shard {
+    EPHist<T> fHist;
+
+    explicit Shard(const std::vector<AxisVariant> &axes) : fHist(axes) {}
+  };
+  std::vector<std::unique_ptr<Shard>> fShards;
+  std::size_t fNextShard = 0;
+
+  // The number of fill contexts handed out and not yet released.
+  std::size_t fNumActiveFillContexts = 0;
+  // Released fill contexts, already flushed and kept for reuse together with
+  // their local buffers. Declared after the histogram and the shards so that
+  // the contexts are destroyed first.
+  std::vector<std::unique_ptr<FillContext<T>>> fFreeFillContexts;
+
+  std::size_t GetDefaultNumShards() const {
+    return std::max<std::size_t>(1, fConcurrency / DefaultFillContextsPerShard);
+  }
+
+  void CreateShards(std::size_t numShards) {
+    if (numShards == 0) {
+      numShards = GetDefaultNumShards();
+    }
+    for (std::size_t i = 0; i < numShards; i++) {
+      fShards.emplace_back(new Shard(fHist->GetAxes()));
+    }
+  }
+
+  // Must be called with fMutex locked.
+  EPHist<T> *GetNextShard() {
+    // Assign the shards in a round-robin fashion.
+    EPHist<T> *shard = &fShards[fNextShard]->fHist;
+    fNextShard = (fNextShard + 1) % fShards.size();
+    return shard;
+  }
+
+  std::size_t GetHistogramBytes() const {
+    return fHist->GetTotalNumBins() * sizeof(T);
+  }
+
+  // Called by the fill contexts when their contention probe has finished,
+  // reporting how many pairs of fills were compared and how many of them
+  // updated the same cache line. Only the first call decides the strategy.
+  void FinishProbe(std::size_t comparisons, std::size_t collisions) {
+    std::lock_guard g(fMutex);
+    if (fStrategy != ParallelFillStrategy::Automatic) {
+      return;
+    }
+    const double collisionProbability =
+        static_cast<double>(collisions) / static_cast<double>(comparisons);
+    auto decision = Internal::AutomaticStrategyDecision::Decide(
+        GetHistogramBytes(), fConcurrency, collisionProbability);
+    assert(decision.fStrategy != ParallelFillStrategy::Automatic);
+    if (decision.fStrategy == ParallelFillStrategy::Sharded) {
+      CreateShards(decision.fNumShards);
+    }
+    fStrategyReason = std::move(decision.fReason);
+    fStrategy = decision.fStrategy;
+  }
+
+  EPHist<T> *AssignShard() {
+    std::lock_guard g(fMutex);
+    return GetNextShard();
+  }
+
+  // Called when the last reference to a fill context is dropped: flush its
+  // fills and put it into the pool.
+  void ReleaseFillContext(FillContext<T> *context) {
+    std::unique_ptr<FillContext<T>> owned(context);
+    // Flush without holding the lock, so that multiple contexts can add their
+    // fills concurrently.
+    owned->Flush();
+
+    std::lock_guard g(fMutex);
+    assert(fNumActiveFillContexts > 0);
+    fNumActiveFillContexts--;
+    // Does not allocate, the capacity was reserved in CreateFillContext.
+    assert(fFreeFillContexts.size() < fFreeFillContexts.capacity());
+    fFreeFillContexts.push_back(std::move(owned));
+  }
 
 public:
+  // numShards is only used for the Sharded strategy; zero selects a default
+  // based on the number of hardware threads.
   explicit ParallelHelper(
       std::shared_ptr<EPHist<T>> hist,
-      ParallelFillStrategy strategy = ParallelFillStrategy::Automatic)
-      : fHist(std::move(hist)), fStrategy(strategy) {
-    if (fStrategy == ParallelFillStrategy::Automatic) {
-      // Default to atomic filling for the moment...
-      fStrategy = ParallelFillStrategy::Atomic;
+      ParallelFillStrategy strategy = ParallelFillStrategy::Automatic,
+      std::size_t numShards = 0)
+      : fHist(std::move(hist)), fStrategy(strategy),
+        fConcurrency(std::thread::hardware_concurrency()) {
+    if (strategy == ParallelFillStrategy::Automatic) {
+      // Decide based on the size of the histogram, or start a contention probe
+      // during the first fills.
+      auto decision =
+          Internal::AutomaticStrategyDecision::Decide(GetHistogramBytes());
+      fStrategy = decision.fStrategy;
+      fStrategyReason = std::move(decision.fReason);
+    } else {
+      fStrategyReason = "requested by the user";
+    }
+    if (strategy == ParallelFillStrategy::Sharded) {
+      CreateShards(numShards);
     }
   }
   ParallelHelper(const ParallelHelper<T> &) = delete;
@@ -36,29 +152,200 @@ public:
   ParallelHelper<T> &operator=(const ParallelHelper<T> &) = delete;
   ParallelHelper<T> &operator=(ParallelHelper<T> &&) = delete;
   ~ParallelHelper() {
-    for (const auto &context : fFillContexts) {
-      assert(context.expired());
-    }
+    assert(fNumActiveFillContexts == 0);
     Flush();
   }
 
+  std::size_t GetNumShards() const {
+    std::lock_guard g(fMutex);
+    return fShards.size();
+  }
+
+  // Get the strategy used by the fill contexts, and the reason why it was
+  // chosen. For the Automatic strategy, the result may be Automatic while the
+  // contention probe is running.
+  ParallelFillStrategy GetStrategy() const { return fStrategy; }
+  std::string GetStrategyReason() const {
+    std::lock_guard g(fMutex);
+    return fStrategyReason;
+  }
+
+  // Merge the shards into the histogram. This must not be called concurrently
+  // with filling.
   void Flush() {
-    // Nothing to do for now...
+    if (fShards.empty()) {
+      return;
+    }
+
+    // Sum all shards in one pass over memory, with multiple threads for large
+    // histograms.
+    const bool parallel = fHist->GetTotalNumBins() >= MinBinsParallelReduction;
+    const std::size_t numThreads = parallel ? fConcurrency : 1;
+    auto &shard = fShards[0]->fHist;
+    std::vector<const EPHist<T> *> others;
+    for (std::size_t i = 1; i < fShards.size(); i++) {
+      others.push_back(&fShards[i]->fHist);
+    }
+    shard.Merge(others, numThreads);
+
+    // The histogram may be filled by other means, so add atomically.
+    fHist->AddAtomic(shard, numThreads);
+    for (auto &s : fShards) {
+      s->fHist.Clear(numThreads);
+    }
   }
 
+  // Create a fill context, or reuse one that was released before. When the
+  // last reference is dropped, the context is flushed and returned to a pool,
+  // keeping its local buffers: task-based schedulers can create a context per
+  // task without allocating and zeroing a local histogram every time. Fill
+  // contexts must not outlive the ParallelHelper.
   std::shared_ptr<FillContext<T>> CreateFillContext() {
+    std::unique_ptr<FillContext<T>> context;
+    ParallelFillStrategy strategy{};
+    EPHist<T> *hist = fHist.get();
+    {
+      std::lock_guard g(fMutex);
+      if (!fFreeFillContexts.empty()) {
+        context = std::move(fFreeFillContexts.back());
+        fFreeFillContexts.pop_back();
+      } else {
+        strategy = fStrategy;
+        if (strategy == ParallelFillStrategy::Sharded) {
+          hist = GetNextShard();
+        }
+      }
+    }
+
+    if (!context) {
+      // Allocate the context and its local buffers without holding the lock.
+      // Cannot use std::make_unique because the constructor of FillContext is
+      // private.
+      context.reset(new FillContext<T>(*hist, strategy, this));
+    }
+
+    {
+      std::lock_guard g(fMutex);
+      // Reserve space in the pool for all contexts, so that releasing one
+      // does not need to allocate.
+      fFreeFillContexts.reserve(fNumActiveFillContexts + 1 +
+                                fFreeFillContexts.size());
+      fNumActiveFillContexts++;
+    }
+    return std::shared_ptr<FillContext<T>>(
+        context.release(),
+        [this](FillContext<T> *c) { ReleaseFillContext(c); });
+  }
+};
+
+template <bool WithError> class ParallelHelper<Profile<WithError>> final {
+  using Context = FillContext<Profile<WithError>>;
+
+  std::shared_ptr<Profile<WithError>> fProfile;
+  ParallelFillStrategy fStrategy;
+  std::string fStrategyReason;
+
+  std::mutex fMutex;
+  // The number of fill contexts handed out and not yet released, and the
+  // released contexts kept for reuse, as for histograms.
+  std::size_t fNumActiveFillContexts = 0;
+  std::vector<std::unique_ptr<Context>> fFreeFillContexts;
+
+  using BinType = typename Profile<WithError>::BinContentType;
+
+  void ReleaseFillContext(Context *context) {
+    std::unique_ptr<Context> owned(context);
+    owned->Flush();
+
     std::lock_guard g(fMutex);
+    assert(fNumActiveFillContexts > 0);
+    fNumActiveFillContexts--;
+    assert(fFreeFillContexts.size() < fFreeFillContexts.capacity());
+    fFreeFillContexts.push_back(std::move(owned));
+  }
+
+public:
+  // The Automatic strategy decides based on the size of the profile alone:
+  // copies are used if they fit into the memory budget, because the atomic
+  // update of a profile bin is multiple atomic instructions.
+  explicit ParallelHelper(
+      std::shared_ptr<Profile<WithError>> profile,
+      ParallelFillStrategy strategy = ParallelFillStrategy::Automatic)
+      : fProfile(std::move(profile)), fStrategy(strategy) {
+    using Decision = Internal::AutomaticStrategyDecision;
+    switch (strategy) {
+    case ParallelFillStrategy::Automatic: {
+      const std::size_t bytes = fProfile->GetTotalNumBins() * sizeof(BinType);
+      const std::size_t concurrency = std::thread::hardware_concurrency();
+      const std::string size = std::to_string(bytes) + " bytes";
+      if (bytes <= Decision::MaxSmallHistogramBytes) {
+        fStrategy = ParallelFillStrategy::PerFillContext;
+        fStrategyReason = "small profile (" + size + "), copies are cheap";
+      } else if (bytes * concurrency <= Decision::MaxCopiesBytes) {
+        fStrategy = ParallelFillStrategy::PerFillContext;
+        fStrategyReason = "profile (" + size + "), copies fit into memory";
+      } else {
+        fStrategy = ParallelFillStrategy::Atomic;
+        fStrategyReason =
+            "large profile (" + size + "), copies are too expensive";
+      }
+      break;
+    }
+    case ParallelFillStrategy::Atomic:
+    case ParallelFillStrategy::PerFillContext:
+      fStrategyReason = "requested by the user";
+      break;
+    default:
+      throw std::invalid_argument("strategy not supported for Profile");
+    }
+  }
+  ParallelHelper(const ParallelHelper &) = delete;
+  ParallelHelper(ParallelHelper &&) = delete;
+  ParallelHelper &operator=(const ParallelHelper &) = delete;
+  ParallelHelper &operator=(ParallelHelper &&) = delete;
+  ~ParallelHelper() { assert(fNumActiveFillContexts == 0); }
+
+  ParallelFillStrategy GetStrategy() const { return fStrategy; }
+  std::string GetStrategyReason() const { return fStrategyReason; }
+
+  // There is no state to merge, this exists for symmetry with histograms.
+  void Flush() {}
+
+  // Create a fill context, or reuse one that was released before, see the
+  // ParallelHelper for histograms. Fill contexts must not outlive the
+  // ParallelHelper.
+  std::shared_ptr<Context> CreateFillContext() {
+    std::unique_ptr<Context> context;
+    {
+      std::lock_guard g(fMutex);
+      if (!fFreeFillContexts.empty()) {
+        context = std::move(fFreeFillContexts.back());
+        fFreeFillContexts.pop_back();
+      }
+    }
 
-    // Cannot use std::make_shared because the constructor of FillContext is
-    // private. Also it would mean that the (direct) memory of all contexts
-    // stays around until the vector of weak_ptr's is cleared.
-    std::shared_ptr<FillContext<T>> context(
-        new FillContext<T>(*fHist, fStrategy));
-    fFillContexts.push_back(context);
-    return context;
+    if (!context) {
+      // Cannot use std::make_unique because the constructor of FillContext is
+      // private.
+      context.reset(new Context(*fProfile, fStrategy));
+    }
+
+    {
+      std::lock_guard g(fMutex);
+      fFreeFillContexts.reserve(fNumActiveFillContexts + 1 +
+                                fFreeFillContexts.size());
+      fNumActiveFillContexts++;
+    }
+    return std::shared_ptr<Context>(
+        context.release(), [this](Context *c) { ReleaseFillContext(c); });
   }
 };
 
+template <bool WithError>
+ParallelHelper(std::shared_ptr<Profile<WithError>>,
+               ParallelFillStrategy = ParallelFillStrategy::Automatic)
+    -> ParallelHelper<Profile<WithError>>;
+
 } // namespace EPHist
 
 #endif
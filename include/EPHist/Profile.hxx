@@ -3,16 +3,29 @@
 #ifndef EPHIST_PROFILE
 #define EPHIST_PROFILE
 
+#include "Atomic.hxx"
 #include "Axes.hxx"
 #include "TypeTraits.hxx"
 #include "Weight.hxx"
 
+#include <array>
+#include <mutex>
 #include <utility>
 #include <vector>
 
 namespace EPHist {
 
+template <typename T> class FillContext;
+template <bool WithError> class SoAProfile;
+namespace Util {
+template <typename H> class BinaryIO;
+}
+
 template <bool WithError = true> class Profile final {
+  friend class FillContext<Profile<WithError>>;
+  friend class SoAProfile<WithError>;
+  friend class Util::BinaryIO<Profile<WithError>>;
+
 public:
   struct DoubleBin {
     double fSumValues = 0;
@@ -23,6 +36,12 @@ public:
     // simplifies the implementation because weighted Fills are always allowed.
     double fSum = 0;
 
+    // The members for the column-wise storage of SoAProfile.
+    static constexpr std::array<double DoubleBin::*, 3> GetColumns() {
+      return {&DoubleBin::fSumValues, &DoubleBin::fSumValues2,
+              &DoubleBin::fSum};
+    }
+
     DoubleBin &operator+=(const DoubleBin &rhs) {
       fSumValues += rhs.fSumValues;
       fSumValues2 += rhs.fSumValues2;
@@ -41,6 +60,24 @@ public:
       fSumValues2 += w * v * v;
       fSum += w;
     }
+
+    // See Atomic.hxx for the atomic backends.
+    void AtomicAdd(const DoubleBin &rhs) {
+#ifdef EPHIST_ATOMIC_STRIPED_LOCK
+      std::lock_guard g(Internal::GetStripedLock(this));
+      operator+=(rhs);
+#else
+      Internal::AtomicAdd(&fSumValues, rhs.fSumValues);
+      Internal::AtomicAdd(&fSumValues2, rhs.fSumValues2);
+      Internal::AtomicAdd(&fSum, rhs.fSum);
+#endif
+    }
+
+    void AtomicAdd(double v) { AtomicAdd(DoubleBin{v, v * v, 1}); }
+
+    void AtomicAdd(double v, double w) {
+      AtomicAdd(DoubleBin{w * v, w * v * v, w});
+    }
   };
 
   struct DoubleBinWithError {
@@ -49,6 +86,12 @@ public:
     double fSum = 0;
     double fSum2 = 0;
 
+    static constexpr std::array<double DoubleBinWithError::*, 4> GetColumns() {
+      return {&DoubleBinWithError::fSumValues,
+              &DoubleBinWithError::fSumValues2, &DoubleBinWithError::fSum,
+              &DoubleBinWithError::fSum2};
+    }
+
     DoubleBinWithError &operator+=(const DoubleBinWithError &rhs) {
       fSumValues += rhs.fSumValues;
       fSumValues2 += rhs.fSumValues2;
@@ -70,6 +113,25 @@ public:
       fSum += w;
       fSum2 += w * w;
     }
+
+    // See Atomic.hxx for the atomic backends.
+    void AtomicAdd(const DoubleBinWithError &rhs) {
+#ifdef EPHIST_ATOMIC_STRIPED_LOCK
+      std::lock_guard g(Internal::GetStripedLock(this));
+      operator+=(rhs);
+#else
+      Internal::AtomicAdd(&fSumValues, rhs.fSumValues);
+      Internal::AtomicAdd(&fSumValues2, rhs.fSumValues2);
+      Internal::AtomicAdd(&fSum, rhs.fSum);
+      Internal::AtomicAdd(&fSum2, rhs.fSum2);
+#endif
+    }
+
+    void AtomicAdd(double v) { AtomicAdd(DoubleBinWithError{v, v * v, 1, 1}); }
+
+    void AtomicAdd(double v, double w) {
+      AtomicAdd(DoubleBinWithError{w * v, w * v * v, w, w * w});
+    }
   };
 
   using BinContentType =
@@ -102,6 +164,15 @@ public:
     }
   }
 
+  void AddAtomic(const Profile<WithError> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    for (std::size_t i = 0; i < fData.size(); i++) {
+      fData[i].AtomicAdd(other.fData[i]);
+    }
+  }
+
   void Clear() {
     for (std::size_t i = 0; i < fData.size(); i++) {
       fData[i] = {};
@@ -221,6 +292,83 @@ public:
     }
     FillImpl<sizeof...(A)>(args, v, w);
   }
+
+private:
+  template <std::size_t N, typename... A>
+  void FillAtomicImpl(const std::tuple<A...> &args, double v) {
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      fData[bin.first].AtomicAdd(v);
+    }
+  }
+
+  template <std::size_t N, typename... A>
+  void FillAtomicImpl(const std::tuple<A...> &args, double v, Weight w) {
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      fData[bin.first].AtomicAdd(v, w.fValue);
+    }
+  }
+
+public:
+  template <typename... A> void FillAtomic(const std::tuple<A...> &args) {
+    if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillAtomicImpl<sizeof...(A) - 1>(args, std::get<sizeof...(A) - 1>(args));
+  }
+
+  // We have to accept v with a template type V to capture any argument,
+  // otherwise Fill(std::tuple<int>, int) would select the variadic function
+  // template...
+  template <typename... A, typename V>
+  void FillAtomic(const std::tuple<A...> &args, const V &v) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillAtomicImpl<sizeof...(A)>(args, v);
+  }
+
+  template <typename... A> void FillAtomic(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    // Could use std::tuple_element_t<sizeof...(A) - 1, decltype(t)>, but that
+    // would be const Weight &
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      if (sizeof...(A) - 2 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillAtomicImpl<sizeof...(A) - 2>(t, std::get<sizeof...(A) - 2>(t),
+                                       std::get<sizeof...(A) - 1>(t));
+    } else {
+      if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillAtomic(t);
+    }
+  }
+
+  template <typename... A>
+  void FillAtomic(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillAtomicImpl<sizeof...(A) - 1>(args, std::get<sizeof...(A) - 1>(args),
+                                     w);
+  }
+
+  // We have to accept v with a template type V to capture any argument,
+  // otherwise Fill(std::tuple<int>, int) would select the variadic function
+  // template...
+  template <typename... A, typename V>
+  void FillAtomic(const std::tuple<A...> &args, const V &v, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillAtomicImpl<sizeof...(A)>(args, v, w);
+  }
 };
 
 } // namespace EPHist
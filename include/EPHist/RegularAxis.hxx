@@ -5,6 +5,7 @@
 
 #include "BinIndex.hxx"
 #include "BinIndexRange.hxx"
+#include "SIMD.hxx"
 
 #include <cassert>
 #include <cstddef>
@@ -76,6 +77,27 @@ public:
     return {bin, true};
   }
 
+  // Compute the bins for n arguments at once; arguments outside of the axis
+  // (and without enabled flow bins) are marked with Internal::InvalidBin.
+  template <typename A>
+  void ComputeBins(const A *x, std::size_t n, std::size_t *bins) const {
+    for (std::size_t i = 0; i < n; i++) {
+      auto bin = ComputeBin(x[i]);
+      bins[i] = bin.second ? bin.first : Internal::InvalidBin;
+    }
+  }
+
+  // Specialized version for arrays of doubles using vectorized kernels.
+  void ComputeBins(const double *x, std::size_t n, std::size_t *bins) const {
+    Internal::RegularAxisParameters p;
+    p.fLow = fLow;
+    p.fHigh = fHigh;
+    p.fInvBinWidth = fInvBinWidth;
+    p.fUnderflowBin = fEnableFlowBins ? fNumBins : Internal::InvalidBin;
+    p.fOverflowBin = fEnableFlowBins ? fNumBins + 1 : Internal::InvalidBin;
+    Internal::ComputeBinsRegular(p, fNumBins, x, n, bins);
+  }
+
   RegularAxis Slice(const BinIndexRange &range) const {
     const auto normalRange = range.GetNormalRange(fNumBins);
 
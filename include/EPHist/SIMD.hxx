@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_SIMD
+#define EPHIST_SIMD
+
+#include "BinIndex.hxx"
+
+#include <cstddef>
+
+// The vectorized kernels are compiled for specific targets with function
+// attributes and selected at runtime, so they do not require compiling the
+// entire application with -mavx2 or -mavx512f. Define EPHIST_DISABLE_SIMD to
+// always use the scalar versions.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) &&        \
+    !defined(EPHIST_DISABLE_SIMD)
+#define EPHIST_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace EPHist {
+namespace Internal {
+
+enum class SIMDLevel {
+  Scalar = 0,
+  AVX2 = 1,
+  AVX512 = 2,
+};
+
+inline SIMDLevel DetectSIMDLevel() {
+#ifdef EPHIST_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+    return SIMDLevel::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SIMDLevel::AVX2;
+  }
+#endif
+  return SIMDLevel::Scalar;
+}
+
+inline SIMDLevel GetSIMDLevel() {
+  static const SIMDLevel level = DetectSIMDLevel();
+  return level;
+}
+
+// Parameters of a RegularAxis for the batched bin computation. The underflow
+// and overflow bins are Internal::InvalidBin if flow bins are disabled.
+struct RegularAxisParameters {
+  double fLow;
+  double fHigh;
+  double fInvBinWidth;
+  std::size_t fUnderflowBin;
+  std::size_t fOverflowBin;
+};
+
+// The kernels must give the same results as RegularAxis::ComputeBin, in
+// particular NaNs go into the overflow bin.
+inline void ComputeBinsRegularScalar(const RegularAxisParameters &p,
+                                     const double *x, std::size_t n,
+                                     std::size_t *bins) {
+  for (std::size_t i = 0; i < n; i++) {
+    const double v = x[i];
+    if (v < p.fLow) {
+      bins[i] = p.fUnderflowBin;
+    } else if (!(v < p.fHigh)) {
+      bins[i] = p.fOverflowBin;
+    } else {
+      bins[i] = static_cast<std::size_t>((v - p.fLow) * p.fInvBinWidth);
+    }
+  }
+}
+
+#ifdef EPHIST_SIMD_X86
+// The conversion to integers only handles 32 bit, so this kernel must only be
+// used for axes with less than 2^31 bins.
+__attribute__((target("avx2"))) inline void
+ComputeBinsRegularAVX2(const RegularAxisParameters &p, const double *x,
+                       std::size_t n, std::size_t *bins) {
+  const __m256d low = _mm256_set1_pd(p.fLow);
+  const __m256d high = _mm256_set1_pd(p.fHigh);
+  const __m256d invBinWidth = _mm256_set1_pd(p.fInvBinWidth);
+  const __m256i underflowBin = _mm256_set1_epi64x(p.fUnderflowBin);
+  const __m256i overflowBin = _mm256_set1_epi64x(p.fOverflowBin);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d v = _mm256_loadu_pd(x + i);
+    const __m256d underflow = _mm256_cmp_pd(v, low, _CMP_LT_OQ);
+    // The unordered comparison is true for NaNs.
+    const __m256d overflow = _mm256_cmp_pd(v, high, _CMP_NLT_UQ);
+    const __m256d pos = _mm256_mul_pd(_mm256_sub_pd(v, low), invBinWidth);
+    __m256i bin = _mm256_cvtepi32_epi64(_mm256_cvttpd_epi32(pos));
+    bin = _mm256_blendv_epi8(bin, overflowBin, _mm256_castpd_si256(overflow));
+    bin = _mm256_blendv_epi8(bin, underflowBin, _mm256_castpd_si256(underflow));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(bins + i), bin);
+  }
+  ComputeBinsRegularScalar(p, x + i, n - i, bins + i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+ComputeBinsRegularAVX512(const RegularAxisParameters &p, const double *x,
+                         std::size_t n, std::size_t *bins) {
+  const __m512d low = _mm512_set1_pd(p.fLow);
+  const __m512d high = _mm512_set1_pd(p.fHigh);
+  const __m512d invBinWidth = _mm512_set1_pd(p.fInvBinWidth);
+  const __m512i underflowBin = _mm512_set1_epi64(p.fUnderflowBin);
+  const __m512i overflowBin = _mm512_set1_epi64(p.fOverflowBin);
+
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512d v = _mm512_loadu_pd(x + i);
+    const __mmask8 underflow = _mm512_cmp_pd_mask(v, low, _CMP_LT_OQ);
+    // The unordered comparison is true for NaNs.
+    const __mmask8 overflow = _mm512_cmp_pd_mask(v, high, _CMP_NLT_UQ);
+    const __m512d pos = _mm512_mul_pd(_mm512_sub_pd(v, low), invBinWidth);
+    __m512i bin = _mm512_cvttpd_epu64(pos);
+    bin = _mm512_mask_blend_epi64(overflow, bin, overflowBin);
+    bin = _mm512_mask_blend_epi64(underflow, bin, underflowBin);
+    _mm512_storeu_si512(bins + i, bin);
+  }
+  ComputeBinsRegularScalar(p, x + i, n - i, bins + i);
+}
+#endif
+
+inline void ComputeBinsRegular(const RegularAxisParameters &p,
+                               std::size_t numBins, const double *x,
+                               std::size_t n, std::size_t *bins) {
+#ifdef EPHIST_SIMD_X86
+  switch (GetSIMDLevel()) {
+  case SIMDLevel::AVX512:
+    ComputeBinsRegularAVX512(p, x, n, bins);
+    return;
+  case SIMDLevel::AVX2:
+    if (numBins < (std::size_t(1) << 31)) {
+      ComputeBinsRegularAVX2(p, x, n, bins);
+      return;
+    }
+    break;
+  case SIMDLevel::Scalar:
+    break;
+  }
+#endif
+  ComputeBinsRegularScalar(p, x, n, bins);
+}
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_SOAHIST
+#define EPHIST_SOAHIST
+
+#include "Axes.hxx"
+#include "BinIndex.hxx"
+#include "BinIndexRange.hxx"
+#include "ColumnStorage.hxx"
+#include "EPHist.hxx"
+#include "TypeTraits.hxx"
+#include "Weight.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+// A histogram with the same interface as EPHist<T>, but storing bins with
+// multiple moments (such as DoubleBinWithError) as a structure of arrays, see
+// Internal::ColumnStorage. Bin contents are returned by value, and each moment
+// of all bins is accessible as a contiguous array with GetColumn().
+template <typename T> class SoAHist final {
+public:
+  using BinContentType = T;
+  static constexpr std::size_t NumColumns =
+      Internal::ColumnStorage<T>::NumColumns;
+
+private:
+  // The axes are declared first to compute the number of bins.
+  Detail::Axes fAxes;
+
+  Internal::ColumnStorage<T> fData;
+
+public:
+  explicit SoAHist(std::vector<AxisVariant> axes)
+      : fAxes(std::move(axes)), fData(fAxes.ComputeTotalNumBins()) {}
+
+  SoAHist(std::size_t numBins, double low, double high)
+      : SoAHist({RegularAxis(numBins, low, high)}) {}
+  explicit SoAHist(const RegularAxis &axis)
+      : SoAHist(std::vector<AxisVariant>{axis}) {}
+  explicit SoAHist(const VariableBinAxis &axis)
+      : SoAHist(std::vector<AxisVariant>{axis}) {}
+  explicit SoAHist(const CategoricalAxis &axis)
+      : SoAHist(std::vector<AxisVariant>{axis}) {}
+  explicit SoAHist(const IntCategoricalAxis &axis)
+      : SoAHist(std::vector<AxisVariant>{axis}) {}
+
+  // Convert from and to the array of structures layout.
+  explicit SoAHist(const EPHist<T> &h) : SoAHist(h.GetAxes()) {
+    for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+      fData.Add(i, h.GetBinContent(i));
+    }
+  }
+  EPHist<T> ToEPHist() const {
+    EPHist<T> h(fAxes.GetVector());
+    for (std::size_t i = 0; i < fData.GetSize(); i++) {
+      h.fData[i] = fData.Get(i);
+    }
+    return h;
+  }
+
+  // Copy constructor and assignment operator are deleted to avoid surprises.
+  // Use the explicit Clone() function to create a copy.
+  SoAHist(const SoAHist<T> &) = delete;
+  SoAHist(SoAHist<T> &&) = default;
+  SoAHist<T> &operator=(const SoAHist<T> &) = delete;
+  SoAHist<T> &operator=(SoAHist<T> &&) = default;
+  ~SoAHist() = default;
+
+  void Add(const SoAHist<T> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.Add(other.fData);
+  }
+
+  void AddAtomic(const SoAHist<T> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.AddAtomic(other.fData);
+  }
+
+  void Clear() { fData.Clear(); }
+
+  SoAHist<T> Clone() const {
+    SoAHist<T> h(fAxes.GetVector());
+    h.fData = fData;
+    return h;
+  }
+
+  T GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < fData.GetSize());
+    return fData.Get(bin);
+  }
+  template <std::size_t N>
+  T GetBinContentAt(const std::array<BinIndex, N> &args) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return fData.Get(bin.first);
+  }
+  template <typename... A> T GetBinContentAt(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    std::array<BinIndex, sizeof...(A)> a{args...};
+    return GetBinContentAt(a);
+  }
+  std::size_t GetTotalNumBins() const { return fData.GetSize(); }
+
+  // Get one moment of all bins, in the order of T::GetColumns().
+  const std::vector<double> &GetColumn(std::size_t column) const {
+    if (column >= NumColumns) {
+      throw std::invalid_argument("column out of range");
+    }
+    return fData.GetColumn(column);
+  }
+
+  const std::vector<AxisVariant> &GetAxes() const { return fAxes.GetVector(); }
+  std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
+
+private:
+  template <bool Atomic, std::size_t N, typename... A>
+  void FillImpl(const std::tuple<A...> &args, const T &entry) {
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      if constexpr (Atomic) {
+        fData.AddAtomic(bin.first, entry);
+      } else {
+        fData.Add(bin.first, entry);
+      }
+    }
+  }
+
+  template <bool Atomic, typename... A> void FillVariadic(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    // Could use std::tuple_element_t<sizeof...(A) - 1, decltype(t)>, but that
+    // would be const Weight &
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      T entry;
+      entry += std::get<sizeof...(A) - 1>(t).fValue;
+      FillImpl<Atomic, sizeof...(A) - 1>(t, entry);
+    } else {
+      if (sizeof...(A) != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      T entry;
+      ++entry;
+      FillImpl<Atomic, sizeof...(A)>(t, entry);
+    }
+  }
+
+public:
+  template <typename... A> void Fill(const std::tuple<A...> &args) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    T entry;
+    ++entry;
+    FillImpl</*Atomic=*/false, sizeof...(A)>(args, entry);
+  }
+
+  template <typename... A> void Fill(const A &...args) {
+    FillVariadic</*Atomic=*/false>(args...);
+  }
+
+  template <typename... A> void Fill(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    T entry;
+    entry += w.fValue;
+    FillImpl</*Atomic=*/false, sizeof...(A)>(args, entry);
+  }
+
+  template <typename... A> void FillAtomic(const std::tuple<A...> &args) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    T entry;
+    ++entry;
+    FillImpl</*Atomic=*/true, sizeof...(A)>(args, entry);
+  }
+
+  template <typename... A> void FillAtomic(const A &...args) {
+    FillVariadic</*Atomic=*/true>(args...);
+  }
+
+  template <typename... A>
+  void FillAtomic(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    T entry;
+    entry += w.fValue;
+    FillImpl</*Atomic=*/true, sizeof...(A)>(args, entry);
+  }
+
+  template <std::size_t N>
+  SoAHist<T> Slice(const std::array<BinIndexRange, N> &ranges) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+
+    SoAHist<T> slice(fAxes.Slice(ranges));
+    const auto map = fAxes.ComputeSliceBinMap(ranges, slice.fAxes);
+    slice.fData.AddSlice(fData, map);
+    return slice;
+  }
+
+  template <typename... A> SoAHist<T> Slice(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+    std::array<BinIndexRange, sizeof...(A)> ranges{args...};
+    return Slice(ranges);
+  }
+};
+
+} // namespace EPHist
+
+#endif
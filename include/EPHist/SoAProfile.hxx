@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_SOAPROFILE
+#define EPHIST_SOAPROFILE
+
+#include "Axes.hxx"
+#include "BinIndex.hxx"
+#include "BinIndexRange.hxx"
+#include "ColumnStorage.hxx"
+#include "Profile.hxx"
+#include "TypeTraits.hxx"
+#include "Weight.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+// A profile with the same interface as Profile<WithError>, but storing the
+// sums of all bins as a structure of arrays, see Internal::ColumnStorage. Bin
+// contents are returned by value, and each sum of all bins is accessible as a
+// contiguous array with GetColumn().
+template <bool WithError = true> class SoAProfile final {
+public:
+  using BinContentType = typename Profile<WithError>::BinContentType;
+  static constexpr std::size_t NumColumns =
+      Internal::ColumnStorage<BinContentType>::NumColumns;
+
+private:
+  // The axes are declared first to compute the number of bins.
+  Detail::Axes fAxes;
+
+  Internal::ColumnStorage<BinContentType> fData;
+
+  static BinContentType MakeEntry(double v) {
+    BinContentType entry;
+    entry.Add(v);
+    return entry;
+  }
+
+  static BinContentType MakeEntry(double v, Weight w) {
+    BinContentType entry;
+    entry.Add(v, w.fValue);
+    return entry;
+  }
+
+public:
+  explicit SoAProfile(std::vector<AxisVariant> axes)
+      : fAxes(std::move(axes)), fData(fAxes.ComputeTotalNumBins()) {}
+
+  // Convert from and to the array of structures layout.
+  explicit SoAProfile(const Profile<WithError> &p) : SoAProfile(p.GetAxes()) {
+    for (std::size_t i = 0; i < p.GetTotalNumBins(); i++) {
+      fData.Add(i, p.GetBinContent(i));
+    }
+  }
+  Profile<WithError> ToProfile() const {
+    Profile<WithError> p(fAxes.GetVector());
+    for (std::size_t i = 0; i < fData.GetSize(); i++) {
+      p.fData[i] = fData.Get(i);
+    }
+    return p;
+  }
+
+  // Copy constructor and assignment operator are deleted to avoid surprises.
+  // Use the explicit Clone() function to create a copy.
+  SoAProfile(const SoAProfile<WithError> &) = delete;
+  SoAProfile(SoAProfile<WithError> &&) = default;
+  SoAProfile<WithError> &operator=(const SoAProfile<WithError> &) = delete;
+  SoAProfile<WithError> &operator=(SoAProfile<WithError> &&) = default;
+  ~SoAProfile() = default;
+
+  void Add(const SoAProfile<WithError> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.Add(other.fData);
+  }
+
+  void AddAtomic(const SoAProfile<WithError> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    fData.AddAtomic(other.fData);
+  }
+
+  void Clear() { fData.Clear(); }
+
+  SoAProfile<WithError> Clone() const {
+    SoAProfile<WithError> p(fAxes.GetVector());
+    p.fData = fData;
+    return p;
+  }
+
+  BinContentType GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < fData.GetSize());
+    return fData.Get(bin);
+  }
+  template <std::size_t N>
+  BinContentType GetBinContentAt(const std::array<BinIndex, N> &args) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return fData.Get(bin.first);
+  }
+  template <typename... A>
+  BinContentType GetBinContentAt(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    std::array<BinIndex, sizeof...(A)> a{args...};
+    return GetBinContentAt(a);
+  }
+  std::size_t GetTotalNumBins() const { return fData.GetSize(); }
+
+  // Get one sum of all bins, in the order of BinContentType::GetColumns().
+  const std::vector<double> &GetColumn(std::size_t column) const {
+    if (column >= NumColumns) {
+      throw std::invalid_argument("column out of range");
+    }
+    return fData.GetColumn(column);
+  }
+
+  const std::vector<AxisVariant> &GetAxes() const { return fAxes.GetVector(); }
+  std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
+
+private:
+  template <bool Atomic, std::size_t N, typename... A>
+  void FillImpl(const std::tuple<A...> &args, const BinContentType &entry) {
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      if constexpr (Atomic) {
+        fData.AddAtomic(bin.first, entry);
+      } else {
+        fData.Add(bin.first, entry);
+      }
+    }
+  }
+
+  template <bool Atomic, typename... A>
+  void FillTuple(const std::tuple<A...> &args) {
+    if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl<Atomic, sizeof...(A) - 1>(
+        args, MakeEntry(std::get<sizeof...(A) - 1>(args)));
+  }
+
+  template <bool Atomic, typename... A>
+  void FillTuple(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl<Atomic, sizeof...(A) - 1>(
+        args, MakeEntry(std::get<sizeof...(A) - 1>(args), w));
+  }
+
+  template <bool Atomic, typename... A> void FillVariadic(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    // Could use std::tuple_element_t<sizeof...(A) - 1, decltype(t)>, but that
+    // would be const Weight &
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      if (sizeof...(A) - 2 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillImpl<Atomic, sizeof...(A) - 2>(
+          t, MakeEntry(std::get<sizeof...(A) - 2>(t),
+                       std::get<sizeof...(A) - 1>(t)));
+    } else {
+      FillTuple<Atomic>(t);
+    }
+  }
+
+public:
+  template <typename... A> void Fill(const std::tuple<A...> &args) {
+    FillTuple</*Atomic=*/false>(args);
+  }
+
+  // We have to accept v with a template type V to capture any argument,
+  // otherwise Fill(std::tuple<int>, int) would select the variadic function
+  // template...
+  template <typename... A, typename V>
+  void Fill(const std::tuple<A...> &args, const V &v) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/false, sizeof...(A)>(args, MakeEntry(v));
+  }
+
+  template <typename... A> void Fill(const A &...args) {
+    FillVariadic</*Atomic=*/false>(args...);
+  }
+
+  template <typename... A> void Fill(const std::tuple<A...> &args, Weight w) {
+    FillTuple</*Atomic=*/false>(args, w);
+  }
+
+  template <typename... A, typename V>
+  void Fill(const std::tuple<A...> &args, const V &v, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/false, sizeof...(A)>(args, MakeEntry(v, w));
+  }
+
+  template <typename... A> void FillAtomic(const std::tuple<A...> &args) {
+    FillTuple</*Atomic=*/true>(args);
+  }
+
+  template <typename... A, typename V>
+  void FillAtomic(const std::tuple<A...> &args, const V &v) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/true, sizeof...(A)>(args, MakeEntry(v));
+  }
+
+  template <typename... A> void FillAtomic(const A &...args) {
+    FillVariadic</*Atomic=*/true>(args...);
+  }
+
+  template <typename... A>
+  void FillAtomic(const std::tuple<A...> &args, Weight w) {
+    FillTuple</*Atomic=*/true>(args, w);
+  }
+
+  template <typename... A, typename V>
+  void FillAtomic(const std::tuple<A...> &args, const V &v, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/true, sizeof...(A)>(args, MakeEntry(v, w));
+  }
+
+  template <std::size_t N>
+  SoAProfile<WithError>
+  Slice(const std::array<BinIndexRange, N> &ranges) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+
+    SoAProfile<WithError> slice(fAxes.Slice(ranges));
+    const auto map = fAxes.ComputeSliceBinMap(ranges, slice.fAxes);
+    slice.fData.AddSlice(fData, map);
+    return slice;
+  }
+
+  template <typename... A> SoAProfile<WithError> Slice(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+    std::array<BinIndexRange, sizeof...(A)> ranges{args...};
+    return Slice(ranges);
+  }
+};
+
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_SPARSEHIST
+#define EPHIST_SPARSEHIST
+
+#include "Atomic.hxx"
+#include "Axes.hxx"
+#include "BinIndex.hxx"
+#include "BinIndexRange.hxx"
+#include "EPHist.hxx"
+#include "SparseStorage.hxx"
+#include "TypeTraits.hxx"
+#include "Weight.hxx"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+// A histogram with the same interface as EPHist<T>, but only allocating memory
+// for bins that are filled, see Internal::SparseStorage. This is useful for
+// high-dimensional histograms where most bins stay empty. Bin contents are
+// returned by value, with empty bins returning T{}.
+template <typename T> class SparseHist final {
+public:
+  using BinContentType = T;
+
+private:
+  Detail::Axes fAxes;
+  Internal::SparseStorage<T> fData;
+  // Atomic fills of stored bins take the lock shared and update the bin
+  // atomically; inserting a bin (which may grow the storage) takes the lock
+  // exclusively. The mutex is allocated to keep the histogram movable.
+  std::unique_ptr<std::shared_mutex> fMutex;
+
+public:
+  explicit SparseHist(std::vector<AxisVariant> axes)
+      : fAxes(std::move(axes)), fMutex(new std::shared_mutex) {}
+
+  SparseHist(std::size_t numBins, double low, double high)
+      : SparseHist({RegularAxis(numBins, low, high)}) {}
+  explicit SparseHist(const RegularAxis &axis)
+      : SparseHist(std::vector<AxisVariant>{axis}) {}
+  explicit SparseHist(const VariableBinAxis &axis)
+      : SparseHist(std::vector<AxisVariant>{axis}) {}
+  explicit SparseHist(const CategoricalAxis &axis)
+      : SparseHist(std::vector<AxisVariant>{axis}) {}
+  explicit SparseHist(const IntCategoricalAxis &axis)
+      : SparseHist(std::vector<AxisVariant>{axis}) {}
+
+  // Convert to a dense histogram, allocating all bins.
+  EPHist<T> ToEPHist() const {
+    EPHist<T> h(fAxes.GetVector());
+    fData.ForEach(
+        [&](std::size_t bin, const T &value) { h.fData[bin] = value; });
+    return h;
+  }
+
+  // Copy constructor and assignment operator are deleted to avoid surprises.
+  // Use the explicit Clone() function to create a copy.
+  SparseHist(const SparseHist<T> &) = delete;
+  SparseHist(SparseHist<T> &&) = default;
+  SparseHist<T> &operator=(const SparseHist<T> &) = delete;
+  SparseHist<T> &operator=(SparseHist<T> &&) = default;
+  ~SparseHist() = default;
+
+  void Add(const SparseHist<T> &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    other.fData.ForEach([&](std::size_t bin, const T &value) {
+      fData.FindOrInsert(bin) += value;
+    });
+  }
+
+  void Clear() { fData.Clear(); }
+
+  SparseHist<T> Clone() const {
+    SparseHist<T> h(fAxes.GetVector());
+    h.fData = fData;
+    return h;
+  }
+
+  T GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < GetTotalNumBins());
+    const T *value = fData.Find(bin);
+    return value ? *value : T{};
+  }
+  template <std::size_t N>
+  T GetBinContentAt(const std::array<BinIndex, N> &args) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return GetBinContent(bin.first);
+  }
+  template <typename... A> T GetBinContentAt(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    std::array<BinIndex, sizeof...(A)> a{args...};
+    return GetBinContentAt(a);
+  }
+  std::size_t GetTotalNumBins() const { return fAxes.ComputeTotalNumBins(); }
+  // Get the number of bins that are stored, which were filled at least once.
+  std::size_t GetNumStoredBins() const { return fData.GetSize(); }
+
+  const std::vector<AxisVariant> &GetAxes() const { return fAxes.GetVector(); }
+  std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
+
+  static constexpr bool SupportsWeightedFill = EPHist<T>::SupportsWeightedFill;
+
+private:
+  template <bool Atomic, bool Weighted>
+  void FillBin(std::size_t bin, [[maybe_unused]] double w) {
+    if constexpr (Atomic) {
+      {
+        std::shared_lock lock(*fMutex);
+        if (T *value = fData.Find(bin)) {
+          if constexpr (Weighted) {
+            Internal::AtomicAddDouble(value, w);
+          } else {
+            Internal::AtomicInc(value);
+          }
+          return;
+        }
+      }
+      std::unique_lock lock(*fMutex);
+      FillBin</*Atomic=*/false, Weighted>(bin, w);
+    } else if constexpr (Weighted) {
+      fData.FindOrInsert(bin) += w;
+    } else {
+      fData.FindOrInsert(bin)++;
+    }
+  }
+
+  template <bool Atomic, bool Weighted, std::size_t N, typename... A>
+  void FillImpl(const std::tuple<A...> &args, double w) {
+    static_assert(
+        !Weighted || SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    assert(N == fAxes.GetNumDimensions());
+    auto bin = fAxes.ComputeBin<N>(args);
+    if (bin.second) {
+      FillBin<Atomic, Weighted>(bin.first, w);
+    }
+  }
+
+  template <bool Atomic, typename... A> void FillVariadic(const A &...args) {
+    auto t = std::forward_as_tuple(args...);
+    // Could use std::tuple_element_t<sizeof...(A) - 1, decltype(t)>, but that
+    // would be const Weight &
+    if constexpr (std::is_same_v<typename Internal::LastType<A...>::type,
+                                 Weight>) {
+      if (sizeof...(A) - 1 != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillImpl<Atomic, /*Weighted=*/true, sizeof...(A) - 1>(
+          t, std::get<sizeof...(A) - 1>(t).fValue);
+    } else {
+      if (sizeof...(A) != fAxes.GetNumDimensions()) {
+        throw std::invalid_argument("invalid number of arguments to Fill");
+      }
+      FillImpl<Atomic, /*Weighted=*/false, sizeof...(A)>(t, 1);
+    }
+  }
+
+public:
+  template <typename... A> void Fill(const std::tuple<A...> &args) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/false, /*Weighted=*/false, sizeof...(A)>(args, 1);
+  }
+
+  template <typename... A> void Fill(const A &...args) {
+    FillVariadic</*Atomic=*/false>(args...);
+  }
+
+  template <typename... A> void Fill(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/false, /*Weighted=*/true, sizeof...(A)>(args,
+                                                                 w.fValue);
+  }
+
+  template <typename... A> void FillAtomic(const std::tuple<A...> &args) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/true, /*Weighted=*/false, sizeof...(A)>(args, 1);
+  }
+
+  template <typename... A> void FillAtomic(const A &...args) {
+    FillVariadic</*Atomic=*/true>(args...);
+  }
+
+  template <typename... A>
+  void FillAtomic(const std::tuple<A...> &args, Weight w) {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Fill");
+    }
+    FillImpl</*Atomic=*/true, /*Weighted=*/true, sizeof...(A)>(args,
+                                                                w.fValue);
+  }
+
+  template <std::size_t N>
+  SparseHist<T> Slice(const std::array<BinIndexRange, N> &ranges) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+
+    // Only visit the stored bins instead of walking all bins.
+    SparseHist<T> slice(fAxes.Slice(ranges));
+    const auto map = fAxes.ComputeSliceBinMap(ranges, slice.fAxes);
+    fData.ForEach([&](std::size_t bin, const T &value) {
+      slice.fData.FindOrInsert(map(bin)) += value;
+    });
+    return slice;
+  }
+
+  template <typename... A> SparseHist<T> Slice(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument("invalid number of arguments to Slice");
+    }
+    std::array<BinIndexRange, sizeof...(A)> ranges{args...};
+    return Slice(ranges);
+  }
+};
+
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_SPARSESTORAGE
+#define EPHIST_SPARSESTORAGE
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace EPHist {
+namespace Internal {
+
+// Storage of bins that only allocates memory for bins that were touched, as a
+// hash map from the linearized bin to its content. It uses open addressing
+// with linear probing: keys and values are stored in two flat arrays, and
+// finding a bin scans the keys starting from the position given by its hash.
+// Bins are never removed individually.
+template <typename T> class SparseStorage final {
+  static constexpr std::size_t EmptyKey =
+      std::numeric_limits<std::size_t>::max();
+  static constexpr unsigned InitialCapacityBits = 4;
+  static constexpr std::size_t InitialCapacity = 1 << InitialCapacityBits;
+
+  std::vector<std::size_t> fKeys;
+  std::vector<T> fValues;
+  std::size_t fSize = 0;
+  // The number of bits to shift the hash, 64 - log2(capacity).
+  unsigned fShift;
+
+  std::size_t GetSlot(std::size_t key) const {
+    // Fibonacci hashing: multiply by 2^64 divided by the golden ratio and take
+    // the upper bits, which depend on all bits of the key.
+    return (static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15) >> fShift;
+  }
+
+  std::size_t FindSlot(std::size_t key) const {
+    assert(key != EmptyKey);
+    const std::size_t mask = fKeys.size() - 1;
+    std::size_t slot = GetSlot(key);
+    while (fKeys[slot] != key && fKeys[slot] != EmptyKey) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void Grow() {
+    std::vector<std::size_t> keys(2 * fKeys.size(), EmptyKey);
+    std::vector<T> values(2 * fValues.size());
+    keys.swap(fKeys);
+    values.swap(fValues);
+    fShift--;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      if (keys[i] != EmptyKey) {
+        const std::size_t slot = FindSlot(keys[i]);
+        fKeys[slot] = keys[i];
+        fValues[slot] = values[i];
+      }
+    }
+  }
+
+public:
+  SparseStorage()
+      : fKeys(InitialCapacity, EmptyKey), fValues(InitialCapacity),
+        fShift(64 - InitialCapacityBits) {}
+
+  // Get the number of stored bins.
+  std::size_t GetSize() const { return fSize; }
+  // Get the number of bins that can be stored without growing the hash map.
+  std::size_t GetCapacity() const { return fKeys.size() / 2; }
+
+  // Find the content of a bin, or return nullptr if it is not stored.
+  const T *Find(std::size_t bin) const {
+    const std::size_t slot = FindSlot(bin);
+    return fKeys[slot] == bin ? &fValues[slot] : nullptr;
+  }
+  T *Find(std::size_t bin) {
+    const std::size_t slot = FindSlot(bin);
+    return fKeys[slot] == bin ? &fValues[slot] : nullptr;
+  }
+
+  // Find the content of a bin, or insert it with an empty content.
+  T &FindOrInsert(std::size_t bin) {
+    std::size_t slot = FindSlot(bin);
+    if (fKeys[slot] == bin) {
+      return fValues[slot];
+    }
+    // Keep the load factor at most 1/2 for short probe sequences.
+    if (fSize + 1 > GetCapacity()) {
+      Grow();
+      slot = FindSlot(bin);
+    }
+    fKeys[slot] = bin;
+    fSize++;
+    return fValues[slot];
+  }
+
+  // Call f(bin, content) for all stored bins, in unspecified order.
+  template <typename F> void ForEach(F &&f) const {
+    for (std::size_t i = 0; i < fKeys.size(); i++) {
+      if (fKeys[i] != EmptyKey) {
+        f(fKeys[i], fValues[i]);
+      }
+    }
+  }
+
+  // Remove all bins, but keep the allocated memory.
+  void Clear() {
+    std::fill(fKeys.begin(), fKeys.end(), EmptyKey);
+    std::fill(fValues.begin(), fValues.end(), T{});
+    fSize = 0;
+  }
+};
+
+} // namespace Internal
+} // namespace EPHist
+
+#endif
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_STATICHIST
+#define EPHIST_STATICHIST
+
+#include "Atomic.hxx"
+#include "Axes.hxx"
+#include "BinIndex.hxx"
+#include "EPHist.hxx"
+#include "Weight.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+
+// A histogram with axis types fixed at compile time, for example
+// StaticHist<int, RegularAxis, VariableBinAxis>. The axes are stored in a
+// std::tuple so that the bin computation can be fully inlined without
+// dispatching on the axis type. The bins are laid out in the same order as in
+// EPHist, and the histogram can be converted from and to EPHist<T> for
+// merging and export.
+template <typename T, class... Axes> class StaticHist final {
+  static_assert(sizeof...(Axes) > 0, "StaticHist needs at least one axis");
+
+public:
+  using BinContentType = T;
+
+private:
+  std::vector<T> fData;
+
+  std::tuple<Axes...> fAxes;
+
+  template <std::size_t... I>
+  std::size_t ComputeTotalNumBins(std::index_sequence<I...>) const {
+    return (std::size_t(1) * ... * std::get<I>(fAxes).GetTotalNumBins());
+  }
+
+  template <std::size_t I, typename A, typename... As>
+  std::pair<std::size_t, bool> ComputeBin(std::size_t bin, const A &arg,
+                                          const As &...args) const {
+    const auto &axis = std::get<I>(fAxes);
+    bin = bin * axis.GetTotalNumBins();
+    auto axisBin = axis.ComputeBin(arg);
+    if (!axisBin.second) {
+      return {0, false};
+    }
+    bin += axisBin.first;
+    if constexpr (sizeof...(As) > 0) {
+      return ComputeBin<I + 1>(bin, args...);
+    }
+    return {bin, true};
+  }
+
+  template <std::size_t I, typename... As>
+  std::pair<std::size_t, bool> GetBin(std::size_t bin, const BinIndex &index,
+                                      const As &...indices) const {
+    const auto &axis = std::get<I>(fAxes);
+    bin = bin * axis.GetTotalNumBins();
+    auto axisBin = axis.GetBin(index);
+    if (!axisBin.second) {
+      return {0, false};
+    }
+    bin += axisBin.first;
+    if constexpr (sizeof...(As) > 0) {
+      return GetBin<I + 1>(bin, indices...);
+    }
+    return {bin, true};
+  }
+
+  template <std::size_t... I>
+  std::pair<std::size_t, bool>
+  GetBin(const std::array<BinIndex, sizeof...(Axes)> &args,
+         std::index_sequence<I...>) const {
+    return GetBin<0>(0, args[I]...);
+  }
+
+  template <std::size_t... I>
+  std::vector<AxisVariant> GetAxisVariants(std::index_sequence<I...>) const {
+    return {std::get<I>(fAxes)...};
+  }
+
+  template <std::size_t... I>
+  static std::tuple<Axes...>
+  GetAxesFromVariants(const std::vector<AxisVariant> &axes,
+                      std::index_sequence<I...>) {
+    if (((axes[I].index() != Internal::AxisVariantIndex<Axes>::value) || ...)) {
+      throw std::invalid_argument("invalid axis type");
+    }
+    return {*std::get_if<Axes>(&axes[I])...};
+  }
+
+  static constexpr auto Indices = std::index_sequence_for<Axes...>{};
+
+public:
+  explicit StaticHist(const Axes &...axes) : fAxes(axes...) {
+    fData.resize(ComputeTotalNumBins(Indices));
+  }
+
+  // Copy constructor and assignment operator are deleted to avoid surprises.
+  // Use the explicit Clone() function to create a copy.
+  StaticHist(const StaticHist &) = delete;
+  StaticHist(StaticHist &&) = default;
+  StaticHist &operator=(const StaticHist &) = delete;
+  StaticHist &operator=(StaticHist &&) = default;
+  ~StaticHist() = default;
+
+  // Convert from a dynamic histogram; throws if the axis types do not match.
+  static StaticHist FromEPHist(const EPHist<T> &h) {
+    const auto &axes = h.GetAxes();
+    if (axes.size() != sizeof...(Axes)) {
+      throw std::invalid_argument("invalid number of axes");
+    }
+    StaticHist s(GetAxesFromVariants(axes, Indices));
+    assert(s.fData.size() == h.fData.size());
+    std::copy(h.fData.data(), h.fData.data() + h.fData.size(),
+              s.fData.begin());
+    return s;
+  }
+
+  // Convert to a dynamic histogram, for example to merge it with others or to
+  // export it.
+  EPHist<T> ToEPHist() const {
+    EPHist<T> h(GetAxisVariants(Indices));
+    assert(h.fData.size() == fData.size());
+    std::copy(fData.begin(), fData.end(), h.fData.data());
+    return h;
+  }
+
+  void Add(const StaticHist &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    for (std::size_t i = 0; i < fData.size(); i++) {
+      fData[i] += other.fData[i];
+    }
+  }
+
+  void AddAtomic(const StaticHist &other) {
+    if (fAxes != other.fAxes) {
+      throw std::invalid_argument("axes configuration not identical");
+    }
+    for (std::size_t i = 0; i < fData.size(); i++) {
+      Internal::AtomicAdd(&fData[i], other.fData[i]);
+    }
+  }
+
+  void Clear() {
+    for (std::size_t i = 0; i < fData.size(); i++) {
+      fData[i] = {};
+    }
+  }
+
+  StaticHist Clone() const {
+    StaticHist h(fAxes);
+    h.fData = fData;
+    return h;
+  }
+
+  const T &GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < fData.size());
+    return fData[bin];
+  }
+  const T &
+  GetBinContentAt(const std::array<BinIndex, sizeof...(Axes)> &args) const {
+    auto bin = GetBin(args, Indices);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return fData[bin.first];
+  }
+  template <typename... A> const T &GetBinContentAt(const A &...args) const {
+    static_assert(sizeof...(A) == sizeof...(Axes),
+                  "invalid number of arguments to GetBinContent");
+    return GetBinContentAt({BinIndex(args)...});
+  }
+  std::size_t GetTotalNumBins() const { return fData.size(); }
+
+  const std::tuple<Axes...> &GetAxes() const { return fAxes; }
+  static constexpr std::size_t GetNumDimensions() { return sizeof...(Axes); }
+
+  static constexpr bool SupportsWeightedFill = EPHist<T>::SupportsWeightedFill;
+
+  void Fill(const typename Axes::ArgumentType &...args) {
+    auto bin = ComputeBin<0>(0, args...);
+    if (bin.second) {
+      fData[bin.first]++;
+    }
+  }
+
+  void Fill(const std::tuple<typename Axes::ArgumentType...> &args) {
+    std::apply([this](const auto &...a) { Fill(a...); }, args);
+  }
+
+  void Fill(const typename Axes::ArgumentType &...args, Weight w) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    auto bin = ComputeBin<0>(0, args...);
+    if (bin.second) {
+      fData[bin.first] += w.fValue;
+    }
+  }
+
+  void FillAtomic(const typename Axes::ArgumentType &...args) {
+    auto bin = ComputeBin<0>(0, args...);
+    if (bin.second) {
+      Internal::AtomicInc(&fData[bin.first]);
+    }
+  }
+
+  void FillAtomic(const typename Axes::ArgumentType &...args, Weight w) {
+    static_assert(
+        SupportsWeightedFill,
+        "Fill with Weight is only supported for floating point bin types");
+    auto bin = ComputeBin<0>(0, args...);
+    if (bin.second) {
+      Internal::AtomicAddDouble(&fData[bin.first], w.fValue);
+    }
+  }
+
+private:
+  explicit StaticHist(const std::tuple<Axes...> &axes) : fAxes(axes) {
+    fData.resize(ComputeTotalNumBins(Indices));
+  }
+};
+
+} // namespace EPHist
+
+#endif
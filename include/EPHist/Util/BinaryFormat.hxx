@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_UTIL_BINARYFORMAT
+#define EPHIST_UTIL_BINARYFORMAT
+
+#include "../AlignedDoubleBinWithError.hxx"
+#include "../Axes.hxx"
+#include "../BinIndex.hxx"
+#include "../BinStorage.hxx"
+#include "../DoubleBinWithError.hxx"
+#include "../EPHist.hxx"
+#include "../FixedPointBin.hxx"
+#include "../Profile.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+namespace Util {
+
+// The binary format stores a histogram or profile as a fixed-size header,
+// followed by the axes and the raw array of bin contents:
+//
+//   offset 0            BinaryHeader (64 bytes)
+//   offset 64           axes, see SerializeAxes
+//   fDataOffset         fTotalNumBins bin contents in native layout
+//
+// The bin contents start at a multiple of BinaryAlignment, so a file can be
+// mapped into memory and its bins used in place, see HistView. All numbers are
+// stored in the byte order of the machine that wrote the file; the header
+// records it, and reading a file with a different byte order is rejected.
+
+enum class BinaryBinType : std::uint32_t {
+  Int = 1,
+  Long = 2,
+  LongLong = 3,
+  Float = 4,
+  Double = 5,
+  DoubleBinWithError = 6,
+  AlignedDoubleBinWithError = 7,
+  FixedPointBin = 8,
+  ProfileDoubleBin = 9,
+  ProfileDoubleBinWithError = 10,
+};
+
+template <typename T> struct BinaryBinTypeOf;
+template <> struct BinaryBinTypeOf<int> {
+  static constexpr BinaryBinType Value = BinaryBinType::Int;
+};
+template <> struct BinaryBinTypeOf<long> {
+  static constexpr BinaryBinType Value = BinaryBinType::Long;
+};
+template <> struct BinaryBinTypeOf<long long> {
+  static constexpr BinaryBinType Value = BinaryBinType::LongLong;
+};
+template <> struct BinaryBinTypeOf<float> {
+  static constexpr BinaryBinType Value = BinaryBinType::Float;
+};
+template <> struct BinaryBinTypeOf<double> {
+  static constexpr BinaryBinType Value = BinaryBinType::Double;
+};
+template <> struct BinaryBinTypeOf<DoubleBinWithError> {
+  static constexpr BinaryBinType Value = BinaryBinType::DoubleBinWithError;
+};
+template <> struct BinaryBinTypeOf<AlignedDoubleBinWithError> {
+  static constexpr BinaryBinType Value =
+      BinaryBinType::AlignedDoubleBinWithError;
+};
+template <> struct BinaryBinTypeOf<FixedPointBin> {
+  static constexpr BinaryBinType Value = BinaryBinType::FixedPointBin;
+};
+template <> struct BinaryBinTypeOf<Profile<false>::DoubleBin> {
+  static constexpr BinaryBinType Value = BinaryBinType::ProfileDoubleBin;
+};
+template <> struct BinaryBinTypeOf<Profile<true>::DoubleBinWithError> {
+  static constexpr BinaryBinType Value =
+      BinaryBinType::ProfileDoubleBinWithError;
+};
+
+static constexpr std::size_t BinaryAlignment = 64;
+// The maximum size of the serialized axes. Streams do not know their size, so
+// this bounds the memory allocated for the axes of a corrupt file.
+static constexpr std::size_t BinaryMaxAxesSize = std::size_t(1) << 28;
+
+struct BinaryHeader {
+  static constexpr char Magic[8] = {'E', 'P', 'H', 'i', 's', 't', 'B', 'F'};
+  // The magic of the compressed variant, see CompressedFormat.hxx.
+  static constexpr char CompressedMagic[8] = {'E', 'P', 'H', 'i',
+                                              's', 't', 'C', 'F'};
+  // Version 2 added fAxesFingerprint in place of a reserved field.
+  static constexpr std::uint32_t CurrentVersion = 2;
+  static constexpr std::uint32_t NativeByteOrder = 0x01020304;
+
+  char fMagic[8];
+  std::uint32_t fVersion;
+  std::uint32_t fByteOrder;
+  std::uint32_t fBinType;
+  std::uint32_t fBinSize;
+  std::uint64_t fNumDimensions;
+  std::uint64_t fTotalNumBins;
+  // The axes are stored from offset sizeof(BinaryHeader) up to fDataOffset.
+  std::uint64_t fDataOffset;
+  std::uint64_t fDataSize;
+  // A hash of the serialized axes, to check that files are compatible without
+  // deserializing their axes, see ComputeAxesFingerprint.
+  std::uint64_t fAxesFingerprint;
+};
+static_assert(sizeof(BinaryHeader) == BinaryAlignment,
+              "unexpected size of BinaryHeader");
+
+// Serialize the axes, padded to a multiple of BinaryAlignment. Each axis is
+// stored as its kind and the flag for flow bins (two 32-bit integers) and the
+// number of values (64-bit), followed by the values: low and high for a
+// RegularAxis, the bin edges, the integer categories, or the string categories
+// each as its length and characters padded to 8 bytes.
+std::string SerializeAxes(const std::vector<AxisVariant> &axes);
+std::vector<AxisVariant> DeserializeAxes(const char *data, std::size_t size,
+                                         std::size_t numDimensions);
+
+// Compute the 64-bit FNV-1a hash of the serialized axes.
+std::uint64_t ComputeAxesFingerprint(const std::string &axes);
+
+// Create the header for the serialized axes and the bin type.
+BinaryHeader MakeBinaryHeader(std::size_t numDimensions,
+                              const std::string &axes,
+                              std::size_t totalNumBins, BinaryBinType binType,
+                              std::size_t binSize);
+// Validate a header read from a file of the given size, which may be zero if
+// it is unknown. Throws std::invalid_argument if the file was not written in
+// the binary format (or its compressed variant, if requested) or with a
+// different byte order or bin type.
+void CheckBinaryHeader(const BinaryHeader &header, BinaryBinType binType,
+                       std::size_t binSize, std::size_t fileSize,
+                       bool compressed = false);
+
+// A shared memory mapping of a whole file, read-only by default. Writes to a
+// writable mapping go to the page cache and reach the file eventually, or when
+// calling Sync().
+class MappedFile final {
+  char *fData = nullptr;
+  std::size_t fSize = 0;
+  bool fWritable;
+
+public:
+  explicit MappedFile(const std::string &path, bool writable = false);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+  ~MappedFile();
+
+  const char *GetData() const { return fData; }
+  char *GetWritableData() {
+    assert(fWritable);
+    return fData;
+  }
+  std::size_t GetSize() const { return fSize; }
+  bool IsWritable() const { return fWritable; }
+
+  // Write the modified pages in the range to the file, and wait until they
+  // are on disk.
+  void Sync(const char *begin, std::size_t size) const;
+};
+
+// Get the validated header of a mapped file in the binary format, and
+// deserialize its axes.
+const BinaryHeader &GetBinaryHeader(const MappedFile &file,
+                                    BinaryBinType binType, std::size_t binSize);
+std::vector<AxisVariant> DeserializeAxes(const MappedFile &file,
+                                         const BinaryHeader &header);
+
+// Access to the bins of EPHist and Profile for the binary format.
+template <typename H> class BinaryIO final {
+public:
+  using BinContentType = typename H::BinContentType;
+
+  static const BinContentType *GetData(const H &h) { return h.fData.data(); }
+  static BinContentType *GetData(H &h) { return h.fData.data(); }
+
+  static bool IsExternal(const H &h) { return h.fData.IsExternal(); }
+  // Get the mapped file holding the bins, or nullptr if they are in memory.
+  static const MappedFile *GetFile(const H &h) {
+    // Create is the only way to get bins in external memory, and their owner
+    // is always a MappedFile.
+    return static_cast<const MappedFile *>(h.fData.GetOwner());
+  }
+  // Create a histogram whose bins are stored in a writable mapped file,
+  // starting at dataOffset.
+  static H Create(std::vector<AxisVariant> axes,
+                  std::shared_ptr<MappedFile> file, std::size_t dataOffset) {
+    Detail::Axes a(std::move(axes));
+    const std::size_t numBins = a.ComputeTotalNumBins();
+    if (dataOffset > file->GetSize() ||
+        numBins > (file->GetSize() - dataOffset) / sizeof(BinContentType)) {
+      throw std::invalid_argument("file truncated");
+    }
+    auto *data = reinterpret_cast<BinContentType *>(file->GetWritableData() +
+                                                    dataOffset);
+    return H(a, Internal::BinStorage<BinContentType>(data, numBins,
+                                                     std::move(file)));
+  }
+};
+
+// Write a histogram or profile in the binary format.
+template <typename H> void WriteBinary(const H &h, std::ostream &os) {
+  using T = typename H::BinContentType;
+  const std::string axes = SerializeAxes(h.GetAxes());
+  const BinaryHeader header =
+      MakeBinaryHeader(h.GetNumDimensions(), axes, h.GetTotalNumBins(),
+                       BinaryBinTypeOf<T>::Value, sizeof(T));
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(axes.data(), axes.size());
+  os.write(reinterpret_cast<const char *>(BinaryIO<H>::GetData(h)),
+           header.fDataSize);
+  if (!os) {
+    throw std::runtime_error("could not write histogram");
+  }
+}
+
+// Read a histogram or profile from a stream, copying the bins directly into
+// the returned object.
+template <typename H> H ReadBinary(std::istream &is) {
+  using T = typename H::BinContentType;
+  BinaryHeader header;
+  if (!is.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    throw std::invalid_argument("could not read header");
+  }
+  CheckBinaryHeader(header, BinaryBinTypeOf<T>::Value, sizeof(T), 0);
+  std::string axes(header.fDataOffset - sizeof(header), '\0');
+  if (!is.read(axes.data(), axes.size())) {
+    throw std::invalid_argument("could not read axes");
+  }
+  H h(DeserializeAxes(axes.data(), axes.size(), header.fNumDimensions));
+  if (h.GetTotalNumBins() != header.fTotalNumBins) {
+    throw std::invalid_argument("number of bins does not match axes");
+  }
+  if (!is.read(reinterpret_cast<char *>(BinaryIO<H>::GetData(h)),
+               header.fDataSize)) {
+    throw std::invalid_argument("could not read bins");
+  }
+  return h;
+}
+
+// A read-only view of a histogram or profile in the binary format, usually
+// from a file mapped into memory. Opening only reads the header and the axes,
+// the bin contents are used in place without copying.
+template <typename H> class HistView final {
+public:
+  using BinContentType = typename H::BinContentType;
+
+private:
+  std::shared_ptr<const MappedFile> fFile;
+  Detail::Axes fAxes;
+  const BinContentType *fData;
+  std::size_t fNumBins;
+
+  static const BinaryHeader &GetHeader(const MappedFile &file) {
+    return GetBinaryHeader(file, BinaryBinTypeOf<BinContentType>::Value,
+                           sizeof(BinContentType));
+  }
+
+public:
+  explicit HistView(std::shared_ptr<const MappedFile> file)
+      : fFile(std::move(file)),
+        fAxes(DeserializeAxes(*fFile, GetHeader(*fFile))) {
+    const BinaryHeader &header = GetHeader(*fFile);
+    if (fAxes.ComputeTotalNumBins() != header.fTotalNumBins) {
+      throw std::invalid_argument("number of bins does not match axes");
+    }
+    fData = reinterpret_cast<const BinContentType *>(fFile->GetData() +
+                                                     header.fDataOffset);
+    fNumBins = header.fTotalNumBins;
+  }
+  explicit HistView(const std::string &path)
+      : HistView(std::make_shared<const MappedFile>(path)) {}
+
+  // Convert to a histogram or profile, copying the bins.
+  H ToHist() const {
+    H h(fAxes.GetVector());
+    std::copy(fData, fData + GetTotalNumBins(), BinaryIO<H>::GetData(h));
+    return h;
+  }
+
+  const BinContentType &GetBinContent(std::size_t bin) const {
+    assert(bin >= 0 && bin < GetTotalNumBins());
+    return fData[bin];
+  }
+  template <std::size_t N>
+  const BinContentType &
+  GetBinContentAt(const std::array<BinIndex, N> &args) const {
+    if (N != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    auto bin = fAxes.ComputeBin(args);
+    if (!bin.second) {
+      throw std::invalid_argument("bin not found");
+    }
+    return fData[bin.first];
+  }
+  template <typename... A>
+  const BinContentType &GetBinContentAt(const A &...args) const {
+    if (sizeof...(A) != fAxes.GetNumDimensions()) {
+      throw std::invalid_argument(
+          "invalid number of arguments to GetBinContent");
+    }
+    std::array<BinIndex, sizeof...(A)> a{args...};
+    return GetBinContentAt(a);
+  }
+  // The bin contents, stored contiguously in the mapped file.
+  const BinContentType *GetData() const { return fData; }
+  std::size_t GetTotalNumBins() const { return fNumBins; }
+
+  const std::vector<AxisVariant> &GetAxes() const { return fAxes.GetVector(); }
+  std::size_t GetNumDimensions() const { return fAxes.GetNumDimensions(); }
+};
+
+template <typename T> using EPHistView = HistView<EPHist<T>>;
+template <bool WithError = true>
+using ProfileView = HistView<Profile<WithError>>;
+
+} // namespace Util
+} // namespace EPHist
+
+#endif
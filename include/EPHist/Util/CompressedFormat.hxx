@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_UTIL_COMPRESSEDFORMAT
+#define EPHIST_UTIL_COMPRESSEDFORMAT
+
+#include "../FixedPointBin.hxx"
+#include "BinaryFormat.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace EPHist {
+namespace Util {
+
+// The compressed variant of the binary format (see BinaryFormat.hxx) has the
+// same header, with BinaryHeader::CompressedMagic, and axes. fDataSize is the
+// size of the uncompressed bin contents, which are stored in blocks:
+//
+//   fDataOffset         block size in bytes and number of blocks (64-bit)
+//                       one CompressedBlock per block
+//                       the encoded blocks, one after the other
+//
+// Each block is encoded on its own with the CompressedEncoding that results in
+// the smallest size, which makes mostly empty histograms very small. Blocks
+// are encoded and decoded in parallel for large histograms.
+
+enum class CompressedEncoding : std::uint32_t {
+  // The bytes of the bin contents.
+  Raw = 0,
+  // All bytes are zero; nothing is stored.
+  Zero = 1,
+  // Alternating runs of zero and non-zero words: the size of the control
+  // stream as a varint, the control stream with the lengths of each pair of
+  // runs as varints, and the bytes of the non-zero words.
+  ZeroRuns = 2,
+  // For integer words: the zigzag-encoded differences to the previous word as
+  // varints, where a zero difference is followed by the number of repetitions.
+  VarintDelta = 3,
+  // For floating-point words: like ZeroRuns, but the bytes of the non-zero
+  // words are shuffled so that the first bytes of all words come first, then
+  // the second bytes, and so on, followed by LZ-style compression that
+  // replaces repeated byte sequences with references to earlier occurrences.
+  ShuffleLZ = 4,
+};
+
+struct CompressedBlock {
+  std::uint32_t fEncoding;
+  std::uint32_t fReserved;
+  // The size of the encoded block in bytes.
+  std::uint64_t fSize;
+};
+
+// The size of the uncompressed bin contents per block, in bytes.
+static constexpr std::size_t CompressedBlockSize = 64 * 1024;
+
+// How the bin contents are split into words for compression: integers are
+// compressed as integers of their size, all other types are made up of double
+// or float values.
+template <typename T> struct CompressedWordOf {
+  static constexpr std::size_t Size = sizeof(double);
+  static constexpr bool Integer = false;
+};
+template <> struct CompressedWordOf<float> {
+  static constexpr std::size_t Size = sizeof(float);
+  static constexpr bool Integer = false;
+};
+template <> struct CompressedWordOf<int> {
+  static constexpr std::size_t Size = sizeof(int);
+  static constexpr bool Integer = true;
+};
+template <> struct CompressedWordOf<long> {
+  static constexpr std::size_t Size = sizeof(long);
+  static constexpr bool Integer = true;
+};
+template <> struct CompressedWordOf<long long> {
+  static constexpr std::size_t Size = sizeof(long long);
+  static constexpr bool Integer = true;
+};
+template <> struct CompressedWordOf<FixedPointBin> {
+  static constexpr std::size_t Size = sizeof(std::int64_t);
+  static constexpr bool Integer = true;
+};
+
+// Compress size bytes of bin contents made up of words with wordSize bytes (4
+// or 8) and write them, starting with the block size and number of blocks. Up
+// to numThreads threads are used (see BulkOperations.hxx, 0 selects the
+// number of hardware threads).
+void WriteCompressedData(const char *data, std::size_t size,
+                         std::size_t wordSize, bool integer, std::ostream &os,
+                         std::size_t numThreads);
+// Read and decompress size bytes of bin contents written by
+// WriteCompressedData. Throws std::invalid_argument if the data is corrupt.
+void ReadCompressedData(std::istream &is, char *data, std::size_t size,
+                        std::size_t wordSize, std::size_t numThreads);
+
+// Write a histogram or profile in the compressed binary format.
+template <typename H>
+void WriteCompressed(const H &h, std::ostream &os, std::size_t numThreads = 1) {
+  using T = typename H::BinContentType;
+  using Word = CompressedWordOf<T>;
+  static_assert(sizeof(T) % Word::Size == 0, "invalid word size");
+  const std::string axes = SerializeAxes(h.GetAxes());
+  BinaryHeader header =
+      MakeBinaryHeader(h.GetNumDimensions(), axes, h.GetTotalNumBins(),
+                       BinaryBinTypeOf<T>::Value, sizeof(T));
+  std::memcpy(header.fMagic, BinaryHeader::CompressedMagic,
+              sizeof(header.fMagic));
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(axes.data(), axes.size());
+  WriteCompressedData(reinterpret_cast<const char *>(BinaryIO<H>::GetData(h)),
+                      header.fDataSize, Word::Size, Word::Integer, os,
+                      numThreads);
+  if (!os) {
+    throw std::runtime_error("could not write histogram");
+  }
+}
+
+// Read a histogram or profile in the compressed binary format, decompressing
+// the bins directly into the returned object.
+template <typename H>
+H ReadCompressed(std::istream &is, std::size_t numThreads = 1) {
+  using T = typename H::BinContentType;
+  BinaryHeader header;
+  if (!is.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    throw std::invalid_argument("could not read header");
+  }
+  CheckBinaryHeader(header, BinaryBinTypeOf<T>::Value, sizeof(T), 0,
+                    /*compressed=*/true);
+  std::string axes(header.fDataOffset - sizeof(header), '\0');
+  if (!is.read(axes.data(), axes.size())) {
+    throw std::invalid_argument("could not read axes");
+  }
+  H h(DeserializeAxes(axes.data(), axes.size(), header.fNumDimensions));
+  if (h.GetTotalNumBins() != header.fTotalNumBins) {
+    throw std::invalid_argument("number of bins does not match axes");
+  }
+  ReadCompressedData(is, reinterpret_cast<char *>(BinaryIO<H>::GetData(h)),
+                     header.fDataSize, CompressedWordOf<T>::Size, numThreads);
+  return h;
+}
+
+} // namespace Util
+} // namespace EPHist
+
+#endif
@@ -4,8 +4,12 @@
 #define EPHIST_UTIL_EXPORTDATA
 
 #include "../EPHist.hxx"
+#include "../SoAHist.hxx"
+#include "../SoAProfile.hxx"
 
+#include <cstddef>
 #include <ostream>
+#include <vector>
 
 namespace EPHist {
 namespace Util {
@@ -34,6 +38,26 @@ public:
   }
 };
 
+// Export one column of a SoAHist or SoAProfile, reading only its array.
+template <typename H> class ColumnForExportT final : public EPHistForExport {
+  const H *fHist;
+  const std::vector<double> *fColumn;
+
+public:
+  ColumnForExportT(const H &h, std::size_t column)
+      : fHist(&h), fColumn(&h.GetColumn(column)) {}
+
+  const std::vector<AxisVariant> &GetAxes() const override {
+    return fHist->GetAxes();
+  }
+  std::size_t GetNumDimensions() const override {
+    return fHist->GetNumDimensions();
+  }
+  void PrintBinContent(std::size_t bin, std::ostream &os) const override {
+    os << (*fColumn)[bin];
+  }
+};
+
 // Export data in a textual format, that can for example be used with gnuplot,
 // Matplotlib, and PGFPlots.
 void ExportTextData(const EPHistForExport &h, std::ostream &os);
@@ -41,6 +65,15 @@ template <typename T>
 void ExportTextData(const EPHist<T> &h, std::ostream &os) {
   ExportTextData(EPHistForExportT<T>(h), os);
 }
+template <typename T>
+void ExportTextData(const SoAHist<T> &h, std::size_t column, std::ostream &os) {
+  ExportTextData(ColumnForExportT<SoAHist<T>>(h, column), os);
+}
+template <bool WithError>
+void ExportTextData(const SoAProfile<WithError> &p, std::size_t column,
+                    std::ostream &os) {
+  ExportTextData(ColumnForExportT<SoAProfile<WithError>>(p, column), os);
+}
 
 } // namespace Util
 } // namespace EPHist
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_UTIL_FILEBACKEDHIST
+#define EPHIST_UTIL_FILEBACKEDHIST
+
+#include "../Axes.hxx"
+#include "../EPHist.hxx"
+#include "BinaryFormat.hxx"
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace EPHist {
+namespace Util {
+
+// File-backed histograms are EPHist objects whose bins live in a file in the
+// binary format (see BinaryFormat.hxx) that is mapped into memory. Fill and
+// FillAtomic write straight into the page cache, so the bins survive a crash
+// of the process and filling can be resumed by opening the file again. They
+// work with all operations of EPHist, for example with the ParallelHelper
+// when held in a std::shared_ptr: the Atomic strategy fills the shared
+// mapping directly. Copies made by Clone() store their bins in memory.
+
+// Create a file in the binary format with the given header and axes. The
+// bins are not written, the file is only extended to its full size, so they
+// are zero and need not be allocated on disk until they are filled.
+void CreateEmptyBinaryFile(const std::string &path, const BinaryHeader &header,
+                           const std::string &axes);
+
+// Open an existing file in the binary format, for example to resume filling.
+template <typename T> EPHist<T> OpenFileBackedEPHist(const std::string &path) {
+  auto file = std::make_shared<MappedFile>(path, /*writable=*/true);
+  const BinaryHeader &header =
+      GetBinaryHeader(*file, BinaryBinTypeOf<T>::Value, sizeof(T));
+  auto axes = DeserializeAxes(*file, header);
+  if (Detail::Axes(axes).ComputeTotalNumBins() != header.fTotalNumBins) {
+    throw std::invalid_argument("number of bins does not match axes");
+  }
+  const std::size_t dataOffset = header.fDataOffset;
+  return BinaryIO<EPHist<T>>::Create(std::move(axes), std::move(file),
+                                     dataOffset);
+}
+
+// Create (or overwrite) a file for a histogram with empty bins and open it.
+template <typename T>
+EPHist<T> CreateFileBackedEPHist(const std::string &path,
+                                 const std::vector<AxisVariant> &axes) {
+  const std::string serialized = SerializeAxes(axes);
+  const BinaryHeader header = MakeBinaryHeader(
+      axes.size(), serialized, Detail::Axes(axes).ComputeTotalNumBins(),
+      BinaryBinTypeOf<T>::Value, sizeof(T));
+  CreateEmptyBinaryFile(path, header, serialized);
+  return OpenFileBackedEPHist<T>(path);
+}
+
+// Whether the bins of the histogram live in a file.
+template <typename T> bool IsFileBacked(const EPHist<T> &h) {
+  return BinaryIO<EPHist<T>>::IsExternal(h);
+}
+
+// Write the bins of a file-backed histogram to disk and wait until they are
+// written, for example as a checkpoint of a long-running job. Only the pages
+// modified since the last checkpoint are written. This must not be called
+// concurrently with filling, otherwise the checkpoint may contain some of the
+// concurrent fills but not others.
+template <typename T> void Checkpoint(const EPHist<T> &h) {
+  using IO = BinaryIO<EPHist<T>>;
+  if (!IO::IsExternal(h)) {
+    throw std::invalid_argument("histogram is not file-backed");
+  }
+  const MappedFile &file = *IO::GetFile(h);
+  file.Sync(reinterpret_cast<const char *>(IO::GetData(h)),
+            h.GetTotalNumBins() * sizeof(T));
+}
+
+} // namespace Util
+} // namespace EPHist
+
+#endif
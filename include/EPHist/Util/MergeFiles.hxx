@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_UTIL_MERGEFILES
+#define EPHIST_UTIL_MERGEFILES
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace EPHist {
+namespace Util {
+
+// The number of input files that MergeBinaryFiles maps at the same time and
+// sums in one pass over the output.
+static constexpr std::size_t MergeFilesBatchSize = 16;
+
+// Merge histograms or profiles in the binary format (see BinaryFormat.hxx)
+// into a new output file, without constructing EPHist or Profile objects. The
+// bin content type is taken from the first input, and the other inputs must
+// have the same type and axes, which is checked by comparing the fingerprints
+// of their axes. The inputs are mapped into memory in batches, and the bins
+// are summed in blocks with multiple threads for large histograms (see
+// BulkOperations.hxx, numThreads = 0 selects the number of hardware threads).
+// The memory used does not depend on the number of inputs. The result is
+// written to a temporary file next to the output, which replaces the output
+// only if the merge succeeds. Throws std::invalid_argument if the inputs are
+// not compatible or if the output is one of the inputs.
+void MergeBinaryFiles(const std::vector<std::string> &inputs,
+                      const std::string &output, std::size_t numThreads = 1);
+
+} // namespace Util
+} // namespace EPHist
+
+#endif
@@ -3,11 +3,18 @@
 #ifndef EPHIST_UTIL_RDATAFRAMEHELPER
 #define EPHIST_UTIL_RDATAFRAMEHELPER
 
+#include "../BulkOperations.hxx"
 #include "../EPHist.hxx"
 #include "../ParallelHelper.hxx"
+#include "../Profile.hxx"
 
 #include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <TROOT.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 
 class TTreeReader;
@@ -80,9 +87,42 @@ public:
     fHists[slot]->Fill(values...);
   }
   void Finalize() {
-    auto &res = fHists[0];
-    for (std::size_t i = 1; i < fHists.size(); i++) {
-      res->Add(*fHists[i]);
+    // Pairwise tree reduction: in each step, the histogram of slot i
+    // accumulates the one of slot i + stride, for all i that are multiples of
+    // 2 * stride. The additions of one step are independent and distributed
+    // over multiple threads for large histograms. When there are fewer pairs
+    // than threads, as in the last steps, each addition uses the remaining
+    // threads itself. Consumed histograms are freed immediately to bound the
+    // peak memory usage. With implicit multi-threading, the pairs run as tasks
+    // of ROOT's thread pool and all threads together are limited to its size.
+    const bool implicitMT = ROOT::IsImplicitMTEnabled();
+    const std::size_t maxThreads = implicitMT ? ROOT::GetThreadPoolSize() : 0;
+    const std::size_t numBins = fHists[0]->GetTotalNumBins();
+    const std::size_t numSlots = fHists.size();
+    for (std::size_t stride = 1; stride < numSlots; stride *= 2) {
+      const std::size_t numPairs = (numSlots - stride - 1) / (2 * stride) + 1;
+      const std::size_t numThreads =
+          Internal::GetNumThreads(numPairs * numBins, maxThreads);
+      const std::size_t numPairThreads = std::min(numPairs, numThreads);
+      const std::size_t numAddThreads = numThreads / numPairThreads;
+      auto addPair = [this, stride, numAddThreads](std::size_t p) {
+        const std::size_t i = 2 * stride * p;
+        fHists[i]->Add(*fHists[i + stride], numAddThreads);
+        fHists[i + stride].reset();
+      };
+      if (implicitMT && numPairThreads > 1) {
+        // Zero uses the existing pool without trying to resize it.
+        ROOT::TThreadExecutor executor(0);
+        executor.Foreach(addPair,
+                         ROOT::TSeq<std::size_t>(numPairs), numPairThreads);
+      } else {
+        Internal::RunInChunks(numPairs, numPairThreads,
+                              [&addPair](std::size_t begin, std::size_t end) {
+                                for (std::size_t p = begin; p < end; p++) {
+                                  addPair(p);
+                                }
+                              });
+      }
     }
   }
 
@@ -116,6 +156,45 @@ public:
   std::string GetActionName() const { return "EPHistFillAtomicHelper"; }
 };
 
+template <bool WithError = true>
+class ProfileFillHelper
+    : public ROOT::Detail::RDF::RActionImpl<ProfileFillHelper<WithError>> {
+public:
+  using Result_t = Profile<WithError>;
+
+private:
+  std::shared_ptr<Result_t> fProfile;
+  std::unique_ptr<ParallelHelper<Result_t>> fParallelHelper;
+  std::vector<std::shared_ptr<FillContext<Result_t>>> fFillContexts;
+
+public:
+  template <typename... Args>
+  ProfileFillHelper(unsigned int nSlots, const Args &...args) {
+    fProfile = std::make_shared<Result_t>(args...);
+    fParallelHelper.reset(new ParallelHelper(fProfile));
+    for (unsigned int i = 0; i < nSlots; i++) {
+      fFillContexts.emplace_back(fParallelHelper->CreateFillContext());
+    }
+  }
+  ProfileFillHelper(ProfileFillHelper &&) = default;
+  ProfileFillHelper(const ProfileFillHelper &) = delete;
+  std::shared_ptr<Result_t> GetResultPtr() const { return fProfile; }
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+  template <typename... ColumnTypes>
+  void Exec(unsigned int slot, ColumnTypes... values) {
+    fFillContexts[slot]->Fill(values...);
+  }
+  void Finalize() {
+    for (auto &&context : fFillContexts) {
+      context->Flush();
+    }
+    fParallelHelper->Flush();
+  }
+
+  std::string GetActionName() const { return "ProfileFillHelper"; }
+};
+
 } // namespace Util
 } // namespace EPHist
 
@@ -17,13 +17,61 @@ public:
   using ArgumentType = double;
 
 private:
+  // Up to this number of bins, a linear search is fastest.
+  static constexpr std::size_t MaxBinsLinearSearch = 8;
+  // Starting from this number of bins, build a lookup table to narrow down the
+  // binary search.
+  static constexpr std::size_t MinBinsLookupTable = 64;
+  // The number of cells in the lookup table per bin of the axis.
+  static constexpr std::size_t LookupTableCellsPerBin = 2;
+
   std::vector<double> fBinEdges;
   bool fEnableFlowBins;
 
+  // The lookup table divides the range of the axis into regular cells. For
+  // each cell, it stores the bin that contains the low edge of the cell, so
+  // all arguments in the cell are in the bins [fLookupTable[c],
+  // fLookupTable[c + 1]].
+  std::vector<std::size_t> fLookupTable;
+  double fLookupTableInvCellWidth = 0;
+
+  // Branchless binary search for the bin containing x, which must be in the
+  // range of the bins [begin, end).
+  std::size_t FindBin(double x, std::size_t begin, std::size_t end) const {
+    const double *edges = fBinEdges.data();
+    const double *base = edges + begin;
+    std::size_t length = end - begin;
+    while (length > 1) {
+      const std::size_t half = length / 2;
+      // The compiler generates a conditional move for this expression.
+      base = (base[half] <= x) ? base + half : base;
+      length -= half;
+    }
+    return base - edges;
+  }
+
+  void BuildLookupTable() {
+    const std::size_t numBins = fBinEdges.size() - 1;
+    const std::size_t numCells = numBins * LookupTableCellsPerBin;
+    const double low = fBinEdges.front();
+    const double high = fBinEdges.back();
+    fLookupTableInvCellWidth = numCells / (high - low);
+    fLookupTable.resize(numCells + 1);
+    for (std::size_t c = 0; c < numCells; c++) {
+      const double cellLow = low + c * (high - low) / numCells;
+      fLookupTable[c] = FindBin(cellLow, 0, numBins);
+    }
+    fLookupTable[numCells] = numBins - 1;
+  }
+
 public:
   explicit VariableBinAxis(std::vector<double> binEdges,
                            bool enableFlowBins = true)
-      : fBinEdges(std::move(binEdges)), fEnableFlowBins(enableFlowBins) {}
+      : fBinEdges(std::move(binEdges)), fEnableFlowBins(enableFlowBins) {
+    if (fBinEdges.size() > MinBinsLookupTable) {
+      BuildLookupTable();
+    }
+  }
 
   std::size_t GetNumBins() const { return fBinEdges.size() - 1; }
   std::size_t GetTotalNumBins() const {
@@ -54,16 +102,45 @@ public:
       return {fBinEdges.size(), fEnableFlowBins};
     }
 
-    // FIXME: Optimize with binary search...
     assert(x >= fBinEdges.front());
-    for (std::size_t bin = 0; bin < fBinEdges.size() - 2; bin++) {
-      if (x < fBinEdges[bin + 1]) {
-        return {bin, true};
+    assert(x < fBinEdges.back());
+    const std::size_t numBins = fBinEdges.size() - 1;
+    if (numBins <= MaxBinsLinearSearch) {
+      for (std::size_t bin = 0; bin < numBins - 1; bin++) {
+        if (x < fBinEdges[bin + 1]) {
+          return {bin, true};
+        }
       }
+      return {numBins - 1, true};
+    } else if (fLookupTable.empty()) {
+      return {FindBin(x, 0, numBins), true};
+    }
+
+    const std::size_t numCells = fLookupTable.size() - 1;
+    std::size_t cell = (x - fBinEdges.front()) * fLookupTableInvCellWidth;
+    if (cell >= numCells) {
+      cell = numCells - 1;
+    }
+    std::size_t begin = fLookupTable[cell];
+    std::size_t end = fLookupTable[cell + 1] + 1;
+    // Correct for rounding differences when computing the cell.
+    while (begin > 0 && x < fBinEdges[begin]) {
+      begin--;
+    }
+    while (end < numBins && !(x < fBinEdges[end])) {
+      end++;
+    }
+    return {FindBin(x, begin, end), true};
+  }
+
+  // Compute the bins for n arguments at once; arguments outside of the axis
+  // (and without enabled flow bins) are marked with Internal::InvalidBin.
+  template <typename A>
+  void ComputeBins(const A *x, std::size_t n, std::size_t *bins) const {
+    for (std::size_t i = 0; i < n; i++) {
+      auto bin = ComputeBin(x[i]);
+      bins[i] = bin.second ? bin.first : Internal::InvalidBin;
     }
-    assert(x < fBinEdges.back());
-    std::size_t bin = fBinEdges.size() - 2;
-    return {bin, true};
   }
 
   VariableBinAxis Slice(const BinIndexRange &range) const {
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/Util/BinaryFormat.hxx>
+
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/IntCategoricalAxis.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+enum class AxisKind : std::uint32_t {
+  Regular = 1,
+  VariableBin = 2,
+  Categorical = 3,
+  IntCategorical = 4,
+};
+
+class AxesWriter final {
+  std::string fData;
+
+public:
+  template <typename V> void Write(const V &value) {
+    fData.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+  void Write(const char *data, std::size_t size) { fData.append(data, size); }
+  void Pad(std::size_t alignment) {
+    fData.resize((fData.size() + alignment - 1) / alignment * alignment, '\0');
+  }
+  void WriteAxis(AxisKind kind, bool flowBins, std::size_t count) {
+    Write(static_cast<std::uint32_t>(kind));
+    Write(static_cast<std::uint32_t>(flowBins));
+    Write(static_cast<std::uint64_t>(count));
+  }
+
+  std::string &GetData() { return fData; }
+};
+
+class AxesReader final {
+  const char *fData;
+  std::size_t fSize;
+  std::size_t fOffset = 0;
+
+public:
+  AxesReader(const char *data, std::size_t size) : fData(data), fSize(size) {}
+
+  const char *Read(std::size_t size) {
+    if (size > fSize - fOffset) {
+      throw std::invalid_argument("axes data truncated");
+    }
+    const char *data = fData + fOffset;
+    fOffset += size;
+    return data;
+  }
+  template <typename V> V Read() {
+    V value;
+    std::memcpy(&value, Read(sizeof(V)), sizeof(V));
+    return value;
+  }
+  template <typename V> std::vector<V> ReadVector(std::uint64_t count) {
+    if (count > (fSize - fOffset) / sizeof(V)) {
+      throw std::invalid_argument("axes data truncated");
+    }
+    std::vector<V> values(count);
+    std::memcpy(values.data(), Read(count * sizeof(V)), count * sizeof(V));
+    return values;
+  }
+  void Skip(std::size_t alignment) {
+    const std::size_t padded =
+        (fOffset + alignment - 1) / alignment * alignment;
+    Read(padded - fOffset);
+  }
+};
+
+} // namespace
+
+std::string
+EPHist::Util::SerializeAxes(const std::vector<AxisVariant> &axes) {
+  AxesWriter writer;
+  for (const auto &axis : axes) {
+    if (const auto *regular = std::get_if<RegularAxis>(&axis)) {
+      writer.WriteAxis(AxisKind::Regular, regular->AreFlowBinsEnabled(),
+                       regular->GetNumBins());
+      writer.Write(regular->GetLow());
+      writer.Write(regular->GetHigh());
+    } else if (const auto *variable = std::get_if<VariableBinAxis>(&axis)) {
+      const auto &edges = variable->GetBinEdges();
+      writer.WriteAxis(AxisKind::VariableBin, variable->AreFlowBinsEnabled(),
+                       edges.size());
+      writer.Write(reinterpret_cast<const char *>(edges.data()),
+                   edges.size() * sizeof(double));
+    } else if (const auto *categorical = std::get_if<CategoricalAxis>(&axis)) {
+      const auto &categories = categorical->GetCategories();
+      writer.WriteAxis(AxisKind::Categorical,
+                       categorical->IsOverflowBinEnabled(), categories.size());
+      for (const auto &category : categories) {
+        writer.Write(static_cast<std::uint64_t>(category.size()));
+        writer.Write(category.data(), category.size());
+        writer.Pad(sizeof(std::uint64_t));
+      }
+    } else {
+      const auto &intCategorical = std::get<IntCategoricalAxis>(axis);
+      const auto &categories = intCategorical.GetCategories();
+      writer.WriteAxis(AxisKind::IntCategorical,
+                       intCategorical.IsOverflowBinEnabled(),
+                       categories.size());
+      writer.Write(reinterpret_cast<const char *>(categories.data()),
+                   categories.size() * sizeof(std::int64_t));
+    }
+  }
+  // The header is aligned, so the bins after the axes will be as well.
+  writer.Pad(BinaryAlignment);
+  return std::move(writer.GetData());
+}
+
+std::vector<EPHist::AxisVariant>
+EPHist::Util::DeserializeAxes(const char *data, std::size_t size,
+                              std::size_t numDimensions) {
+  AxesReader reader(data, size);
+  std::vector<AxisVariant> axes;
+  for (std::size_t i = 0; i < numDimensions; i++) {
+    const auto kind = static_cast<AxisKind>(reader.Read<std::uint32_t>());
+    const bool flowBins = reader.Read<std::uint32_t>() != 0;
+    const auto count = reader.Read<std::uint64_t>();
+    switch (kind) {
+    case AxisKind::Regular: {
+      const double low = reader.Read<double>();
+      const double high = reader.Read<double>();
+      axes.emplace_back(RegularAxis(count, low, high, flowBins));
+      break;
+    }
+    case AxisKind::VariableBin:
+      axes.emplace_back(
+          VariableBinAxis(reader.ReadVector<double>(count), flowBins));
+      break;
+    case AxisKind::Categorical: {
+      std::vector<std::string> categories;
+      for (std::uint64_t c = 0; c < count; c++) {
+        const auto length = reader.Read<std::uint64_t>();
+        categories.emplace_back(reader.Read(length), length);
+        reader.Skip(sizeof(std::uint64_t));
+      }
+      axes.emplace_back(CategoricalAxis(std::move(categories), flowBins));
+      break;
+    }
+    case AxisKind::IntCategorical:
+      axes.emplace_back(IntCategoricalAxis(
+          reader.ReadVector<std::int64_t>(count), flowBins));
+      break;
+    default:
+      throw std::invalid_argument("unknown axis kind");
+    }
+  }
+  return axes;
+}
+
+std::uint64_t EPHist::Util::ComputeAxesFingerprint(const std::string &axes) {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for (char c : axes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+EPHist::Util::BinaryHeader EPHist::Util::MakeBinaryHeader(
+    std::size_t numDimensions, const std::string &axes,
+    std::size_t totalNumBins, BinaryBinType binType, std::size_t binSize) {
+  assert(axes.size() % BinaryAlignment == 0);
+  BinaryHeader header;
+  std::memcpy(header.fMagic, BinaryHeader::Magic, sizeof(header.fMagic));
+  header.fVersion = BinaryHeader::CurrentVersion;
+  header.fByteOrder = BinaryHeader::NativeByteOrder;
+  header.fBinType = static_cast<std::uint32_t>(binType);
+  header.fBinSize = binSize;
+  header.fNumDimensions = numDimensions;
+  header.fTotalNumBins = totalNumBins;
+  header.fDataOffset = sizeof(BinaryHeader) + axes.size();
+  header.fDataSize = totalNumBins * binSize;
+  header.fAxesFingerprint = ComputeAxesFingerprint(axes);
+  return header;
+}
+
+void EPHist::Util::CheckBinaryHeader(const BinaryHeader &header,
+                                     BinaryBinType binType,
+                                     std::size_t binSize,
+                                     std::size_t fileSize, bool compressed) {
+  const char *magic =
+      compressed ? BinaryHeader::CompressedMagic : BinaryHeader::Magic;
+  if (std::memcmp(header.fMagic, magic, sizeof(header.fMagic))) {
+    throw std::invalid_argument(compressed
+                                    ? "not in the compressed binary format"
+                                    : "not in the binary format");
+  }
+  if (header.fVersion != BinaryHeader::CurrentVersion) {
+    throw std::invalid_argument("unsupported version of the binary format");
+  }
+  if (header.fByteOrder != BinaryHeader::NativeByteOrder) {
+    throw std::invalid_argument("byte order not supported");
+  }
+  if (header.fBinType != static_cast<std::uint32_t>(binType) ||
+      header.fBinSize != binSize) {
+    throw std::invalid_argument("bin content type does not match");
+  }
+  if (header.fDataOffset < sizeof(BinaryHeader) ||
+      header.fDataOffset % BinaryAlignment != 0) {
+    throw std::invalid_argument("invalid offset of bin contents");
+  }
+  // Every axis takes at least its kind, the flag for flow bins and the number
+  // of values, see SerializeAxes.
+  const std::size_t axesSize = header.fDataOffset - sizeof(BinaryHeader);
+  static constexpr std::size_t MinAxisSize =
+      2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+  if (axesSize > BinaryMaxAxesSize) {
+    throw std::invalid_argument("invalid size of axes");
+  }
+  if (header.fNumDimensions == 0 ||
+      header.fNumDimensions > axesSize / MinAxisSize) {
+    throw std::invalid_argument("invalid number of dimensions");
+  }
+  if (header.fTotalNumBins > SIZE_MAX / binSize ||
+      header.fDataSize != header.fTotalNumBins * binSize) {
+    throw std::invalid_argument("invalid size of bin contents");
+  }
+  if (fileSize != 0 && (header.fDataOffset > fileSize ||
+                        header.fDataSize > fileSize - header.fDataOffset)) {
+    throw std::invalid_argument("file truncated");
+  }
+}
+
+const EPHist::Util::BinaryHeader &
+EPHist::Util::GetBinaryHeader(const MappedFile &file, BinaryBinType binType,
+                              std::size_t binSize) {
+  if (file.GetSize() < sizeof(BinaryHeader)) {
+    throw std::invalid_argument("file too small for header");
+  }
+  const auto &header = *reinterpret_cast<const BinaryHeader *>(file.GetData());
+  CheckBinaryHeader(header, binType, binSize, file.GetSize());
+  return header;
+}
+
+std::vector<EPHist::AxisVariant>
+EPHist::Util::DeserializeAxes(const MappedFile &file,
+                              const BinaryHeader &header) {
+  return DeserializeAxes(file.GetData() + sizeof(BinaryHeader),
+                         header.fDataOffset - sizeof(BinaryHeader),
+                         header.fNumDimensions);
+}
+
+EPHist::Util::MappedFile::MappedFile(const std::string &path, bool writable)
+    : fWritable(writable) {
+  const int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("could not open " + path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    throw std::runtime_error("could not map " + path);
+  }
+  const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void *data = mmap(nullptr, st.st_size, prot, MAP_SHARED, fd, 0);
+  // The mapping stays valid after closing the file descriptor.
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("could not map " + path);
+  }
+  fData = static_cast<char *>(data);
+  fSize = st.st_size;
+}
+
+EPHist::Util::MappedFile::~MappedFile() { munmap(fData, fSize); }
+
+void EPHist::Util::MappedFile::Sync(const char *begin, std::size_t size) const {
+  assert(begin >= fData && begin + size <= fData + fSize);
+  // msync requires the address to be aligned to a page.
+  const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+  const std::size_t offset = (begin - fData) / pageSize * pageSize;
+  const std::size_t end = begin - fData + size;
+  if (msync(fData + offset, end - offset, MS_SYNC) != 0) {
+    throw std::runtime_error("could not sync mapped file");
+  }
+}
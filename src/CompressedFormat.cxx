@@ -0,0 +1,552 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/Util/CompressedFormat.hxx>
+
+#include <EPHist/BulkOperations.hxx>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using EPHist::Util::CompressedBlock;
+using EPHist::Util::CompressedEncoding;
+
+void PutVarint(std::string &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+std::uint64_t ZigZag(std::uint64_t d) {
+  const std::int64_t sign = static_cast<std::int64_t>(d) >> 63;
+  return (d << 1) ^ static_cast<std::uint64_t>(sign);
+}
+
+std::uint64_t UnZigZag(std::uint64_t z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+// Reads from an encoded block, throwing if it is corrupt.
+class BlockReader final {
+  const unsigned char *fPos;
+  const unsigned char *fEnd;
+
+public:
+  BlockReader(const char *data, std::size_t size)
+      : fPos(reinterpret_cast<const unsigned char *>(data)),
+        fEnd(fPos + size) {}
+
+  bool AtEnd() const { return fPos == fEnd; }
+
+  std::uint64_t Varint() {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (fPos == fEnd) {
+        throw std::invalid_argument("corrupt compressed block");
+      }
+      const unsigned char byte = *fPos++;
+      v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return v;
+      }
+    }
+    throw std::invalid_argument("corrupt compressed block");
+  }
+
+  // Return a pointer to the next n bytes and skip them.
+  const char *Take(std::size_t n) {
+    if (n > static_cast<std::size_t>(fEnd - fPos)) {
+      throw std::invalid_argument("corrupt compressed block");
+    }
+    const char *data = reinterpret_cast<const char *>(fPos);
+    fPos += n;
+    return data;
+  }
+
+  void Copy(char *dst, std::size_t n) { std::memcpy(dst, Take(n), n); }
+};
+
+// Load a word of 4 or 8 bytes as a sign-extended integer.
+std::int64_t LoadWord(const char *data, std::size_t wordSize) {
+  if (wordSize == sizeof(std::int32_t)) {
+    std::int32_t v;
+    std::memcpy(&v, data, sizeof(v));
+    return v;
+  }
+  std::int64_t v;
+  std::memcpy(&v, data, sizeof(v));
+  return v;
+}
+
+void StoreWord(char *data, std::size_t wordSize, std::int64_t v) {
+  if (wordSize == sizeof(std::int32_t)) {
+    const auto v32 = static_cast<std::int32_t>(v);
+    std::memcpy(data, &v32, sizeof(v32));
+  } else {
+    std::memcpy(data, &v, sizeof(v));
+  }
+}
+
+bool IsZeroWord(const char *data, std::size_t wordSize) {
+  return LoadWord(data, wordSize) == 0;
+}
+
+bool IsZero(const char *data, std::size_t size) {
+  return std::all_of(data, data + size, [](char c) { return c == 0; });
+}
+
+// Split the words into alternating runs of zero and non-zero words. The
+// control stream stores the lengths of each pair of runs as varints, and the
+// non-zero words are gathered in literals.
+void SplitZeroRuns(const char *data, std::size_t size, std::size_t wordSize,
+                   std::string &control, std::string &literals) {
+  const std::size_t numWords = size / wordSize;
+  control.clear();
+  literals.clear();
+  std::size_t i = 0;
+  while (i < numWords) {
+    const std::size_t zeroBegin = i;
+    while (i < numWords && IsZeroWord(data + i * wordSize, wordSize)) {
+      i++;
+    }
+    const std::size_t literalBegin = i;
+    while (i < numWords && !IsZeroWord(data + i * wordSize, wordSize)) {
+      i++;
+    }
+    PutVarint(control, literalBegin - zeroBegin);
+    PutVarint(control, i - literalBegin);
+    literals.append(data + literalBegin * wordSize,
+                    (i - literalBegin) * wordSize);
+  }
+}
+
+// Validate the control stream of SplitZeroRuns and return the number of
+// non-zero words.
+std::size_t CountLiteralWords(const char *control, std::size_t controlSize,
+                              std::size_t numWords) {
+  BlockReader reader(control, controlSize);
+  std::size_t i = 0;
+  std::size_t literals = 0;
+  while (i < numWords) {
+    const std::uint64_t zeros = reader.Varint();
+    if (zeros > numWords - i) {
+      throw std::invalid_argument("corrupt compressed block");
+    }
+    i += zeros;
+    const std::uint64_t n = reader.Varint();
+    if (n > numWords - i) {
+      throw std::invalid_argument("corrupt compressed block");
+    }
+    i += n;
+    literals += n;
+  }
+  if (!reader.AtEnd()) {
+    throw std::invalid_argument("corrupt compressed block");
+  }
+  return literals;
+}
+
+// The inverse of SplitZeroRuns, for a control stream that was validated with
+// CountLiteralWords.
+void ExpandZeroRuns(const char *control, std::size_t controlSize,
+                    const char *literals, char *data, std::size_t size,
+                    std::size_t wordSize) {
+  BlockReader reader(control, controlSize);
+  const std::size_t numWords = size / wordSize;
+  std::size_t i = 0;
+  while (i < numWords) {
+    const std::size_t zeros = reader.Varint();
+    std::memset(data + i * wordSize, 0, zeros * wordSize);
+    i += zeros;
+    const std::size_t n = reader.Varint();
+    std::memcpy(data + i * wordSize, literals, n * wordSize);
+    literals += n * wordSize;
+    i += n;
+  }
+}
+
+std::string EncodeVarintDelta(const char *data, std::size_t size,
+                              std::size_t wordSize) {
+  const std::size_t numWords = size / wordSize;
+  std::string out;
+  std::int64_t previous = 0;
+  std::size_t i = 0;
+  while (i < numWords) {
+    const std::int64_t value = LoadWord(data + i * wordSize, wordSize);
+    const std::uint64_t delta = static_cast<std::uint64_t>(value) -
+                                static_cast<std::uint64_t>(previous);
+    i++;
+    PutVarint(out, ZigZag(delta));
+    if (delta == 0) {
+      const std::size_t begin = i;
+      while (i < numWords && LoadWord(data + i * wordSize, wordSize) == value) {
+        i++;
+      }
+      PutVarint(out, i - begin);
+    }
+    previous = value;
+  }
+  return out;
+}
+
+void DecodeVarintDelta(BlockReader &reader, char *data, std::size_t size,
+                       std::size_t wordSize) {
+  const std::size_t numWords = size / wordSize;
+  std::uint64_t value = 0;
+  std::size_t i = 0;
+  while (i < numWords) {
+    const std::uint64_t delta = UnZigZag(reader.Varint());
+    value += delta;
+    std::uint64_t repetitions = 1;
+    if (delta == 0) {
+      repetitions += reader.Varint();
+      if (repetitions == 0 || repetitions > numWords - i) {
+        throw std::invalid_argument("corrupt compressed block");
+      }
+    }
+    for (std::uint64_t r = 0; r < repetitions; r++, i++) {
+      StoreWord(data + i * wordSize, wordSize,
+                static_cast<std::int64_t>(value));
+    }
+  }
+}
+
+template <std::size_t WordSize>
+void ShuffleWords(const char *data, std::size_t numWords, char *out) {
+  for (std::size_t i = 0; i < numWords; i++) {
+    for (std::size_t b = 0; b < WordSize; b++) {
+      out[b * numWords + i] = data[i * WordSize + b];
+    }
+  }
+}
+
+template <std::size_t WordSize>
+void UnshuffleWords(const char *data, std::size_t numWords, char *out) {
+  for (std::size_t i = 0; i < numWords; i++) {
+    for (std::size_t b = 0; b < WordSize; b++) {
+      out[i * WordSize + b] = data[b * numWords + i];
+    }
+  }
+}
+
+void Shuffle(const char *data, std::size_t size, std::size_t wordSize,
+             char *out) {
+  if (wordSize == sizeof(std::uint32_t)) {
+    ShuffleWords<sizeof(std::uint32_t)>(data, size / wordSize, out);
+  } else {
+    ShuffleWords<sizeof(std::uint64_t)>(data, size / wordSize, out);
+  }
+}
+
+void Unshuffle(const char *data, std::size_t size, std::size_t wordSize,
+               char *out) {
+  if (wordSize == sizeof(std::uint32_t)) {
+    UnshuffleWords<sizeof(std::uint32_t)>(data, size / wordSize, out);
+  } else {
+    UnshuffleWords<sizeof(std::uint64_t)>(data, size / wordSize, out);
+  }
+}
+
+// The LZ-style compression stores sequences of a varint for the number of
+// literal bytes, the literal bytes, and (unless the end is reached) varints
+// for the length of the match minus LZMinMatch and its offset back into the
+// decompressed bytes. Matches are found with a hash table of positions.
+static constexpr std::size_t LZMinMatch = 4;
+static constexpr unsigned LZHashBits = 14;
+static constexpr std::uint32_t LZNoPosition = UINT32_MAX;
+
+std::string EncodeLZ(const char *data, std::size_t size,
+                     std::vector<std::uint32_t> &table) {
+  assert(size <= LZNoPosition);
+  table.assign(std::size_t(1) << LZHashBits, LZNoPosition);
+  std::string out;
+  std::size_t anchor = 0;
+  std::size_t i = 0;
+  while (i + LZMinMatch <= size) {
+    std::uint32_t sequence;
+    std::memcpy(&sequence, data + i, sizeof(sequence));
+    const std::uint32_t hash = (sequence * 2654435761u) >> (32 - LZHashBits);
+    const std::uint32_t candidate = table[hash];
+    table[hash] = i;
+    if (candidate == LZNoPosition ||
+        std::memcmp(data + candidate, data + i, LZMinMatch) != 0) {
+      i++;
+      continue;
+    }
+    // Extend the match eight bytes at a time, then byte by byte.
+    std::size_t length = LZMinMatch;
+    while (i + length + sizeof(std::uint64_t) <= size) {
+      std::uint64_t a, b;
+      std::memcpy(&a, data + candidate + length, sizeof(a));
+      std::memcpy(&b, data + i + length, sizeof(b));
+      if (a != b) {
+        break;
+      }
+      length += sizeof(std::uint64_t);
+    }
+    while (i + length < size && data[candidate + length] == data[i + length]) {
+      length++;
+    }
+    PutVarint(out, i - anchor);
+    out.append(data + anchor, i - anchor);
+    PutVarint(out, length - LZMinMatch);
+    PutVarint(out, i - candidate);
+    i += length;
+    anchor = i;
+  }
+  if (anchor < size) {
+    PutVarint(out, size - anchor);
+    out.append(data + anchor, size - anchor);
+  }
+  return out;
+}
+
+void DecodeLZ(BlockReader &reader, char *data, std::size_t size) {
+  std::size_t i = 0;
+  while (i < size) {
+    const std::uint64_t literals = reader.Varint();
+    if (literals > size - i) {
+      throw std::invalid_argument("corrupt compressed block");
+    }
+    reader.Copy(data + i, literals);
+    i += literals;
+    if (i == size) {
+      break;
+    }
+    const std::uint64_t length = reader.Varint();
+    const std::uint64_t offset = reader.Varint();
+    if (size - i < LZMinMatch || length > size - i - LZMinMatch ||
+        offset == 0 || offset > i) {
+      throw std::invalid_argument("corrupt compressed block");
+    }
+    // Byte by byte, because the match may overlap the bytes being written.
+    for (std::size_t j = 0; j < length + LZMinMatch; j++, i++) {
+      data[i] = data[i - offset];
+    }
+  }
+}
+
+// Scratch memory of one thread, reused for all of its blocks.
+struct Scratch {
+  std::string fControl;
+  std::string fLiterals;
+  std::string fShuffled;
+  std::vector<std::uint32_t> fTable;
+};
+
+// Encode a block with the encoding that results in the smallest size. For
+// Raw and Zero, the returned string is empty.
+CompressedEncoding EncodeBlock(const char *data, std::size_t size,
+                               std::size_t wordSize, bool integer,
+                               Scratch &scratch, std::string &out) {
+  out.clear();
+  if (IsZero(data, size)) {
+    return CompressedEncoding::Zero;
+  }
+  CompressedEncoding best = CompressedEncoding::Raw;
+  std::size_t bestSize = size;
+  auto consider = [&](CompressedEncoding encoding, std::string encoded) {
+    if (encoded.size() < bestSize) {
+      best = encoding;
+      bestSize = encoded.size();
+      out = std::move(encoded);
+    }
+  };
+
+  // ZeroRuns and ShuffleLZ both start with the control stream of the zero
+  // runs, so the LZ-style compression only has to look at non-zero words.
+  SplitZeroRuns(data, size, wordSize, scratch.fControl, scratch.fLiterals);
+  std::string encoded;
+  PutVarint(encoded, scratch.fControl.size());
+  encoded += scratch.fControl;
+  if (integer) {
+    consider(CompressedEncoding::VarintDelta,
+             EncodeVarintDelta(data, size, wordSize));
+  } else {
+    const std::size_t literalsSize = scratch.fLiterals.size();
+    scratch.fShuffled.resize(literalsSize);
+    Shuffle(scratch.fLiterals.data(), literalsSize, wordSize,
+            scratch.fShuffled.data());
+    std::string lz = encoded;
+    lz += EncodeLZ(scratch.fShuffled.data(), literalsSize, scratch.fTable);
+    consider(CompressedEncoding::ShuffleLZ, std::move(lz));
+  }
+  if (encoded.size() + scratch.fLiterals.size() < bestSize) {
+    encoded += scratch.fLiterals;
+    consider(CompressedEncoding::ZeroRuns, std::move(encoded));
+  }
+  if (best == CompressedEncoding::Raw) {
+    out.clear();
+  }
+  return best;
+}
+
+void DecodeBlock(CompressedEncoding encoding, const char *encoded,
+                 std::size_t encodedSize, char *data, std::size_t size,
+                 std::size_t wordSize, Scratch &scratch) {
+  BlockReader reader(encoded, encodedSize);
+  switch (encoding) {
+  case CompressedEncoding::Raw:
+    reader.Copy(data, size);
+    break;
+  case CompressedEncoding::Zero:
+    std::memset(data, 0, size);
+    break;
+  case CompressedEncoding::ZeroRuns:
+  case CompressedEncoding::ShuffleLZ: {
+    const std::size_t controlSize = reader.Varint();
+    const char *control = reader.Take(controlSize);
+    const std::size_t literalsSize =
+        CountLiteralWords(control, controlSize, size / wordSize) * wordSize;
+    const char *literals;
+    if (encoding == CompressedEncoding::ZeroRuns) {
+      literals = reader.Take(literalsSize);
+    } else {
+      scratch.fShuffled.resize(literalsSize);
+      DecodeLZ(reader, scratch.fShuffled.data(), literalsSize);
+      scratch.fLiterals.resize(literalsSize);
+      Unshuffle(scratch.fShuffled.data(), literalsSize, wordSize,
+                scratch.fLiterals.data());
+      literals = scratch.fLiterals.data();
+    }
+    ExpandZeroRuns(control, controlSize, literals, data, size, wordSize);
+    break;
+  }
+  case CompressedEncoding::VarintDelta:
+    DecodeVarintDelta(reader, data, size, wordSize);
+    break;
+  default:
+    throw std::invalid_argument("unknown encoding of compressed block");
+  }
+  if (!reader.AtEnd()) {
+    throw std::invalid_argument("corrupt compressed block");
+  }
+}
+
+// Call f(begin, end) for chunks of the blocks in parallel, and rethrow the
+// first exception from any of the threads.
+template <typename F>
+void ForEachBlockChunk(std::size_t numBlocks, std::size_t numWords,
+                       std::size_t numThreads, F &&f) {
+  std::exception_ptr exception;
+  std::mutex mutex;
+  // Decide the number of threads based on the number of words, see
+  // BulkOperations.hxx, but never use more threads than blocks.
+  numThreads = std::min(EPHist::Internal::GetNumThreads(numWords, numThreads),
+                        std::max<std::size_t>(1, numBlocks));
+  EPHist::Internal::RunInChunks(
+      numBlocks, numThreads, [&](std::size_t begin, std::size_t end) {
+        try {
+          f(begin, end);
+        } catch (...) {
+          std::lock_guard lock(mutex);
+          if (!exception) {
+            exception = std::current_exception();
+          }
+        }
+      });
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+} // namespace
+
+void EPHist::Util::WriteCompressedData(const char *data, std::size_t size,
+                                       std::size_t wordSize, bool integer,
+                                       std::ostream &os,
+                                       std::size_t numThreads) {
+  assert(wordSize == 4 || wordSize == 8);
+  assert(size % wordSize == 0);
+  const std::uint64_t blockSize = CompressedBlockSize;
+  const std::uint64_t numBlocks = (size + blockSize - 1) / blockSize;
+
+  std::vector<CompressedBlock> blocks(numBlocks);
+  std::vector<std::string> encoded(numBlocks);
+  ForEachBlockChunk(
+      numBlocks, size / wordSize, numThreads,
+      [&](std::size_t begin, std::size_t end) {
+        Scratch scratch;
+        for (std::size_t b = begin; b < end; b++) {
+          const std::size_t offset = b * blockSize;
+          const std::size_t n = std::min<std::size_t>(size - offset, blockSize);
+          const CompressedEncoding encoding = EncodeBlock(
+              data + offset, n, wordSize, integer, scratch, encoded[b]);
+          blocks[b].fEncoding = static_cast<std::uint32_t>(encoding);
+          blocks[b].fReserved = 0;
+          blocks[b].fSize =
+              encoding == CompressedEncoding::Raw ? n : encoded[b].size();
+        }
+      });
+
+  os.write(reinterpret_cast<const char *>(&blockSize), sizeof(blockSize));
+  os.write(reinterpret_cast<const char *>(&numBlocks), sizeof(numBlocks));
+  os.write(reinterpret_cast<const char *>(blocks.data()),
+           numBlocks * sizeof(CompressedBlock));
+  for (std::size_t b = 0; b < numBlocks; b++) {
+    if (blocks[b].fEncoding ==
+        static_cast<std::uint32_t>(CompressedEncoding::Raw)) {
+      os.write(data + b * blockSize, blocks[b].fSize);
+    } else {
+      os.write(encoded[b].data(), encoded[b].size());
+    }
+  }
+}
+
+void EPHist::Util::ReadCompressedData(std::istream &is, char *data,
+                                      std::size_t size, std::size_t wordSize,
+                                      std::size_t numThreads) {
+  assert(wordSize == 4 || wordSize == 8);
+  std::uint64_t blockSize, numBlocks;
+  if (!is.read(reinterpret_cast<char *>(&blockSize), sizeof(blockSize)) ||
+      !is.read(reinterpret_cast<char *>(&numBlocks), sizeof(numBlocks))) {
+    throw std::invalid_argument("could not read compressed bins");
+  }
+  // The block size is fixed by the format; accepting any other value would let
+  // a corrupt file choose the size of the allocations below.
+  if (blockSize != CompressedBlockSize ||
+      numBlocks != size / blockSize + (size % blockSize != 0)) {
+    throw std::invalid_argument("invalid blocks of compressed bins");
+  }
+
+  std::vector<CompressedBlock> blocks(numBlocks);
+  if (!is.read(reinterpret_cast<char *>(blocks.data()),
+               numBlocks * sizeof(CompressedBlock))) {
+    throw std::invalid_argument("could not read compressed bins");
+  }
+  // No block is larger than its uncompressed bins, which also bounds the
+  // total size that is read.
+  std::vector<std::size_t> offsets(numBlocks + 1, 0);
+  for (std::size_t b = 0; b < numBlocks; b++) {
+    if (blocks[b].fSize > blockSize) {
+      throw std::invalid_argument("invalid blocks of compressed bins");
+    }
+    offsets[b + 1] = offsets[b] + blocks[b].fSize;
+  }
+  std::string encoded(offsets[numBlocks], '\0');
+  if (!is.read(encoded.data(), encoded.size())) {
+    throw std::invalid_argument("could not read compressed bins");
+  }
+
+  ForEachBlockChunk(
+      numBlocks, size / wordSize, numThreads,
+      [&](std::size_t begin, std::size_t end) {
+        Scratch scratch;
+        for (std::size_t b = begin; b < end; b++) {
+          const std::size_t offset = b * blockSize;
+          const std::size_t n = std::min<std::size_t>(size - offset, blockSize);
+          const auto encoding =
+              static_cast<CompressedEncoding>(blocks[b].fEncoding);
+          DecodeBlock(encoding, encoded.data() + offsets[b], blocks[b].fSize,
+                      data + offset, n, wordSize, scratch);
+        }
+      });
+}
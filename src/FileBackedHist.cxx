@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/Util/FileBackedHist.hxx>
+
+#include <EPHist/Util/BinaryFormat.hxx>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Write all of the data, continuing after short writes.
+bool WriteAll(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+} // namespace
+
+void EPHist::Util::CreateEmptyBinaryFile(const std::string &path,
+                                         const BinaryHeader &header,
+                                         const std::string &axes) {
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    throw std::runtime_error("could not create " + path);
+  }
+  const bool ok =
+      WriteAll(fd, reinterpret_cast<const char *>(&header), sizeof(header)) &&
+      WriteAll(fd, axes.data(), axes.size()) &&
+      ftruncate(fd, header.fDataOffset + header.fDataSize) == 0;
+  close(fd);
+  if (!ok) {
+    throw std::runtime_error("could not write " + path);
+  }
+}
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/Util/MergeFiles.hxx>
+
+#include <EPHist/AlignedDoubleBinWithError.hxx>
+#include <EPHist/BulkOperations.hxx>
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/FixedPointBin.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/Util/BinaryFormat.hxx>
+#include <EPHist/Util/FileBackedHist.hxx>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace EPHist::Util;
+
+// Get the device and inode of a file, to detect different paths to the same
+// file. Returns false if the file does not exist.
+bool GetFileId(const std::string &path, std::pair<dev_t, ino_t> &id) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    if (errno == ENOENT) {
+      return false;
+    }
+    throw std::runtime_error("could not stat " + path);
+  }
+  id = {st.st_dev, st.st_ino};
+  return true;
+}
+
+template <typename T>
+void MergeBins(const std::vector<std::string> &inputs,
+               const std::string &output, std::size_t numThreads) {
+  // The number of bins summed from all inputs of a batch before moving on to
+  // the next block, so that the block of the output stays in the cache.
+  static constexpr std::size_t BlockSize =
+      std::max<std::size_t>(1, 16 * 1024 / sizeof(T));
+  static constexpr BinaryBinType BinType = BinaryBinTypeOf<T>::Value;
+
+  // Create the output with the header and the axes of the first input.
+  BinaryHeader header;
+  std::string axes;
+  {
+    MappedFile first(inputs[0]);
+    header = GetBinaryHeader(first, BinType, sizeof(T));
+    axes.assign(first.GetData() + sizeof(BinaryHeader),
+                header.fDataOffset - sizeof(BinaryHeader));
+  }
+  CreateEmptyBinaryFile(output, header, axes);
+  MappedFile out(output, /*writable=*/true);
+  T *dst = reinterpret_cast<T *>(out.GetWritableData() + header.fDataOffset);
+  const std::size_t numBins = header.fTotalNumBins;
+
+  for (std::size_t i = 0; i < inputs.size(); i += MergeFilesBatchSize) {
+    const std::size_t last = std::min(inputs.size(), i + MergeFilesBatchSize);
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<const T *> srcs;
+    for (std::size_t j = i; j < last; j++) {
+      files.emplace_back(new MappedFile(inputs[j]));
+      const BinaryHeader &h =
+          GetBinaryHeader(*files.back(), BinType, sizeof(T));
+      if (h.fAxesFingerprint != header.fAxesFingerprint ||
+          h.fDataOffset != header.fDataOffset ||
+          h.fTotalNumBins != header.fTotalNumBins) {
+        throw std::invalid_argument("axes configuration not identical: " +
+                                    inputs[j]);
+      }
+      srcs.push_back(reinterpret_cast<const T *>(files.back()->GetData() +
+                                                 h.fDataOffset));
+    }
+
+    EPHist::Internal::ForEachChunk(
+        numBins, numThreads, [&](std::size_t begin, std::size_t end) {
+          for (std::size_t block = begin; block < end; block += BlockSize) {
+            const std::size_t n = std::min(end - block, BlockSize);
+            for (const T *src : srcs) {
+              EPHist::Internal::AddArray(dst + block, src + block, n);
+            }
+          }
+        });
+  }
+}
+
+void MergeByBinType(const std::vector<std::string> &inputs,
+                    const std::string &output, std::size_t numThreads,
+                    BinaryBinType binType) {
+  switch (binType) {
+  case BinaryBinType::Int:
+    MergeBins<int>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::Long:
+    MergeBins<long>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::LongLong:
+    MergeBins<long long>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::Float:
+    MergeBins<float>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::Double:
+    MergeBins<double>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::DoubleBinWithError:
+    MergeBins<EPHist::DoubleBinWithError>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::AlignedDoubleBinWithError:
+    MergeBins<EPHist::AlignedDoubleBinWithError>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::FixedPointBin:
+    MergeBins<EPHist::FixedPointBin>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::ProfileDoubleBin:
+    MergeBins<EPHist::Profile<false>::DoubleBin>(inputs, output, numThreads);
+    break;
+  case BinaryBinType::ProfileDoubleBinWithError:
+    MergeBins<EPHist::Profile<true>::DoubleBinWithError>(inputs, output,
+                                                         numThreads);
+    break;
+  default:
+    throw std::invalid_argument("unknown bin content type: " + inputs[0]);
+  }
+}
+
+} // namespace
+
+void EPHist::Util::MergeBinaryFiles(const std::vector<std::string> &inputs,
+                                    const std::string &output,
+                                    std::size_t numThreads) {
+  if (inputs.empty()) {
+    throw std::invalid_argument("no input files");
+  }
+  // Compare the files instead of the paths, which may differ for the same
+  // file, for example with symbolic or hard links.
+  std::pair<dev_t, ino_t> outputId;
+  if (GetFileId(output, outputId)) {
+    for (const auto &input : inputs) {
+      std::pair<dev_t, ino_t> inputId;
+      if (GetFileId(input, inputId) && inputId == outputId) {
+        throw std::invalid_argument("output is also an input: " + output);
+      }
+    }
+  }
+
+  BinaryBinType binType;
+  {
+    MappedFile first(inputs[0]);
+    if (first.GetSize() < sizeof(BinaryHeader)) {
+      throw std::invalid_argument("file too small for header: " + inputs[0]);
+    }
+    const auto &header =
+        *reinterpret_cast<const BinaryHeader *>(first.GetData());
+    binType = static_cast<BinaryBinType>(header.fBinType);
+  }
+
+  // Merge into a temporary file in the directory of the output, and only
+  // replace the output if the merge succeeded.
+  const std::string temporary = output + ".tmp" + std::to_string(getpid());
+  try {
+    MergeByBinType(inputs, temporary, numThreads, binType);
+    if (rename(temporary.c_str(), output.c_str()) != 0) {
+      throw std::runtime_error("could not rename to " + output);
+    }
+  } catch (...) {
+    unlink(temporary.c_str());
+    throw;
+  }
+}
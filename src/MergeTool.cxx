@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// ephist-merge: merge histograms in the binary format, similar to hadd.
+//
+// Usage: ephist-merge [-j N] output input...
+
+#include <EPHist/Util/MergeFiles.hxx>
+
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static int Usage(const char *name) {
+  std::cerr << "Usage: " << name << " [-j N] output input...\n"
+            << "  -j N  use N threads to sum the bins (0: all cores)\n";
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t numThreads = 1;
+  int arg = 1;
+  if (arg < argc && std::string(argv[arg]) == "-j") {
+    if (arg + 1 >= argc) {
+      return Usage(argv[0]);
+    }
+    const char *value = argv[arg + 1];
+    char *end;
+    errno = 0;
+    numThreads = std::strtoul(value, &end, 10);
+    // strtoul skips whitespace and accepts a sign, so check the first digit.
+    if (!std::isdigit(static_cast<unsigned char>(value[0])) || *end != '\0' ||
+        errno == ERANGE) {
+      std::cerr << argv[0] << ": invalid number of threads: " << value << "\n";
+      return Usage(argv[0]);
+    }
+    arg += 2;
+  }
+  if (argc - arg < 2) {
+    return Usage(argv[0]);
+  }
+
+  const std::string output = argv[arg];
+  const std::vector<std::string> inputs(argv + arg + 1, argv + argc);
+  try {
+    EPHist::Util::MergeBinaryFiles(inputs, output, numThreads);
+  } catch (const std::exception &e) {
+    std::cerr << argv[0] << ": " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
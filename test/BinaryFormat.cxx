@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/FixedPointBin.hxx>
+#include <EPHist/IntCategoricalAxis.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/Util/BinaryFormat.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+#include <EPHist/Weight.hxx>
+
+#include "TemporaryFile.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::vector<EPHist::AxisVariant> CreateAxes() {
+  EPHist::RegularAxis regular(10, 0, 10, /*enableFlowBins=*/false);
+  EPHist::VariableBinAxis variable({0, 1, 2.5, 4});
+  EPHist::CategoricalAxis categorical(
+      std::vector<std::string>{"a", "bc", "a long category"});
+  EPHist::IntCategoricalAxis intCategorical(std::vector<std::int64_t>{-1, 42},
+                                            /*enableOverflowBin=*/false);
+  return {regular, variable, categorical, intCategorical};
+}
+
+TEST(BinaryFormat, Axes) {
+  const auto axes = CreateAxes();
+  const std::string data = EPHist::Util::SerializeAxes(axes);
+  EXPECT_EQ(data.size() % EPHist::Util::BinaryAlignment, 0);
+
+  const auto read =
+      EPHist::Util::DeserializeAxes(data.data(), data.size(), axes.size());
+  EXPECT_EQ(read, axes);
+
+  EXPECT_THROW(EPHist::Util::DeserializeAxes(data.data(), 32, axes.size()),
+               std::invalid_argument);
+}
+
+TEST(BinaryFormat, IntStream) {
+  EPHist::EPHist<int> h(CreateAxes());
+  h.Fill(1, 0.5, "bc", 42);
+  h.Fill(9, 3, "other", -1);
+  h.Fill(9, 3, "other", -1);
+
+  std::stringstream ss;
+  EPHist::Util::WriteBinary(h, ss);
+  auto read = EPHist::Util::ReadBinary<EPHist::EPHist<int>>(ss);
+  EXPECT_EQ(read.GetAxes(), h.GetAxes());
+  ASSERT_EQ(read.GetTotalNumBins(), h.GetTotalNumBins());
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    EXPECT_EQ(read.GetBinContent(i), h.GetBinContent(i));
+  }
+  EXPECT_EQ(read.GetBinContentAt(9, 2, EPHist::BinIndex::Overflow(), 0), 2);
+}
+
+TEST(BinaryFormat, DoubleBinWithErrorStream) {
+  EPHist::EPHist<EPHist::DoubleBinWithError> h(20, 0, 20);
+  for (std::size_t i = 0; i < 20; i++) {
+    h.Fill(i, EPHist::Weight(0.5 + i));
+  }
+
+  std::stringstream ss;
+  EPHist::Util::WriteBinary(h, ss);
+  auto read =
+      EPHist::Util::ReadBinary<EPHist::EPHist<EPHist::DoubleBinWithError>>(ss);
+  for (std::size_t i = 0; i < 20; i++) {
+    EXPECT_EQ(read.GetBinContent(i).fSum, 0.5 + i);
+    EXPECT_EQ(read.GetBinContent(i).fSum2, (0.5 + i) * (0.5 + i));
+  }
+}
+
+TEST(BinaryFormat, View) {
+  EPHist::EPHist<double> h(CreateAxes());
+  h.Fill(1, 0.5, "bc", 42, EPHist::Weight(0.25));
+  h.Fill(9, -1, "a", 42);
+
+  TemporaryFile file("BinaryFormat_View.bin");
+  file.Write(h);
+
+  EPHist::Util::EPHistView<double> view(file.GetPath());
+  EXPECT_EQ(view.GetAxes(), h.GetAxes());
+  EXPECT_EQ(view.GetNumDimensions(), 4);
+  ASSERT_EQ(view.GetTotalNumBins(), h.GetTotalNumBins());
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    EXPECT_EQ(view.GetBinContent(i), h.GetBinContent(i));
+  }
+  EXPECT_EQ(view.GetBinContentAt(1, 0, 1, 1), 0.25);
+  EXPECT_EQ(view.GetBinContentAt(9, EPHist::BinIndex::Underflow(), 0, 1), 1);
+  EXPECT_THROW(view.GetBinContentAt(1), std::invalid_argument);
+  // The bins are used in place, at an aligned offset in the mapped file.
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.GetData()) %
+                EPHist::Util::BinaryAlignment,
+            0);
+
+  auto copy = view.ToHist();
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    EXPECT_EQ(copy.GetBinContent(i), h.GetBinContent(i));
+  }
+}
+
+TEST(BinaryFormat, ViewFixedPointBin) {
+  EPHist::EPHist<EPHist::FixedPointBin> h(10, 0, 10);
+  h.Fill(3, EPHist::Weight(0.5));
+
+  TemporaryFile file("BinaryFormat_ViewFixedPointBin.bin");
+  file.Write(h);
+
+  EPHist::Util::EPHistView<EPHist::FixedPointBin> view(file.GetPath());
+  EXPECT_EQ(view.GetBinContent(3).GetValue(), 0.5);
+}
+
+TEST(BinaryFormat, Profile) {
+  EPHist::RegularAxis axis(10, 0, 10);
+  EPHist::Profile<> p({axis});
+  EPHist::Profile<false> pNoError({axis});
+  for (std::size_t i = 0; i < 10; i++) {
+    p.Fill(i, 2.0 * i, EPHist::Weight(0.5));
+    pNoError.Fill(i, 2.0 * i);
+  }
+
+  TemporaryFile file("BinaryFormat_Profile.bin");
+  file.Write(p);
+  EPHist::Util::ProfileView<> view(file.GetPath());
+  // The bin type is checked.
+  EXPECT_THROW(EPHist::Util::ProfileView<false>(file.GetPath()),
+               std::invalid_argument);
+  for (std::size_t i = 0; i < 10; i++) {
+    const auto &bin = view.GetBinContent(i);
+    EXPECT_EQ(bin.fSumValues, i);
+    EXPECT_EQ(bin.fSum, 0.5);
+    EXPECT_EQ(bin.fSum2, 0.25);
+  }
+
+  std::stringstream ss;
+  EPHist::Util::WriteBinary(pNoError, ss);
+  auto read = EPHist::Util::ReadBinary<EPHist::Profile<false>>(ss);
+  for (std::size_t i = 0; i < 10; i++) {
+    EXPECT_EQ(read.GetBinContent(i).fSumValues, 2.0 * i);
+    EXPECT_EQ(read.GetBinContent(i).fSum, 1);
+  }
+}
+
+TEST(BinaryFormat, Invalid) {
+  EPHist::EPHist<int> h(10, 0, 10);
+  std::stringstream ss;
+  EPHist::Util::WriteBinary(h, ss);
+  const std::string data = ss.str();
+
+  // Wrong bin content type.
+  ss.seekg(0);
+  EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<float>>(ss),
+               std::invalid_argument);
+
+  // Not the binary format.
+  std::stringstream text("some text that is long enough for a header, but it "
+                         "is not the binary format");
+  EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<int>>(text),
+               std::invalid_argument);
+
+  // Corrupt headers are rejected before allocating the axes.
+  EPHist::Util::BinaryHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  for (std::uint64_t dataOffset :
+       {std::uint64_t(1) << 62,
+        std::uint64_t(sizeof(header) + EPHist::Util::BinaryMaxAxesSize +
+                      EPHist::Util::BinaryAlignment)}) {
+    EPHist::Util::BinaryHeader corrupt = header;
+    corrupt.fDataOffset = dataOffset;
+    std::stringstream cs(
+        std::string(reinterpret_cast<const char *>(&corrupt), sizeof(corrupt)));
+    EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<int>>(cs),
+                 std::invalid_argument);
+  }
+  for (std::uint64_t numDimensions : {std::uint64_t(0), std::uint64_t(1000)}) {
+    std::string corrupt = data;
+    std::memcpy(corrupt.data() +
+                    offsetof(EPHist::Util::BinaryHeader, fNumDimensions),
+                &numDimensions, sizeof(numDimensions));
+    std::stringstream cs(corrupt);
+    EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<int>>(cs),
+                 std::invalid_argument);
+  }
+
+  // Truncated files.
+  TemporaryFile file("BinaryFormat_Invalid.bin");
+  {
+    std::ofstream os(file.GetPath(), std::ios::binary);
+    os.write(data.data(), data.size() - 1);
+  }
+  EXPECT_THROW(EPHist::Util::EPHistView<int>(file.GetPath()),
+               std::invalid_argument);
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<int>>(truncated),
+               std::invalid_argument);
+
+  EXPECT_THROW(EPHist::Util::EPHistView<int>(file.GetPath() + ".missing"),
+               std::runtime_error);
+}
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/FixedPointBin.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/Util/BinaryFormat.hxx>
+#include <EPHist/Util/CompressedFormat.hxx>
+#include <EPHist/Weight.hxx>
+
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+template <typename H> static std::string Compress(const H &h) {
+  std::stringstream ss;
+  EPHist::Util::WriteCompressed(h, ss);
+  return ss.str();
+}
+
+template <typename H>
+static H Decompress(const std::string &data, std::size_t numThreads = 1) {
+  std::stringstream ss(data);
+  return EPHist::Util::ReadCompressed<H>(ss, numThreads);
+}
+
+template <typename H> static void ExpectEqualBins(const H &h1, const H &h2) {
+  ASSERT_EQ(h1.GetAxes(), h2.GetAxes());
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    ASSERT_EQ(h1.GetBinContent(i), h2.GetBinContent(i)) << "bin " << i;
+  }
+}
+
+TEST(CompressedFormat, Sparse) {
+  static constexpr std::size_t Bins = 1000;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::EPHist<int> h({axis, axis});
+  for (std::size_t i = 0; i < Bins; i++) {
+    h.Fill(i, (7 * i) % Bins);
+  }
+
+  const std::string data = Compress(h);
+  // Much smaller than the dense bins.
+  EXPECT_LT(data.size(), h.GetTotalNumBins() * sizeof(int) / 100);
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<int>>(data));
+}
+
+TEST(CompressedFormat, Empty) {
+  EPHist::EPHist<double> h(100000, 0, 1);
+  const std::string data = Compress(h);
+  EXPECT_LT(data.size(), 1024);
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<double>>(data));
+}
+
+TEST(CompressedFormat, Integer) {
+  static constexpr std::size_t Bins = 100000;
+  EPHist::EPHist<long long> h(Bins, 0, Bins);
+  long long *data = EPHist::Util::BinaryIO<decltype(h)>::GetData(h);
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    // Slowly varying counts, compressed as deltas.
+    data[i] = 1000000 + i / 3;
+  }
+  data[10] = LLONG_MIN;
+  data[11] = LLONG_MAX;
+  data[12] = -5;
+
+  const std::string compressed = Compress(h);
+  EXPECT_LT(compressed.size(), h.GetTotalNumBins() * sizeof(long long) / 4);
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<long long>>(compressed));
+
+  EPHist::EPHist<int> hInt(Bins, 0, Bins);
+  int *dataInt = EPHist::Util::BinaryIO<decltype(hInt)>::GetData(hInt);
+  for (std::size_t i = 0; i < hInt.GetTotalNumBins(); i++) {
+    dataInt[i] = (i % 2 == 0) ? INT_MIN : INT_MAX;
+  }
+  ExpectEqualBins(hInt, Decompress<EPHist::EPHist<int>>(Compress(hInt)));
+
+  EPHist::EPHist<EPHist::FixedPointBin> hFixed(Bins, 0, Bins);
+  for (std::size_t i = 0; i < Bins; i += 10) {
+    hFixed.Fill(i, EPHist::Weight(0.25 * i));
+  }
+  const auto readFixed =
+      Decompress<EPHist::EPHist<EPHist::FixedPointBin>>(Compress(hFixed));
+  for (std::size_t i = 0; i < hFixed.GetTotalNumBins(); i++) {
+    ASSERT_EQ(readFixed.GetBinContent(i).fValue,
+              hFixed.GetBinContent(i).fValue);
+  }
+}
+
+TEST(CompressedFormat, Floating) {
+  static constexpr std::size_t Bins = 100000;
+  EPHist::EPHist<double> h(Bins, 0, Bins);
+  EPHist::EPHist<float> hFloat(Bins, 0, Bins);
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dist(0, Bins);
+  for (std::size_t i = 0; i < 10 * Bins; i++) {
+    const double x = dist(gen);
+    h.Fill(x, EPHist::Weight(0.5));
+    hFloat.Fill(x);
+  }
+
+  const std::string data = Compress(h);
+  EXPECT_LT(data.size(), h.GetTotalNumBins() * sizeof(double) / 4);
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<double>>(data));
+  ExpectEqualBins(hFloat, Decompress<EPHist::EPHist<float>>(Compress(hFloat)));
+
+  // Random values do not compress, and are stored as they are.
+  double *raw = EPHist::Util::BinaryIO<decltype(h)>::GetData(h);
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    raw[i] = dist(gen);
+  }
+  const std::string random = Compress(h);
+  EXPECT_LT(random.size(), h.GetTotalNumBins() * sizeof(double) + 1024);
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<double>>(random));
+}
+
+TEST(CompressedFormat, DoubleBinWithError) {
+  static constexpr std::size_t Bins = 100000;
+  EPHist::EPHist<EPHist::DoubleBinWithError> h(Bins, 0, Bins);
+  for (std::size_t i = 0; i < Bins; i += 100) {
+    h.Fill(i, EPHist::Weight(0.1 * i));
+  }
+  const std::string data = Compress(h);
+  EXPECT_LT(data.size(),
+            h.GetTotalNumBins() * sizeof(EPHist::DoubleBinWithError) / 10);
+  const auto read =
+      Decompress<EPHist::EPHist<EPHist::DoubleBinWithError>>(data);
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    ASSERT_EQ(read.GetBinContent(i).fSum, h.GetBinContent(i).fSum);
+    ASSERT_EQ(read.GetBinContent(i).fSum2, h.GetBinContent(i).fSum2);
+  }
+}
+
+TEST(CompressedFormat, Profile) {
+  EPHist::RegularAxis axis(1000, 0, 1000);
+  EPHist::Profile<> p({axis});
+  for (std::size_t i = 0; i < 1000; i += 3) {
+    p.Fill(i, 2.0 * i, EPHist::Weight(0.5));
+  }
+
+  const auto read = Decompress<EPHist::Profile<>>(Compress(p));
+  for (std::size_t i = 0; i < p.GetTotalNumBins(); i++) {
+    const auto &bin = read.GetBinContent(i);
+    ASSERT_EQ(bin.fSumValues, p.GetBinContent(i).fSumValues);
+    ASSERT_EQ(bin.fSumValues2, p.GetBinContent(i).fSumValues2);
+    ASSERT_EQ(bin.fSum, p.GetBinContent(i).fSum);
+    ASSERT_EQ(bin.fSum2, p.GetBinContent(i).fSum2);
+  }
+}
+
+TEST(CompressedFormat, Threads) {
+  // Enough bins to be split between threads, see BulkOperations.hxx.
+  static constexpr std::size_t Bins = 1024 * 1024;
+  EPHist::EPHist<double> h(Bins, 0, Bins);
+  for (std::size_t i = 0; i < Bins; i += 7) {
+    h.Fill(i, EPHist::Weight(i));
+  }
+
+  std::stringstream ss;
+  EPHist::Util::WriteCompressed(h, ss, /*numThreads=*/4);
+  const std::string data = ss.str();
+  // The result does not depend on the number of threads.
+  EXPECT_EQ(data, Compress(h));
+  ExpectEqualBins(h, Decompress<EPHist::EPHist<double>>(data, 4));
+}
+
+TEST(CompressedFormat, Invalid) {
+  EPHist::EPHist<int> h(10000, 0, 10000);
+  for (std::size_t i = 0; i < 10000; i += 3) {
+    h.Fill(i);
+  }
+  const std::string data = Compress(h);
+
+  // Wrong bin content type.
+  EXPECT_THROW(Decompress<EPHist::EPHist<long long>>(data),
+               std::invalid_argument);
+
+  // The uncompressed binary format is rejected, and vice versa.
+  std::stringstream binary;
+  EPHist::Util::WriteBinary(h, binary);
+  EXPECT_THROW(Decompress<EPHist::EPHist<int>>(binary.str()),
+               std::invalid_argument);
+  std::stringstream compressed(data);
+  EXPECT_THROW(EPHist::Util::ReadBinary<EPHist::EPHist<int>>(compressed),
+               std::invalid_argument);
+
+  // Truncated and corrupt data.
+  EXPECT_THROW(Decompress<EPHist::EPHist<int>>(data.substr(0, data.size() - 1)),
+               std::invalid_argument);
+  EPHist::Util::BinaryHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  // The first block is after the block size and the number of blocks.
+  const std::size_t block = header.fDataOffset + 2 * sizeof(std::uint64_t);
+  std::string corrupt = data;
+  const std::uint32_t unknown = 42;
+  std::memcpy(corrupt.data() + block, &unknown, sizeof(unknown));
+  EXPECT_THROW(Decompress<EPHist::EPHist<int>>(corrupt),
+               std::invalid_argument);
+  corrupt = data;
+  const std::uint64_t tooLarge = EPHist::Util::CompressedBlockSize + 1;
+  const std::size_t sizeOffset =
+      block + offsetof(EPHist::Util::CompressedBlock, fSize);
+  std::memcpy(corrupt.data() + sizeOffset, &tooLarge, sizeof(tooLarge));
+  EXPECT_THROW(Decompress<EPHist::EPHist<int>>(corrupt),
+               std::invalid_argument);
+  // A block size other than CompressedBlockSize is rejected, including one
+  // that would overflow when computing the number of blocks.
+  const std::size_t blockSizeOffset = header.fDataOffset;
+  for (std::uint64_t blockSize :
+       {std::uint64_t(0), std::uint64_t(EPHist::Util::CompressedBlockSize * 2),
+        std::uint64_t(UINT64_MAX - 7)}) {
+    corrupt = data;
+    std::memcpy(corrupt.data() + blockSizeOffset, &blockSize,
+                sizeof(blockSize));
+    EXPECT_THROW(Decompress<EPHist::EPHist<int>>(corrupt),
+                 std::invalid_argument);
+    const std::uint64_t numBlocks = 0;
+    std::memcpy(corrupt.data() + blockSizeOffset + sizeof(blockSize),
+                &numBlocks, sizeof(numBlocks));
+    EXPECT_THROW(Decompress<EPHist::EPHist<int>>(corrupt),
+                 std::invalid_argument);
+  }
+  // A shorter block is detected while decoding.
+  corrupt = data;
+  std::uint64_t size;
+  std::memcpy(&size, corrupt.data() + sizeOffset, sizeof(size));
+  size--;
+  std::memcpy(corrupt.data() + sizeOffset, &size, sizeof(size));
+  EXPECT_THROW(Decompress<EPHist::EPHist<int>>(corrupt, 4),
+               std::invalid_argument);
+}
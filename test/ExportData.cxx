@@ -1,9 +1,12 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <EPHist/DoubleBinWithError.hxx>
 #include <EPHist/EPHist.hxx>
 #include <EPHist/RegularAxis.hxx>
+#include <EPHist/SoAHist.hxx>
 #include <EPHist/Util/ExportData.hxx>
 #include <EPHist/VariableBinAxis.hxx>
+#include <EPHist/Weight.hxx>
 
 #include <gtest/gtest.h>
 
@@ -90,6 +93,33 @@ TEST(ExportTextData, DoubleRegular1D) {
   EXPECT_EQ(ss.str(), Expected);
 }
 
+TEST(ExportTextData, SoAHistRegular1D) {
+  EPHist::SoAHist<EPHist::DoubleBinWithError> h1(3, 1, 10);
+
+  for (double x : {1, 2, 1, 5, 4, 10, 7, 10, 9, 8, 9, 9}) {
+    h1.Fill(x, EPHist::Weight(2));
+  }
+
+  const char *ExpectedSum = R"(1 6
+4 4
+7 10
+10 10
+)";
+  const char *ExpectedSum2 = R"(1 12
+4 8
+7 20
+10 20
+)";
+
+  std::stringstream ss;
+  EPHist::Util::ExportTextData(h1, 0, ss);
+  EXPECT_EQ(ss.str(), ExpectedSum);
+
+  ss.str("");
+  EPHist::Util::ExportTextData(h1, 1, ss);
+  EXPECT_EQ(ss.str(), ExpectedSum2);
+}
+
 TEST(ExportTextData, IntRegular2D) {
   EPHist::RegularAxis axis(20, 0.0, 1.0);
   EPHist::EPHist<int> h2({axis, axis});
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinStorage.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/ParallelFillStrategy.hxx>
+#include <EPHist/ParallelHelper.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/Util/BinaryFormat.hxx>
+#include <EPHist/Util/FileBackedHist.hxx>
+#include <EPHist/Weight.hxx>
+
+#include "TemporaryFile.hxx"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(FileBackedHist, Create) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  TemporaryFile file("FileBackedHist_Create.bin");
+
+  auto h = EPHist::Util::CreateFileBackedEPHist<double>(file.GetPath(),
+                                                        {axis, axis});
+  EXPECT_TRUE(EPHist::Util::IsFileBacked(h));
+  EXPECT_EQ(h.GetTotalNumBins(), (Bins + 2) * (Bins + 2));
+  EXPECT_EQ(h.GetBinContentAt(1, 2), 0);
+  h.Fill(1, 2);
+  h.FillAtomic(1, 2, EPHist::Weight(0.5));
+  EPHist::Util::Checkpoint(h);
+
+  // The file is in the binary format.
+  EPHist::Util::EPHistView<double> view(file.GetPath());
+  EXPECT_EQ(view.GetAxes(), h.GetAxes());
+  EXPECT_EQ(view.GetBinContentAt(1, 2), 1.5);
+  std::ifstream is(file.GetPath(), std::ios::binary);
+  auto read = EPHist::Util::ReadBinary<EPHist::EPHist<double>>(is);
+  EXPECT_EQ(read.GetBinContentAt(1, 2), 1.5);
+  EXPECT_FALSE(EPHist::Util::IsFileBacked(read));
+
+  // Clones store their bins in memory.
+  auto clone = h.Clone();
+  EXPECT_FALSE(EPHist::Util::IsFileBacked(clone));
+  clone.Fill(1, 2);
+  EXPECT_EQ(clone.GetBinContentAt(1, 2), 2.5);
+  EXPECT_EQ(h.GetBinContentAt(1, 2), 1.5);
+  EXPECT_THROW(EPHist::Util::Checkpoint(clone), std::invalid_argument);
+}
+
+TEST(FileBackedHist, Resume) {
+  static constexpr std::size_t Bins = 20;
+  TemporaryFile file("FileBackedHist_Resume.bin");
+
+  {
+    auto h = EPHist::Util::CreateFileBackedEPHist<int>(
+        file.GetPath(), {EPHist::RegularAxis(Bins, 0, Bins)});
+    h.Fill(1);
+    // Even without a checkpoint, the fills are in the page cache.
+  }
+
+  auto h = EPHist::Util::OpenFileBackedEPHist<int>(file.GetPath());
+  EXPECT_EQ(h.GetBinContent(1), 1);
+  h.Fill(1);
+  EXPECT_EQ(h.GetBinContent(1), 2);
+
+  // Moving keeps the bins in the file.
+  auto moved = std::move(h);
+  EXPECT_TRUE(EPHist::Util::IsFileBacked(moved));
+  EXPECT_EQ(moved.GetBinContent(1), 2);
+
+  EXPECT_THROW(EPHist::Util::OpenFileBackedEPHist<double>(file.GetPath()),
+               std::invalid_argument);
+  EXPECT_THROW(
+      EPHist::Util::OpenFileBackedEPHist<int>(file.GetPath() + ".missing"),
+      std::runtime_error);
+}
+
+TEST(FileBackedHist, Add) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  TemporaryFile file("FileBackedHist_Add.bin");
+
+  auto h = EPHist::Util::CreateFileBackedEPHist<int>(file.GetPath(), {axis});
+  EPHist::EPHist<int> memory(axis);
+  h.Fill(1);
+  memory.Fill(1);
+  memory.Fill(2);
+
+  h.Add(memory);
+  EXPECT_EQ(h.GetBinContent(1), 2);
+  EXPECT_EQ(h.GetBinContent(2), 1);
+  memory.Add(h);
+  EXPECT_EQ(memory.GetBinContent(1), 3);
+  EXPECT_EQ(memory.GetBinContent(2), 2);
+}
+
+TEST(FileBackedHist, ParallelHelper) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr std::size_t Threads = 4;
+  TemporaryFile file("FileBackedHist_ParallelHelper.bin");
+
+  auto h = std::make_shared<EPHist::EPHist<int>>(
+      EPHist::Util::CreateFileBackedEPHist<int>(
+          file.GetPath(), {EPHist::RegularAxis(Bins, 0, Bins)}));
+  {
+    EPHist::ParallelHelper helper(h, EPHist::ParallelFillStrategy::Atomic);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        for (std::size_t i = 0; i < Bins; i++) {
+          context->Fill(i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  EPHist::Util::Checkpoint(*h);
+
+  EPHist::Util::EPHistView<int> view(file.GetPath());
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_EQ(view.GetBinContent(i), Threads);
+  }
+}
+
+TEST(FileBackedHist, BinStorageSelfMove) {
+  EPHist::Internal::BinStorage<int> inMemory(12);
+  inMemory[1] = 2;
+  // Go through a reference to avoid warnings about the self-move.
+  auto &alias = inMemory;
+  inMemory = std::move(alias);
+  ASSERT_EQ(inMemory.size(), 12);
+  EXPECT_FALSE(inMemory.IsExternal());
+  EXPECT_EQ(inMemory[1], 2);
+
+  auto bins = std::make_shared<std::vector<int>>(12);
+  (*bins)[1] = 3;
+  EPHist::Internal::BinStorage<int> external(bins->data(), bins->size(), bins);
+  auto &externalAlias = external;
+  external = std::move(externalAlias);
+  ASSERT_EQ(external.size(), 12);
+  EXPECT_TRUE(external.IsExternal());
+  EXPECT_EQ(external[1], 3);
+}
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/EPHist.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/Util/BinaryFormat.hxx>
+#include <EPHist/Util/MergeFiles.hxx>
+#include <EPHist/Weight.hxx>
+
+#include "TemporaryFile.hxx"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(MergeFiles, Basic) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  TemporaryFile input1("MergeFiles_Basic_1.bin");
+  TemporaryFile input2("MergeFiles_Basic_2.bin");
+  TemporaryFile output("MergeFiles_Basic.bin");
+
+  EPHist::EPHist<int> h1(axis);
+  EPHist::EPHist<int> h2(axis);
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i);
+    h2.Fill(i);
+    h2.Fill(i);
+  }
+  h1.Fill(-1);
+  input1.Write(h1);
+  input2.Write(h2);
+
+  EPHist::Util::MergeBinaryFiles({input1.GetPath(), input2.GetPath()},
+                                 output.GetPath());
+  EPHist::Util::EPHistView<int> view(output.GetPath());
+  EXPECT_EQ(view.GetAxes(), h1.GetAxes());
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_EQ(view.GetBinContent(i), 3);
+  }
+  EXPECT_EQ(view.GetBinContentAt(EPHist::BinIndex::Underflow()), 1);
+}
+
+TEST(MergeFiles, ManyInputs) {
+  // More inputs than are mapped at the same time.
+  static constexpr std::size_t Inputs =
+      2 * EPHist::Util::MergeFilesBatchSize + 3;
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  TemporaryFile output("MergeFiles_ManyInputs.bin");
+
+  std::vector<TemporaryFile> files;
+  std::vector<std::string> inputs;
+  for (std::size_t i = 0; i < Inputs; i++) {
+    files.emplace_back("MergeFiles_ManyInputs_" + std::to_string(i) + ".bin");
+    EPHist::EPHist<double> h(axis);
+    h.Fill(i % Bins, EPHist::Weight(0.5));
+    files.back().Write(h);
+    inputs.push_back(files.back().GetPath());
+  }
+
+  EPHist::Util::MergeBinaryFiles(inputs, output.GetPath());
+  EPHist::Util::EPHistView<double> view(output.GetPath());
+  double sum = 0;
+  for (std::size_t i = 0; i < Bins; i++) {
+    const std::size_t expected = Inputs / Bins + (i < Inputs % Bins ? 1 : 0);
+    EXPECT_EQ(view.GetBinContent(i), 0.5 * expected);
+    sum += view.GetBinContent(i);
+  }
+  EXPECT_EQ(sum, 0.5 * Inputs);
+}
+
+TEST(MergeFiles, Profile) {
+  EPHist::RegularAxis axis(10, 0, 10);
+  TemporaryFile input1("MergeFiles_Profile_1.bin");
+  TemporaryFile input2("MergeFiles_Profile_2.bin");
+  TemporaryFile output("MergeFiles_Profile.bin");
+
+  EPHist::Profile<> p({axis});
+  for (std::size_t i = 0; i < 10; i++) {
+    p.Fill(i, 2.0 * i, EPHist::Weight(0.5));
+  }
+  input1.Write(p);
+  input2.Write(p);
+
+  EPHist::Util::MergeBinaryFiles({input1.GetPath(), input2.GetPath()},
+                                 output.GetPath());
+  EPHist::Util::ProfileView<> view(output.GetPath());
+  for (std::size_t i = 0; i < 10; i++) {
+    const auto &bin = view.GetBinContent(i);
+    EXPECT_EQ(bin.fSumValues, 2.0 * i);
+    EXPECT_EQ(bin.fSum, 1);
+    EXPECT_EQ(bin.fSum2, 0.5);
+  }
+}
+
+TEST(MergeFiles, Threads) {
+  // Enough bins to be split between threads, see BulkOperations.hxx.
+  static constexpr std::size_t Bins = 256 * 1024;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  TemporaryFile input1("MergeFiles_Threads_1.bin");
+  TemporaryFile input2("MergeFiles_Threads_2.bin");
+  TemporaryFile output("MergeFiles_Threads.bin");
+
+  EPHist::EPHist<long> h(axis);
+  for (std::size_t i = 0; i < Bins; i++) {
+    h.Fill(i);
+  }
+  input1.Write(h);
+  input2.Write(h);
+
+  EPHist::Util::MergeBinaryFiles({input1.GetPath(), input2.GetPath()},
+                                 output.GetPath(), /*numThreads=*/2);
+  EPHist::Util::EPHistView<long> view(output.GetPath());
+  for (std::size_t i = 0; i < Bins; i++) {
+    ASSERT_EQ(view.GetBinContent(i), 2);
+  }
+}
+
+TEST(MergeFiles, Invalid) {
+  TemporaryFile input1("MergeFiles_Invalid_1.bin");
+  TemporaryFile input2("MergeFiles_Invalid_2.bin");
+  TemporaryFile input3("MergeFiles_Invalid_3.bin");
+  TemporaryFile output("MergeFiles_Invalid.bin");
+
+  input1.Write(EPHist::EPHist<int>(10, 0, 10));
+  // Same number of bins, but different axes.
+  input2.Write(EPHist::EPHist<int>(10, 0, 5));
+  input3.Write(EPHist::EPHist<double>(10, 0, 10));
+
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles({}, output.GetPath()),
+               std::invalid_argument);
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), input2.GetPath()}, output.GetPath()),
+               std::invalid_argument);
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), input3.GetPath()}, output.GetPath()),
+               std::invalid_argument);
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), input2.GetPath()}, input1.GetPath()),
+               std::invalid_argument);
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), output.GetPath() + ".missing"},
+                   output.GetPath()),
+               std::runtime_error);
+}
+
+TEST(MergeFiles, OutputIsInput) {
+  TemporaryFile input1("MergeFiles_OutputIsInput_1.bin");
+  TemporaryFile input2("MergeFiles_OutputIsInput_2.bin");
+  TemporaryFile symlink("MergeFiles_OutputIsInput_symlink.bin");
+  TemporaryFile hardlink("MergeFiles_OutputIsInput_hardlink.bin");
+
+  EPHist::EPHist<int> h(10, 0, 10);
+  h.Fill(1);
+  input1.Write(h);
+  input2.Write(h);
+  ASSERT_EQ(::symlink(input1.GetPath().c_str(), symlink.GetPath().c_str()), 0);
+  ASSERT_EQ(::link(input1.GetPath().c_str(), hardlink.GetPath().c_str()), 0);
+
+  // Different paths to the same file as an input are rejected.
+  for (const auto *output : {&symlink, &hardlink}) {
+    EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                     {input1.GetPath(), input2.GetPath()}, output->GetPath()),
+                 std::invalid_argument);
+  }
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {symlink.GetPath(), input2.GetPath()}, input1.GetPath()),
+               std::invalid_argument);
+
+  // The input was not modified.
+  EPHist::Util::EPHistView<int> view(input1.GetPath());
+  EXPECT_EQ(view.GetBinContent(1), 1);
+}
+
+TEST(MergeFiles, FailedMerge) {
+  TemporaryFile input1("MergeFiles_FailedMerge_1.bin");
+  TemporaryFile input2("MergeFiles_FailedMerge_2.bin");
+  TemporaryFile output("MergeFiles_FailedMerge.bin");
+
+  EPHist::EPHist<int> h(10, 0, 10);
+  h.Fill(1);
+  input1.Write(h);
+  input2.Write(EPHist::EPHist<int>(10, 0, 5));
+  output.Write(h);
+
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), input2.GetPath()}, output.GetPath()),
+               std::invalid_argument);
+  // The existing output is left as it was.
+  EPHist::Util::EPHistView<int> view(output.GetPath());
+  EXPECT_EQ(view.GetBinContent(1), 1);
+}
+
+TEST(MergeFiles, OldVersion) {
+  TemporaryFile input1("MergeFiles_OldVersion_1.bin");
+  TemporaryFile input2("MergeFiles_OldVersion_2.bin");
+  TemporaryFile output("MergeFiles_OldVersion.bin");
+
+  EPHist::EPHist<int> h(10, 0, 10);
+  h.Fill(1);
+  input1.Write(h);
+  input2.Write(h);
+  {
+    // Version 1 had no fingerprint of the axes, and is rejected.
+    std::fstream fs(input1.GetPath(),
+                    std::ios::binary | std::ios::in | std::ios::out);
+    fs.seekp(offsetof(EPHist::Util::BinaryHeader, fVersion));
+    const std::uint32_t version = 1;
+    fs.write(reinterpret_cast<const char *>(&version), sizeof(version));
+  }
+
+  EXPECT_THROW(EPHist::Util::MergeBinaryFiles(
+                   {input1.GetPath(), input2.GetPath()}, output.GetPath()),
+               std::invalid_argument);
+}
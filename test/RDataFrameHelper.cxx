@@ -1,9 +1,14 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/BulkOperations.hxx>
 #include <EPHist/EPHist.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/RegularAxis.hxx>
 #include <EPHist/Util/RDataFrameHelper.hxx>
 
 #include <ROOT/RDataFrame.hxx>
+#include <TROOT.h>
 
 #include <gtest/gtest.h>
 
@@ -129,6 +134,57 @@ TEST(EPHistFillAddHelper, IntRegular2D) {
   }
 }
 
+TEST(EPHistFillAddHelper, Finalize) {
+  // Call the helper directly to reduce a number of slots that is not a power
+  // of two.
+  static constexpr std::size_t Bins = 20;
+  static constexpr unsigned int Slots = 7;
+  EPHist::Util::EPHistFillAddHelper<int> helper(Slots, Bins, 0, Bins);
+  auto h1 = helper.GetResultPtr();
+
+  for (unsigned int slot = 0; slot < Slots; slot++) {
+    for (std::size_t i = 0; i <= slot; i++) {
+      helper.Exec(slot, i);
+    }
+  }
+  helper.Finalize();
+
+  for (std::size_t i = 0; i < Slots; i++) {
+    EXPECT_EQ(h1->GetBinContent(i), Slots - i);
+  }
+  for (std::size_t i = Slots; i < Bins + 2; i++) {
+    EXPECT_EQ(h1->GetBinContent(i), 0);
+  }
+}
+
+TEST(EPHistFillAddHelper, FinalizeImplicitMT) {
+  // Large enough to run multiple pairs and each addition on ROOT's thread
+  // pool, with a number of slots that is not a power of two.
+  static constexpr std::size_t Bins = 4 * EPHist::Internal::MinBinsPerThread;
+  static constexpr unsigned int Slots = 7;
+  ROOT::EnableImplicitMT(3);
+  {
+    EPHist::Util::EPHistFillAddHelper<int> helper(Slots, Bins, 0, Bins);
+    auto h1 = helper.GetResultPtr();
+
+    for (unsigned int slot = 0; slot < Slots; slot++) {
+      for (std::size_t i = 0; i < Bins; i++) {
+        if (i % Slots <= slot) {
+          helper.Exec(slot, i);
+        }
+      }
+    }
+    helper.Finalize();
+
+    for (std::size_t i = 0; i < Bins; i++) {
+      ASSERT_EQ(h1->GetBinContent(i), Slots - i % Slots) << "bin " << i;
+    }
+    EXPECT_EQ(h1->GetBinContent(Bins), 0);
+    EXPECT_EQ(h1->GetBinContent(Bins + 1), 0);
+  }
+  ROOT::DisableImplicitMT();
+}
+
 TEST(EPHistFillAtomicHelper, IntRegular1D) {
   // The same histograms as IntRegular1D.FillOnlyInner in regular.cxx
   static constexpr std::size_t Bins = 20;
@@ -188,3 +244,24 @@ TEST(EPHistFillAtomicHelper, IntRegular2D) {
     EXPECT_EQ(h2->GetBinContent((BinsX + 1) * (BinsY + 2) + y), 0);
   }
 }
+
+TEST(ProfileFillHelper, Regular1D) {
+  static constexpr std::size_t Bins = 20;
+  ROOT::RDataFrame df(Bins);
+  auto df2 = df.Define("x", [](ULong64_t e) { return 2.0 * e; }, {"rdfentry_"});
+
+  std::vector<EPHist::AxisVariant> axes = {EPHist::RegularAxis(Bins, 0, Bins)};
+  EPHist::Util::ProfileFillHelper<true> helper(df.GetNSlots(), axes);
+  auto p1 = df2.Book<ULong64_t, double>(std::move(helper), {"rdfentry_", "x"});
+
+  ASSERT_EQ(p1->GetTotalNumBins(), Bins + 2);
+  EXPECT_EQ(p1->GetNumDimensions(), 1);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = p1->GetBinContentAt(EPHist::BinIndex(i));
+    EXPECT_FLOAT_EQ(binContent.fSumValues, 2 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, 4 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1);
+  }
+}
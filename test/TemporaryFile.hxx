@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EPHIST_TEST_TEMPORARYFILE
+#define EPHIST_TEST_TEMPORARYFILE
+
+#include <EPHist/Util/BinaryFormat.hxx>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+// A temporary file, which is removed when the object goes away.
+class TemporaryFile final {
+  std::string fPath;
+
+public:
+  explicit TemporaryFile(const std::string &name)
+      : fPath(testing::TempDir() + name) {}
+  // A copy would remove the file a second time, or too early. The moved-from
+  // object no longer owns the file.
+  TemporaryFile(const TemporaryFile &) = delete;
+  TemporaryFile(TemporaryFile &&other) noexcept
+      : fPath(std::move(other.fPath)) {
+    other.fPath.clear();
+  }
+  TemporaryFile &operator=(const TemporaryFile &) = delete;
+  TemporaryFile &operator=(TemporaryFile &&) = delete;
+  ~TemporaryFile() {
+    if (!fPath.empty()) {
+      std::remove(fPath.c_str());
+    }
+  }
+
+  const std::string &GetPath() const { return fPath; }
+
+  // Write a histogram or profile in the binary format.
+  template <typename H> void Write(const H &h) const {
+    std::ofstream os(fPath, std::ios::binary);
+    EPHist::Util::WriteBinary(h, os);
+  }
+};
+
+#endif
@@ -1,10 +1,16 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <EPHist/AlignedDoubleBinWithError.hxx>
 #include <EPHist/DoubleBinWithError.hxx>
 #include <EPHist/EPHist.hxx>
+#include <EPHist/FixedPointBin.hxx>
+#include <EPHist/Weight.hxx>
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 TEST(Atomic, AddAtomicDifferentDimensions) {
   static constexpr std::size_t Bins = 20;
   EPHist::RegularAxis axis(Bins, 0, Bins);
@@ -619,3 +625,106 @@ TEST(DoubleBinWithErrorRegular1D, TemplatedFillAtomicWeight) {
     EXPECT_FLOAT_EQ(binWithError.fSum2, weight * weight);
   }
 }
+
+TEST(FixedPointBinRegular1D, FillAtomicWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::FixedPointBin> h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.FillAtomic(i);
+    h1.FillAtomic(i, EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  EPHist::EPHist<EPHist::FixedPointBin> h2(Bins, 0, Bins);
+  h2.AddAtomic(h1);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h2.GetBinContent(i).GetValue(), 1.5 + i * 0.1);
+  }
+}
+
+// Fill the same bins from multiple threads, with all atomic backends.
+template <typename T> static void FillAtomicThreads(EPHist::EPHist<T> &h1) {
+  static constexpr std::size_t Threads = 4;
+  static constexpr std::size_t Fills = 10000;
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < Threads; t++) {
+    threads.emplace_back([&h1] {
+      for (std::size_t i = 0; i < Fills; i++) {
+        h1.FillAtomic(i % 2, EPHist::Weight(0.5));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(Atomic, FillAtomicThreads) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr double Expected = 4 * 10000 / 2 * 0.5;
+
+  EPHist::EPHist<double> h1(Bins, 0, Bins);
+  FillAtomicThreads(h1);
+  EXPECT_EQ(h1.GetBinContent(0), Expected);
+  EXPECT_EQ(h1.GetBinContent(1), Expected);
+
+  EPHist::EPHist<EPHist::DoubleBinWithError> h1E(Bins, 0, Bins);
+  FillAtomicThreads(h1E);
+  EXPECT_EQ(h1E.GetBinContent(0).fSum, Expected);
+  EXPECT_EQ(h1E.GetBinContent(0).fSum2, Expected * 0.5);
+
+  EPHist::EPHist<EPHist::AlignedDoubleBinWithError> h1A(Bins, 0, Bins);
+  FillAtomicThreads(h1A);
+  EXPECT_EQ(h1A.GetBinContent(0).fSum, Expected);
+  EXPECT_EQ(h1A.GetBinContent(0).fSum2, Expected * 0.5);
+
+  EPHist::EPHist<EPHist::FixedPointBin> h1F(Bins, 0, Bins);
+  FillAtomicThreads(h1F);
+  EXPECT_EQ(h1F.GetBinContent(0).GetValue(), Expected);
+}
+
+TEST(AlignedDoubleBinWithErrorRegular1D, FillAtomicWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::AlignedDoubleBinWithError> h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.FillAtomic(i);
+    h1.FillAtomic(i, EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  EPHist::EPHist<EPHist::AlignedDoubleBinWithError> h2(Bins, 0, Bins);
+  h2.AddAtomic(h1);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &binWithError = h2.GetBinContent(i);
+    double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(binWithError.fSum, 1 + weight);
+    EXPECT_FLOAT_EQ(binWithError.fSum2, 1 + weight * weight);
+  }
+}
+
+TEST(AlignedDoubleBinWithErrorRegular1D, FillAtomicStress) {
+  // Many threads filling a single bin with different weights; the weights are
+  // powers of two so that all sums are exact.
+  static constexpr std::size_t Threads = 8;
+  static constexpr std::size_t Fills = 100000;
+  EPHist::EPHist<EPHist::AlignedDoubleBinWithError> h1(1, 0, 1);
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < Threads; t++) {
+    threads.emplace_back([&h1, t] {
+      const double weight = (t % 2 == 0) ? 0.5 : 2;
+      for (std::size_t i = 0; i < Fills; i++) {
+        h1.FillAtomic(0.5, EPHist::Weight(weight));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto &binWithError = h1.GetBinContent(0);
+  EXPECT_EQ(binWithError.fSum, Threads / 2 * Fills * (0.5 + 2));
+  EXPECT_EQ(binWithError.fSum2, Threads / 2 * Fills * (0.25 + 4));
+}
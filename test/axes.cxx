@@ -142,17 +142,19 @@ TEST(Axes, TemplatedComputeBinInvalidNumberOfArguments) {
   EPHist::Detail::Axes axes2({axis, axis});
   ASSERT_EQ(axes2.GetNumDimensions(), 2);
 
-  EXPECT_NO_THROW(axes1.ComputeBin<EPHist::RegularAxis>(1));
-  EXPECT_THROW(
-      (axes1.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis>(1, 2)),
-      std::invalid_argument);
-
-  EXPECT_THROW(axes2.ComputeBin<EPHist::RegularAxis>(1), std::invalid_argument);
-  EXPECT_NO_THROW(
-      (axes2.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis>(1, 2)));
-  EXPECT_THROW((axes2.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis,
-                                 EPHist::RegularAxis>(1, 2, 3)),
-               std::invalid_argument);
+  // An invalid number of arguments does not find a bin.
+  EXPECT_TRUE(axes1.ComputeBin<EPHist::RegularAxis>(1).second);
+  EXPECT_FALSE(
+      (axes1.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis>(1, 2))
+          .second);
+
+  EXPECT_FALSE(axes2.ComputeBin<EPHist::RegularAxis>(1).second);
+  EXPECT_TRUE(
+      (axes2.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis>(1, 2))
+          .second);
+  EXPECT_FALSE((axes2.ComputeBin<EPHist::RegularAxis, EPHist::RegularAxis,
+                                 EPHist::RegularAxis>(1, 2, 3))
+                   .second);
 }
 
 TEST(Axes, TemplatedComputeInvalidAxis) {
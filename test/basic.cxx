@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include <EPHist/BinIndex.hxx>
+#include <EPHist/BulkOperations.hxx>
 #include <EPHist/EPHist.hxx>
 #include <EPHist/RegularAxis.hxx>
 #include <EPHist/VariableBinAxis.hxx>
@@ -114,6 +115,59 @@ TEST(Basic, Clear) {
   }
 }
 
+TEST(Basic, Merge) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<int> hA(Bins, 0, Bins);
+  EPHist::EPHist<int> hB(Bins, 0, Bins);
+  EPHist::EPHist<int> hC(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    hA.Fill(i);
+    hB.Fill(i);
+    hB.Fill(i);
+    hC.Fill(i);
+  }
+
+  hA.Merge({&hB, &hC});
+  hA.Merge({});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_EQ(hA.GetBinContent(i), 4);
+    EXPECT_EQ(hB.GetBinContent(i), 2);
+  }
+
+  EPHist::EPHist<int> hD(Bins / 2, 0, Bins);
+  EXPECT_THROW(hA.Merge({&hB, &hD}), std::invalid_argument);
+}
+
+TEST(Basic, BulkOperationsThreads) {
+  // Enough bins for multiple threads, and a number of bins that is not
+  // divisible by the number of threads.
+  static constexpr std::size_t Bins = 4 * EPHist::Internal::MinBinsPerThread;
+  static constexpr std::size_t Threads = 3;
+  EPHist::EPHist<int> hA(Bins, 0, Bins);
+  EPHist::EPHist<int> hB(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    hA.Fill(i);
+    hB.Fill(i);
+  }
+  hB.Fill(-1);
+
+  hA.Add(hB, Threads);
+  hA.AddAtomic(hB, Threads);
+  hA.Merge({&hB, &hB}, Threads);
+  for (std::size_t i = 0; i < Bins; i++) {
+    ASSERT_EQ(hA.GetBinContent(i), 5);
+  }
+  EXPECT_EQ(hA.GetBinContent(Bins), 4);
+
+  hA.Clear(/*numThreads=*/0);
+  for (std::size_t i = 0; i < hA.GetTotalNumBins(); i++) {
+    ASSERT_EQ(hA.GetBinContent(i), 0);
+  }
+}
+
 TEST(Basic, Clone) {
   static constexpr std::size_t Bins = 20;
   EPHist::EPHist<int> hA(Bins, 0, Bins);
@@ -0,0 +1,317 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/ParallelFillStrategy.hxx>
+#include <EPHist/ParallelHelper.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+TEST(Batch, FillNInvalidNumberOfArguments) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::EPHist<int> h1(axis);
+  ASSERT_EQ(h1.GetNumDimensions(), 1);
+  EPHist::EPHist<int> h2({axis, axis});
+  ASSERT_EQ(h2.GetNumDimensions(), 2);
+
+  const double x[] = {1, 2, 3};
+  EXPECT_NO_THROW(h1.FillN(3, x));
+  EXPECT_THROW(h1.FillN(3, x, x), std::invalid_argument);
+
+  EXPECT_THROW(h2.FillN(3, x), std::invalid_argument);
+  EXPECT_NO_THROW(h2.FillN(3, x, x));
+  EXPECT_THROW(h2.FillN(3, x, x, x), std::invalid_argument);
+
+  EXPECT_NO_THROW(h1.FillAtomicN(3, x));
+  EXPECT_THROW(h1.FillAtomicN(3, x, x), std::invalid_argument);
+}
+
+TEST(Batch, FillNWeightInvalidNumberOfArguments) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::EPHist<double> h1(axis);
+  EPHist::EPHist<double> h2({axis, axis});
+
+  const double x[] = {1, 2, 3};
+  const double w[] = {0.5, 0.5, 0.5};
+  EXPECT_NO_THROW(h1.FillN(3, std::make_tuple(x), w));
+  EXPECT_THROW(h1.FillN(3, std::make_tuple(x, x), w), std::invalid_argument);
+
+  EXPECT_THROW(h2.FillN(3, std::make_tuple(x), w), std::invalid_argument);
+  EXPECT_NO_THROW(h2.FillN(3, std::make_tuple(x, x), w));
+}
+
+TEST(Batch, FillNInvalidArgumentType) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<int> h1(Bins, 0, Bins);
+
+  const std::string_view s[] = {"a", "b"};
+  EXPECT_THROW(h1.FillN(2, s), std::invalid_argument);
+}
+
+TEST(IntRegular1D, FillN) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr std::size_t Repetitions = 100;
+  EPHist::EPHist<int> h1(Bins, 0, Bins);
+
+  // Use more entries than one batch to test the chunking.
+  std::vector<double> x;
+  for (std::size_t r = 0; r < Repetitions; r++) {
+    x.push_back(-100);
+    for (std::size_t i = 0; i < Bins; i++) {
+      x.push_back(i);
+    }
+    x.push_back(100);
+  }
+  ASSERT_GT(x.size(), EPHist::Detail::Axes::MaxBatchSize);
+  h1.FillN(x.size(), x.data());
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), Repetitions);
+  }
+}
+
+TEST(IntRegular1D, FillNDiscard) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins, /*enableFlowBins=*/false);
+  EPHist::EPHist<int> h1(axis);
+
+  std::vector<int> x;
+  x.push_back(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+  }
+  x.push_back(100);
+  h1.FillN(x.size(), x.data());
+
+  ASSERT_EQ(h1.GetTotalNumBins(), Bins);
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntRegular1D, FillAtomicN) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<int> h1(Bins, 0, Bins);
+
+  std::vector<double> x;
+  x.push_back(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+  }
+  x.push_back(100);
+  h1.FillAtomicN(x.size(), std::make_tuple(x.data()));
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntRegular2D, FillN) {
+  static constexpr std::size_t BinsX = 20;
+  EPHist::RegularAxis axisX(BinsX, 0, BinsX);
+  static constexpr std::size_t BinsY = 30;
+  EPHist::RegularAxis axisY(BinsY, 0, BinsY);
+  EPHist::EPHist<int> h2({axisX, axisY});
+
+  std::vector<int> x, y;
+  for (int i = -1; i < static_cast<int>(BinsX) + 1; i++) {
+    for (int j = -1; j < static_cast<int>(BinsY) + 1; j++) {
+      x.push_back(i);
+      y.push_back(j);
+    }
+  }
+  h2.FillN(x.size(), std::make_tuple(x.data(), y.data()));
+
+  for (std::size_t i = 0; i < h2.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h2.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntRegular2D, FillNDiscard) {
+  static constexpr std::size_t BinsX = 20;
+  EPHist::RegularAxis axisX(BinsX, 0, BinsX, /*enableFlowBins=*/false);
+  static constexpr std::size_t BinsY = 30;
+  EPHist::RegularAxis axisY(BinsY, 0, BinsY);
+  EPHist::EPHist<int> h2({axisX, axisY});
+
+  std::vector<double> x, y;
+  for (int i = -1; i < static_cast<int>(BinsX) + 1; i++) {
+    for (int j = -1; j < static_cast<int>(BinsY) + 1; j++) {
+      x.push_back(i);
+      y.push_back(j);
+    }
+  }
+  h2.FillN(x.size(), x.data(), y.data());
+
+  for (std::size_t i = 0; i < h2.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h2.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntVariableBin1D, FillN) {
+  static constexpr std::size_t Bins = 20;
+  std::vector<double> bins;
+  for (std::size_t i = 0; i < Bins; i++) {
+    bins.push_back(i);
+  }
+  bins.push_back(Bins);
+  EPHist::VariableBinAxis axis(bins);
+  EPHist::EPHist<int> h1(axis);
+
+  std::vector<double> x;
+  x.push_back(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i + 0.5);
+  }
+  x.push_back(100);
+  h1.FillN(x.size(), x.data());
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntCategorical1D, FillN) {
+  const std::vector<std::string> categories = {"a", "b", "c"};
+  EPHist::CategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+
+  const std::string_view x[] = {"a", "b", "c", "d"};
+  h1.FillN(4, x);
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntMixed2D, FillN) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis regularAxis(Bins, 0, Bins);
+  const std::vector<std::string> categories = {"a", "b", "c"};
+  EPHist::CategoricalAxis categoricalAxis(categories);
+  EPHist::EPHist<int> h2({regularAxis, categoricalAxis});
+
+  const double x[] = {1, 2, 3};
+  const std::string x2[] = {"a", "b", "d"};
+  h2.FillN(3, x, x2);
+
+  EXPECT_EQ(h2.GetBinContentAt(1, 0), 1);
+  EXPECT_EQ(h2.GetBinContentAt(2, 1), 1);
+  EXPECT_EQ(h2.GetBinContentAt(3, EPHist::BinIndex::Overflow()), 1);
+}
+
+TEST(DoubleRegular1D, FillNWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<double> h1(Bins, 0, Bins);
+
+  std::vector<double> x, w;
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+    w.push_back(0.5 + i * 0.1);
+  }
+  h1.FillN(x.size(), std::make_tuple(x.data()), w.data());
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h1.GetBinContent(i), 0.5 + i * 0.1);
+  }
+}
+
+TEST(DoubleRegular1D, FillAtomicNWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<double> h1(Bins, 0, Bins);
+
+  std::vector<double> x, w;
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+    w.push_back(0.5 + i * 0.1);
+  }
+  h1.FillAtomicN(x.size(), std::make_tuple(x.data()), w.data());
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h1.GetBinContent(i), 0.5 + i * 0.1);
+  }
+}
+
+TEST(DoubleBinWithErrorRegular1D, FillNWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::DoubleBinWithError> h1(Bins, 0, Bins);
+
+  std::vector<double> x, w;
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+    w.push_back(0.5 + i * 0.1);
+  }
+  h1.FillN(x.size(), std::make_tuple(x.data()), w.data());
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &bin = h1.GetBinContent(i);
+    double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(bin.fSum, weight);
+    EXPECT_FLOAT_EQ(bin.fSum2, weight * weight);
+  }
+}
+
+static constexpr EPHist::ParallelFillStrategy kAllStrategies[] = {
+    EPHist::ParallelFillStrategy::Automatic,
+    EPHist::ParallelFillStrategy::Atomic,
+    EPHist::ParallelFillStrategy::PerFillContext,
+    EPHist::ParallelFillStrategy::Sharded,
+    EPHist::ParallelFillStrategy::HotBinCache,
+    EPHist::ParallelFillStrategy::Buffered};
+
+TEST(Batch, FillContextFillN) {
+  static constexpr std::size_t Bins = 20;
+  std::vector<double> x;
+  x.push_back(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+  }
+  x.push_back(100);
+
+  for (auto strategy : kAllStrategies) {
+    auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+    {
+      EPHist::ParallelHelper helper(h1, strategy);
+      auto context = helper.CreateFillContext();
+      context->FillN(x.size(), x.data());
+    }
+
+    for (std::size_t i = 0; i < h1->GetTotalNumBins(); i++) {
+      EXPECT_EQ(h1->GetBinContent(i), 1);
+    }
+  }
+}
+
+TEST(Batch, FillContextFillNWeight) {
+  static constexpr std::size_t Bins = 20;
+  std::vector<double> x, w;
+  for (std::size_t i = 0; i < Bins; i++) {
+    x.push_back(i);
+    w.push_back(0.5 + i * 0.1);
+  }
+
+  for (auto strategy : kAllStrategies) {
+    auto h1 = std::make_shared<EPHist::EPHist<double>>(Bins, 0, Bins);
+    {
+      EPHist::ParallelHelper helper(h1, strategy);
+      auto context = helper.CreateFillContext();
+      context->FillN(x.size(), std::make_tuple(x.data()), w.data());
+    }
+
+    for (std::size_t i = 0; i < Bins; i++) {
+      EXPECT_FLOAT_EQ(h1->GetBinContent(i), 0.5 + i * 0.1);
+    }
+  }
+}
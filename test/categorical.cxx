@@ -129,6 +129,54 @@ TEST(CategoricalAxis, ComputeBin) {
   }
 }
 
+TEST(CategoricalAxis, ComputeBinMany) {
+  // Enough categories to use the hash table.
+  static constexpr std::size_t Categories = 300;
+  std::vector<std::string> categories;
+  for (std::size_t i = 0; i < Categories; i++) {
+    categories.push_back("HLT_Path" + std::to_string(i));
+  }
+
+  EPHist::CategoricalAxis axis(categories);
+  EPHist::CategoricalAxis axisNoOverflow(categories,
+                                         /*enableOverflowBin=*/false);
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    auto axisBin = axis.ComputeBin(categories[i]);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+    axisBin = axisNoOverflow.ComputeBin(categories[i]);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+  }
+
+  // Overflow
+  for (std::string overflow : {"", "HLT_Path", "HLT_Path300", "d"}) {
+    auto axisBin = axis.ComputeBin(overflow);
+    EXPECT_EQ(axisBin.first, Categories);
+    EXPECT_TRUE(axisBin.second);
+    axisBin = axisNoOverflow.ComputeBin(overflow);
+    EXPECT_EQ(axisBin.first, Categories);
+    EXPECT_FALSE(axisBin.second);
+  }
+
+  // The sliced axis must find its categories, which might fall below the
+  // threshold of the hash table.
+  for (std::size_t end : {5, 100}) {
+    const auto range = EPHist::BinIndexRange(1, end);
+    const auto slice = axis.Slice(range);
+    ASSERT_EQ(slice.GetNumBins(), end - 1);
+    for (std::size_t i = 1; i < end; i++) {
+      auto axisBin = slice.ComputeBin(categories[i]);
+      EXPECT_EQ(axisBin.first, i - 1);
+      EXPECT_TRUE(axisBin.second);
+    }
+    auto axisBin = slice.ComputeBin(categories[0]);
+    EXPECT_EQ(axisBin.first, end - 1);
+    EXPECT_TRUE(axisBin.second);
+  }
+}
+
 TEST(CategoricalAxis, Slice) {
   std::vector<std::string> categories = {"a", "b", "c", "d"};
 
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/BinIndexRange.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/IntCategoricalAxis.hxx>
+#include <EPHist/ParallelFillStrategy.hxx>
+#include <EPHist/ParallelHelper.hxx>
+#include <EPHist/RegularAxis.hxx>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+TEST(IntCategoricalAxis, Constructor) {
+  std::vector<std::int64_t> categories = {11, 13, 22};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EXPECT_EQ(axis.GetNumBins(), 3);
+  EXPECT_EQ(axis.GetTotalNumBins(), 4);
+
+  axis = EPHist::IntCategoricalAxis(categories, /*enableOverflowBin=*/false);
+  EXPECT_EQ(axis.GetNumBins(), 3);
+  EXPECT_EQ(axis.GetTotalNumBins(), 3);
+
+  // Duplicates must be detected for both the dense and the sparse lookup.
+  std::vector<std::int64_t> duplicate = {1, 1};
+  EXPECT_THROW(EPHist::IntCategoricalAxis d(duplicate), std::invalid_argument);
+  std::vector<std::int64_t> duplicateSparse = {1, 1000000, 1};
+  EXPECT_THROW(EPHist::IntCategoricalAxis d(duplicateSparse),
+               std::invalid_argument);
+}
+
+TEST(IntCategoricalAxis, Equality) {
+  std::vector<std::int64_t> categoriesA = {1, 2, 3};
+  std::vector<std::int64_t> categoriesB = {3, 2, 1};
+  std::vector<std::int64_t> categoriesC = {1, 12, 123};
+
+  EPHist::IntCategoricalAxis axisA(categoriesA);
+  EPHist::IntCategoricalAxis axisANoOverflow(categoriesA,
+                                             /*enableOverflowBin=*/false);
+  EPHist::IntCategoricalAxis axisA2(categoriesA);
+  EPHist::IntCategoricalAxis axisB(categoriesB);
+  EPHist::IntCategoricalAxis axisC(categoriesC);
+
+  EXPECT_TRUE(axisA == axisA);
+  EXPECT_TRUE(axisA == axisA2);
+
+  EXPECT_FALSE(axisA == axisANoOverflow);
+
+  EXPECT_FALSE(axisA == axisB);
+  EXPECT_FALSE(axisA == axisC);
+  EXPECT_FALSE(axisB == axisC);
+}
+
+TEST(IntCategoricalAxis, GetBin) {
+  std::vector<std::int64_t> categories = {1, 2, 3};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::IntCategoricalAxis axisNoOverflow(categories,
+                                            /*enableOverflowBin=*/false);
+
+  {
+    auto underflow = EPHist::BinIndex::Underflow();
+    auto axisBin = axis.GetBin(underflow);
+    EXPECT_FALSE(axisBin.second);
+    axisBin = axisNoOverflow.GetBin(underflow);
+    EXPECT_FALSE(axisBin.second);
+  }
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    auto axisBin = axis.GetBin(i);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+    axisBin = axisNoOverflow.GetBin(i);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+  }
+
+  {
+    auto overflow = EPHist::BinIndex::Overflow();
+    auto axisBin = axis.GetBin(overflow);
+    EXPECT_TRUE(axisBin.second);
+    EXPECT_EQ(axisBin.first, categories.size());
+    axisBin = axisNoOverflow.GetBin(overflow);
+    EXPECT_EQ(axisBin.first, categories.size());
+    EXPECT_FALSE(axisBin.second);
+  }
+}
+
+static void CheckComputeBin(const std::vector<std::int64_t> &categories,
+                            const std::vector<std::int64_t> &others) {
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::IntCategoricalAxis axisNoOverflow(categories,
+                                            /*enableOverflowBin=*/false);
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    auto axisBin = axis.ComputeBin(categories[i]);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+    axisBin = axisNoOverflow.ComputeBin(categories[i]);
+    EXPECT_EQ(axisBin.first, i);
+    EXPECT_TRUE(axisBin.second);
+  }
+
+  // Overflow
+  for (auto overflow : others) {
+    auto axisBin = axis.ComputeBin(overflow);
+    EXPECT_EQ(axisBin.first, categories.size());
+    EXPECT_TRUE(axisBin.second);
+    axisBin = axisNoOverflow.ComputeBin(overflow);
+    EXPECT_EQ(axisBin.first, categories.size());
+    EXPECT_FALSE(axisBin.second);
+  }
+}
+
+TEST(IntCategoricalAxis, ComputeBinDense) {
+  // A compact range of values, using the dense table.
+  CheckComputeBin({3, -2, 0, 5, 1}, {-100, -3, -1, 2, 4, 6, 100});
+}
+
+TEST(IntCategoricalAxis, ComputeBinSparse) {
+  // PDG codes, using the hash table.
+  static constexpr auto Min = std::numeric_limits<std::int64_t>::min();
+  static constexpr auto Max = std::numeric_limits<std::int64_t>::max();
+  CheckComputeBin({11, -11, 13, -13, 22, 211, -211, 2212, 1000010020},
+                  {Min, -2212, -1, 0, 12, 2112, 1000010030, Max});
+  // The full range of values would overflow the computation of the range.
+  CheckComputeBin({Min, 0, Max}, {Min + 1, -1, 1, Max - 1});
+}
+
+TEST(IntCategoricalAxis, ComputeBinEmpty) {
+  CheckComputeBin({}, {-1, 0, 1});
+}
+
+TEST(IntCategoricalAxis, Slice) {
+  std::vector<std::int64_t> categories = {100, 200, 300, 400};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::IntCategoricalAxis axisNoOverflow(categories,
+                                            /*enableOverflowBin=*/false);
+
+  const auto full = EPHist::BinIndexRange::Full(categories.size());
+  for (auto &&a : {axis, axisNoOverflow}) {
+    const auto slice = a.Slice(full);
+    EXPECT_TRUE(slice.IsOverflowBinEnabled());
+    ASSERT_EQ(slice.GetNumBins(), 4);
+    EXPECT_EQ(slice.GetTotalNumBins(), 5);
+    EXPECT_EQ(slice.GetCategory(0), 100);
+    EXPECT_EQ(slice.GetCategory(3), 400);
+  }
+
+  const auto range = EPHist::BinIndexRange(1, 3);
+  for (auto &&a : {axis, axisNoOverflow}) {
+    const auto slice = a.Slice(range);
+    EXPECT_TRUE(slice.IsOverflowBinEnabled());
+    ASSERT_EQ(slice.GetNumBins(), 2);
+    EXPECT_EQ(slice.GetTotalNumBins(), 3);
+    EXPECT_EQ(slice.GetCategory(0), 200);
+    EXPECT_EQ(slice.GetCategory(1), 300);
+
+    // The sliced axis must find its categories and put the others into the
+    // overflow bin.
+    EXPECT_EQ(slice.ComputeBin(200).first, 0);
+    EXPECT_EQ(slice.ComputeBin(300).first, 1);
+    EXPECT_EQ(slice.ComputeBin(100).first, 2);
+    EXPECT_EQ(slice.ComputeBin(400).first, 2);
+  }
+}
+
+TEST(IntIntCategorical1D, Constructor) {
+  std::vector<std::int64_t> categories = {1, 2, 3};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+  EXPECT_EQ(h1.GetTotalNumBins(), 4);
+  EXPECT_EQ(h1.GetNumDimensions(), 1);
+  const auto &axes = h1.GetAxes();
+  ASSERT_EQ(axes.size(), 1);
+  EXPECT_EQ(axes[0].index(), 3);
+  ASSERT_TRUE(std::get_if<EPHist::IntCategoricalAxis>(&axes[0]) != nullptr);
+  EXPECT_EQ(std::get<EPHist::IntCategoricalAxis>(axes[0]).GetNumBins(), 3);
+}
+
+TEST(IntIntCategorical1D, Fill) {
+  std::vector<std::int64_t> categories = {11, 13, 22};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    h1.Fill(categories[i]);
+  }
+  // Other integral types are accepted as well.
+  h1.Fill(211);
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntIntCategorical1D, FillDiscard) {
+  std::vector<std::int64_t> categories = {11, 13, 22};
+
+  EPHist::IntCategoricalAxis axis(categories, /*enableOverflowBin=*/false);
+  EPHist::EPHist<int> h1(axis);
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    h1.Fill(std::make_tuple(categories[i]));
+  }
+  h1.Fill(std::make_tuple(211));
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntIntCategorical1D, FillInvalidArgumentType) {
+  std::vector<std::int64_t> categories = {1, 2, 3};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+
+  // Floating point values are not silently truncated.
+  EXPECT_THROW(h1.Fill(1.5), std::invalid_argument);
+  EXPECT_THROW(h1.Fill("a"), std::invalid_argument);
+}
+
+TEST(IntIntCategorical1D, TemplatedFill) {
+  std::vector<std::int64_t> categories = {11, 13, 22};
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+
+  for (std::size_t i = 0; i < categories.size(); i++) {
+    h1.Fill<EPHist::IntCategoricalAxis>(categories[i]);
+  }
+  h1.Fill<EPHist::IntCategoricalAxis>(211);
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(IntIntCategorical1D, FillN) {
+  std::vector<std::int64_t> categories;
+  for (std::int64_t i = 0; i < 100; i++) {
+    categories.push_back(i * i);
+  }
+
+  EPHist::IntCategoricalAxis axis(categories);
+  EPHist::EPHist<int> h1(axis);
+
+  std::vector<int> x;
+  for (auto category : categories) {
+    x.push_back(category);
+  }
+  x.push_back(2);
+  h1.FillN(x.size(), x.data());
+  h1.FillAtomicN(x.size(), x.data());
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 2);
+  }
+
+  const double d[] = {1};
+  EXPECT_THROW(h1.FillN(1, d), std::invalid_argument);
+}
+
+TEST(IntIntCategorical1D, FillContext) {
+  std::vector<std::int64_t> categories = {11, 13, 22};
+  const std::int64_t x[] = {11, 13, 22, 211};
+
+  for (auto strategy : {EPHist::ParallelFillStrategy::Automatic,
+                        EPHist::ParallelFillStrategy::Atomic,
+                        EPHist::ParallelFillStrategy::PerFillContext}) {
+    EPHist::IntCategoricalAxis axis(categories);
+    auto h1 = std::make_shared<EPHist::EPHist<int>>(axis);
+    {
+      EPHist::ParallelHelper helper(h1, strategy);
+      auto context = helper.CreateFillContext();
+      for (auto v : x) {
+        context->Fill(v);
+      }
+      context->FillN(4, x);
+    }
+
+    for (std::size_t i = 0; i < h1->GetTotalNumBins(); i++) {
+      EXPECT_EQ(h1->GetBinContent(i), 2);
+    }
+  }
+}
+
+TEST(IntMixed2D, IntCategoricalSlice) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis regularAxis(Bins, 0, Bins);
+  std::vector<std::int64_t> categories = {-1, 1, 10, 100};
+  EPHist::IntCategoricalAxis intCategoricalAxis(categories);
+  EPHist::EPHist<int> h2({regularAxis, intCategoricalAxis});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    for (auto category : categories) {
+      h2.Fill(i, category);
+    }
+    h2.Fill(i, 0);
+  }
+
+  const auto fullBins = EPHist::BinIndexRange::Full(Bins);
+  const auto range = EPHist::BinIndexRange(1, 3);
+  const auto slice = h2.Slice(fullBins, range);
+
+  const auto &axes = slice.GetAxes();
+  ASSERT_EQ(axes.size(), 2);
+  const auto *sliced = std::get_if<EPHist::IntCategoricalAxis>(&axes[1]);
+  ASSERT_TRUE(sliced != nullptr);
+  ASSERT_EQ(sliced->GetNumBins(), 2);
+  EXPECT_EQ(sliced->GetCategory(0), 1);
+  EXPECT_EQ(sliced->GetCategory(1), 10);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_EQ(slice.GetBinContentAt(i, 0), 1);
+    EXPECT_EQ(slice.GetBinContentAt(i, 1), 1);
+    // The overflow bin collects the other categories before and after the
+    // range, and the original overflow bin.
+    EXPECT_EQ(slice.GetBinContentAt(i, EPHist::BinIndex::Overflow()), 3);
+  }
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/PagedHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/Weight.hxx>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+static constexpr std::size_t PageBins =
+    EPHist::Internal::PagedStorage<int>::PageBins;
+
+TEST(PagedHist, Constructor) {
+  static constexpr std::size_t Bins = 10 * PageBins;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::PagedHist<int> h1(axis);
+  EXPECT_EQ(h1.GetTotalNumBins(), Bins + 2);
+  EXPECT_EQ(h1.GetNumDimensions(), 1);
+  // The flow bins need an additional page.
+  EXPECT_EQ(h1.GetNumPages(), 11);
+  EXPECT_EQ(h1.GetNumUsedPages(), 0);
+  EXPECT_EQ(h1.GetBinContent(0), 0);
+}
+
+TEST(PagedHist, Fill) {
+  static constexpr std::size_t Bins = 10 * PageBins;
+  EPHist::PagedHist<int> h1(Bins, 0, Bins);
+
+  h1.Fill(1);
+  h1.Fill(std::make_tuple(2));
+  h1.Fill<EPHist::RegularAxis>(3 * PageBins);
+  const double x[] = {1, 2 * PageBins};
+  h1.FillN(2, x);
+  EXPECT_EQ(h1.GetNumUsedPages(), 3);
+
+  EXPECT_EQ(h1.GetBinContentAt(EPHist::BinIndex(1)), 2);
+  EXPECT_EQ(h1.GetBinContent(2), 1);
+  EXPECT_EQ(h1.GetBinContent(2 * PageBins), 1);
+  EXPECT_EQ(h1.GetBinContent(3 * PageBins), 1);
+  EXPECT_EQ(h1.GetBinContent(4 * PageBins), 0);
+
+  EXPECT_THROW(h1.Fill(1, 2), std::invalid_argument);
+  EXPECT_THROW(h1.FillN(2, x, x), std::invalid_argument);
+}
+
+TEST(PagedHist, FillWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::PagedHist<double> h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i, EPHist::Weight(0.5 + i * 0.1));
+    h1.Fill(std::make_tuple(i), EPHist::Weight(0.5));
+  }
+  const double x[] = {1};
+  const double weights[] = {2};
+  h1.FillN(1, std::make_tuple(x), weights);
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h1.GetBinContent(i), 1 + i * 0.1 + (i == 1 ? 2 : 0));
+  }
+}
+
+TEST(PagedHist, Add) {
+  static constexpr std::size_t Bins = 10 * PageBins;
+  EPHist::PagedHist<int> hA(Bins, 0, Bins);
+  EPHist::PagedHist<int> hB(Bins, 0, Bins);
+  EPHist::PagedHist<int> hC(Bins + 1, 0, Bins);
+
+  hA.Fill(1);
+  hB.Fill(1);
+  hB.Fill(5 * PageBins);
+  hA.Add(hB);
+  EXPECT_EQ(hA.GetBinContent(1), 2);
+  EXPECT_EQ(hA.GetBinContent(5 * PageBins), 1);
+  EXPECT_EQ(hA.GetNumUsedPages(), 2);
+  EXPECT_THROW(hA.Add(hC), std::invalid_argument);
+
+  EPHist::EPHist<int> dense(Bins, 0, Bins);
+  dense.Fill(1);
+  hA.AddTo(dense);
+  hA.AddAtomicTo(dense);
+  EXPECT_EQ(dense.GetBinContent(1), 5);
+  EXPECT_EQ(dense.GetBinContent(5 * PageBins), 2);
+  EPHist::EPHist<int> denseOther(Bins + 1, 0, Bins);
+  EXPECT_THROW(hA.AddTo(denseOther), std::invalid_argument);
+
+  auto hD = hA.Clone();
+  hA.Clear();
+  // The pages are kept for reuse, but not in use until written again.
+  EXPECT_EQ(hA.GetNumUsedPages(), 0);
+  EXPECT_EQ(hA.GetBinContent(1), 0);
+  EXPECT_EQ(hD.GetBinContent(1), 2);
+  hA.Fill(5 * PageBins);
+  EXPECT_EQ(hA.GetNumUsedPages(), 1);
+  EXPECT_EQ(hA.GetBinContent(5 * PageBins), 1);
+}
+
+TEST(PagedHist, ToEPHist) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::PagedHist<int> paged({axis, axis});
+  EPHist::EPHist<int> dense({axis, axis});
+  for (std::size_t i = 0; i < Bins; i += 3) {
+    paged.Fill(i, Bins - 1 - i);
+    dense.Fill(i, Bins - 1 - i);
+  }
+
+  auto converted = paged.ToEPHist();
+  ASSERT_EQ(converted.GetTotalNumBins(), dense.GetTotalNumBins());
+  for (std::size_t i = 0; i < dense.GetTotalNumBins(); i++) {
+    EXPECT_EQ(converted.GetBinContent(i), dense.GetBinContent(i));
+  }
+}
@@ -2,8 +2,13 @@
 
 #include <EPHist/DoubleBinWithError.hxx>
 #include <EPHist/EPHist.hxx>
+#include <EPHist/FillBuffer.hxx>
+#include <EPHist/FillContext.hxx>
+#include <EPHist/HotBinCache.hxx>
+#include <EPHist/LocalBins.hxx>
 #include <EPHist/ParallelFillStrategy.hxx>
 #include <EPHist/ParallelHelper.hxx>
+#include <EPHist/Profile.hxx>
 #include <EPHist/RegularAxis.hxx>
 #include <EPHist/Weight.hxx>
 
@@ -15,8 +20,11 @@
 #endif
 
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 TEST(Parallel, FillInvalidNumberOfArguments) {
   static constexpr std::size_t Bins = 20;
@@ -168,7 +176,10 @@ TEST(Parallel, TemplatedFillWeightInvalidNumberOfArguments) {
 static constexpr EPHist::ParallelFillStrategy kAllStrategies[] = {
     EPHist::ParallelFillStrategy::Automatic,
     EPHist::ParallelFillStrategy::Atomic,
-    EPHist::ParallelFillStrategy::PerFillContext};
+    EPHist::ParallelFillStrategy::PerFillContext,
+    EPHist::ParallelFillStrategy::Sharded,
+    EPHist::ParallelFillStrategy::HotBinCache,
+    EPHist::ParallelFillStrategy::Buffered};
 static std::string PrintStrategy(
     const testing::TestParamInfo<EPHist::ParallelFillStrategy> &info) {
   switch (info.param) {
@@ -178,6 +189,12 @@ static std::string PrintStrategy(
     return "Atomic";
   case EPHist::ParallelFillStrategy::PerFillContext:
     return "PerFillContext";
+  case EPHist::ParallelFillStrategy::Sharded:
+    return "Sharded";
+  case EPHist::ParallelFillStrategy::HotBinCache:
+    return "HotBinCache";
+  case EPHist::ParallelFillStrategy::Buffered:
+    return "Buffered";
   }
   abort();
 }
@@ -200,6 +217,36 @@ TEST_P(ParallelHelperIntRegular1D, CreateFillContext) {
   auto context2 = helper.CreateFillContext();
 }
 
+TEST_P(ParallelHelperIntRegular1D, ReuseFillContext) {
+  static constexpr std::size_t Bins = 20;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1, GetParam());
+    auto context1 = helper.CreateFillContext();
+    auto context2 = helper.CreateFillContext();
+    context1->Fill(1);
+    context2->Fill(2);
+
+    // Released contexts are flushed and reused.
+    const auto *released = context1.get();
+    context1.reset();
+    auto context3 = helper.CreateFillContext();
+    EXPECT_EQ(context3.get(), released);
+    context3->Fill(1);
+    context3.reset();
+    context2.reset();
+    auto context4 = helper.CreateFillContext();
+    auto context5 = helper.CreateFillContext();
+    auto context6 = helper.CreateFillContext();
+    context6->Fill(3);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(1), 2);
+  EXPECT_EQ(h1->GetBinContent(2), 1);
+  EXPECT_EQ(h1->GetBinContent(3), 1);
+}
+
 TEST_P(ParallelHelperIntRegular1D, Fill) {
   static constexpr std::size_t Bins = 20;
   auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
@@ -685,3 +732,543 @@ TEST_P(ParallelHelperDoubleBinWithErrorRegular1D, TemplatedFillWeight) {
 
 INSTANTIATE_TEST_SUITE_P(Strategies, ParallelHelperDoubleBinWithErrorRegular1D,
                          testing::ValuesIn(kAllStrategies), PrintStrategy);
+
+TEST(ParallelHelperSharded, NumShards) {
+  static constexpr std::size_t Bins = 20;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  EPHist::ParallelHelper helper(h1, EPHist::ParallelFillStrategy::Sharded, 3);
+  EXPECT_EQ(helper.GetNumShards(), 3);
+  EPHist::ParallelHelper helperDefault(h1,
+                                       EPHist::ParallelFillStrategy::Sharded);
+  EXPECT_GE(helperDefault.GetNumShards(), 1);
+  EPHist::ParallelHelper helperAtomic(h1, EPHist::ParallelFillStrategy::Atomic,
+                                      3);
+  EXPECT_EQ(helperAtomic.GetNumShards(), 0);
+}
+
+TEST(ParallelHelperSharded, Flush) {
+  static constexpr std::size_t Bins = 20;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1, EPHist::ParallelFillStrategy::Sharded,
+                                  5);
+    {
+      std::vector<std::shared_ptr<EPHist::FillContext<int>>> contexts;
+      for (std::size_t c = 0; c < 7; c++) {
+        contexts.push_back(helper.CreateFillContext());
+      }
+      for (auto &context : contexts) {
+        for (std::size_t i = 0; i < Bins; i++) {
+          context->Fill(i);
+        }
+      }
+    }
+    // The histogram is only updated in Flush().
+    EXPECT_EQ(h1->GetBinContent(0), 0);
+    helper.Flush();
+    for (std::size_t i = 0; i < Bins; i++) {
+      EXPECT_EQ(h1->GetBinContent(i), 7);
+    }
+
+    // The shards are cleared, and filling can continue after Flush().
+    auto context = helper.CreateFillContext();
+    context->Fill(0);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(0), 8);
+  for (std::size_t i = 1; i < Bins; i++) {
+    EXPECT_EQ(h1->GetBinContent(i), 7);
+  }
+}
+
+TEST(ParallelHelperSharded, Threads) {
+  // Enough bins for the parallel reduction.
+  using ParallelHelper = EPHist::ParallelHelper<int>;
+  static constexpr std::size_t Bins = ParallelHelper::MinBinsParallelReduction;
+  static constexpr std::size_t Threads = 4;
+  static constexpr std::size_t Shards = 3;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    ParallelHelper helper(h1, EPHist::ParallelFillStrategy::Sharded, Shards);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        for (std::size_t i = 0; i < Bins; i++) {
+          context->Fill(i);
+        }
+        // Also fill one bin many times to create contention.
+        for (std::size_t i = 0; i < 1000; i++) {
+          context->Fill(0);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  EXPECT_EQ(h1->GetBinContent(0), Threads * 1001);
+  for (std::size_t i = 1; i < Bins; i++) {
+    ASSERT_EQ(h1->GetBinContent(i), Threads);
+  }
+}
+
+TEST(ParallelHelperPerFillContext, Flush) {
+  static constexpr std::size_t Bins = 1000;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1,
+                                  EPHist::ParallelFillStrategy::PerFillContext);
+    auto context = helper.CreateFillContext();
+    context->Fill(1);
+    EXPECT_EQ(h1->GetBinContent(1), 0);
+    context->Flush();
+    EXPECT_EQ(h1->GetBinContent(1), 1);
+
+    // Flushing again does not add the same fills twice.
+    context->Flush();
+    EXPECT_EQ(h1->GetBinContent(1), 1);
+    context->Fill(1);
+    context->Fill(Bins - 1);
+    context->Flush();
+    EXPECT_EQ(h1->GetBinContent(1), 2);
+    EXPECT_EQ(h1->GetBinContent(Bins - 1), 1);
+    context->Fill(2);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(1), 2);
+  EXPECT_EQ(h1->GetBinContent(2), 1);
+}
+
+TEST(ParallelHelperPerFillContext, Tasks) {
+  // Create a context per task, which reuses the released contexts and their
+  // local histograms.
+  static constexpr std::size_t Bins = 1000;
+  static constexpr std::size_t Threads = 4;
+  static constexpr std::size_t Tasks = 100;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1,
+                                  EPHist::ParallelFillStrategy::PerFillContext);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        for (std::size_t task = 0; task < Tasks; task++) {
+          auto context = helper.CreateFillContext();
+          context->Fill(task);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    // All fills were flushed when the contexts were released.
+    for (std::size_t i = 0; i < Tasks; i++) {
+      ASSERT_EQ(h1->GetBinContent(i), Threads);
+    }
+  }
+
+  EXPECT_EQ(h1->GetBinContent(Tasks), 0);
+}
+
+TEST(ParallelHelperPerFillContext, LocalBins) {
+  using LocalBins = EPHist::Internal::LocalBins<int>;
+  static constexpr std::size_t Bins = 10 * LocalBins::BlockBins + 1;
+  std::vector<int> data(Bins);
+
+  LocalBins local(data.data(), Bins);
+  local.Fill<false>(0, 0);
+  local.Fill<false>(1, 0);
+  local.Fill<false>(Bins - 1, 0);
+  EXPECT_EQ(local.GetNumDirtyBlocks(), 2);
+  local.Flush();
+  EXPECT_EQ(local.GetNumDirtyBlocks(), 0);
+  EXPECT_EQ(data[0], 1);
+  EXPECT_EQ(data[1], 1);
+  EXPECT_EQ(data[Bins - 1], 1);
+
+  local.Fill<false>(0, 0);
+  local.Flush();
+  EXPECT_EQ(data[0], 2);
+  EXPECT_EQ(data[1], 1);
+}
+
+TEST(ParallelHelperPerFillContext, PagedLocalHist) {
+  // Large enough for a lazily allocated local histogram.
+  using FillContext = EPHist::FillContext<double>;
+  static constexpr std::size_t Bins =
+      FillContext::MinBytesPagedLocalHist / sizeof(double);
+  static constexpr std::size_t Threads = 4;
+  auto h1 = std::make_shared<EPHist::EPHist<double>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1,
+                                  EPHist::ParallelFillStrategy::PerFillContext);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        // Only fill the first and the last bins.
+        context->Fill(0);
+        context->Fill(std::make_tuple(Bins - 1), EPHist::Weight(0.5));
+        const double x[] = {0, 1};
+        context->FillN(2, x);
+        // Flushing in between only adds the new fills.
+        context->Flush();
+        context->Fill(0);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  EXPECT_EQ(h1->GetBinContent(0), 3 * Threads);
+  EXPECT_EQ(h1->GetBinContent(1), Threads);
+  EXPECT_EQ(h1->GetBinContent(Bins - 1), 0.5 * Threads);
+  EXPECT_EQ(h1->GetBinContent(Bins / 2), 0);
+}
+
+TEST(ParallelHelperHotBinCache, Eviction) {
+  static constexpr std::size_t Bins = 1000;
+  static constexpr std::size_t CacheSize =
+      EPHist::Internal::HotBinCache<int>::Size;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1,
+                                  EPHist::ParallelFillStrategy::HotBinCache);
+    auto context = helper.CreateFillContext();
+    // Fill a hot bin, and then many other bins that map to the same slot of
+    // the cache and eventually evict it.
+    for (std::size_t i = 0; i < 100; i++) {
+      context->Fill(1);
+    }
+    for (std::size_t i = 1; i < Bins / CacheSize; i++) {
+      for (std::size_t j = 0; j < 50; j++) {
+        context->Fill(1 + i * CacheSize);
+      }
+    }
+    // The hot bin was evicted and added to the histogram, only the last bin
+    // is still cached.
+    static constexpr std::size_t Last = 1 + (Bins / CacheSize - 1) * CacheSize;
+    EXPECT_EQ(h1->GetBinContent(1), 100);
+    EXPECT_EQ(h1->GetBinContent(1 + CacheSize), 50);
+    EXPECT_LT(h1->GetBinContent(Last), 50);
+    context->Flush();
+    for (std::size_t i = 1; i < Bins / CacheSize; i++) {
+      EXPECT_EQ(h1->GetBinContent(1 + i * CacheSize), 50);
+    }
+    context->Fill(2);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(1), 100);
+  EXPECT_EQ(h1->GetBinContent(2), 1);
+}
+
+TEST(ParallelHelperHotBinCache, Threads) {
+  static constexpr std::size_t Bins = 1000;
+  static constexpr std::size_t Threads = 4;
+  auto h1 = std::make_shared<EPHist::EPHist<double>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1,
+                                  EPHist::ParallelFillStrategy::HotBinCache);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        // A few hot bins and many cold ones.
+        for (std::size_t i = 0; i < Bins; i++) {
+          context->Fill(i);
+          context->Fill(i % 4, EPHist::Weight(0.5));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (std::size_t i = 0; i < 4; i++) {
+    EXPECT_FLOAT_EQ(h1->GetBinContent(i), Threads * (1 + Bins / 4 * 0.5));
+  }
+  for (std::size_t i = 4; i < Bins; i++) {
+    ASSERT_FLOAT_EQ(h1->GetBinContent(i), Threads);
+  }
+}
+
+TEST(ParallelHelperBuffered, Commit) {
+  static constexpr std::size_t Capacity =
+      EPHist::Internal::FillBuffer<int>::Capacity;
+  static constexpr std::size_t Bins = 2 * Capacity;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1, EPHist::ParallelFillStrategy::Buffered);
+    auto context = helper.CreateFillContext();
+    // Fills of the same bin are aggregated in the buffer.
+    for (std::size_t i = 0; i < 10; i++) {
+      context->Fill(0);
+    }
+    for (std::size_t i = 1; i < Capacity - 1; i++) {
+      context->Fill(i);
+    }
+    // Nothing is committed before the buffer holds Capacity distinct bins.
+    EXPECT_EQ(h1->GetBinContent(0), 0);
+    context->Fill(Capacity - 1);
+    EXPECT_EQ(h1->GetBinContent(0), 10);
+    for (std::size_t i = 1; i < Capacity; i++) {
+      EXPECT_EQ(h1->GetBinContent(i), 1);
+    }
+    context->Fill(0);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(0), 11);
+}
+
+TEST(ParallelHelperBuffered, Threads) {
+  static constexpr std::size_t Bins = 1000;
+  static constexpr std::size_t Threads = 4;
+  auto h1 = std::make_shared<EPHist::EPHist<EPHist::DoubleBinWithError>>(
+      Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1, EPHist::ParallelFillStrategy::Buffered);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        for (std::size_t i = 0; i < Bins; i++) {
+          context->Fill(i);
+          context->Fill(i % 4, EPHist::Weight(0.5));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Aggregated weights must still contribute their squares individually.
+  for (std::size_t i = 0; i < 4; i++) {
+    auto &bin = h1->GetBinContent(i);
+    EXPECT_FLOAT_EQ(bin.fSum, Threads * (1 + Bins / 4 * 0.5));
+    EXPECT_FLOAT_EQ(bin.fSum2, Threads * (1 + Bins / 4 * 0.25));
+  }
+  for (std::size_t i = 4; i < Bins; i++) {
+    ASSERT_FLOAT_EQ(h1->GetBinContent(i).fSum, Threads);
+  }
+}
+
+TEST(ParallelHelperAutomatic, Decision) {
+  using Decision = EPHist::Internal::AutomaticStrategyDecision;
+  static constexpr std::size_t Small = Decision::MaxSmallHistogramBytes;
+  static constexpr std::size_t Large = Decision::MaxCopiesBytes;
+
+  auto d = Decision::Decide(Small);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::PerFillContext);
+  d = Decision::Decide(Large);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::Atomic);
+  d = Decision::Decide(2 * Small);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::Automatic);
+
+  // No contention in the probe, or with a single thread.
+  d = Decision::Decide(2 * Small, 64, 0);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::Atomic);
+  d = Decision::Decide(2 * Small, 1, 1);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::Atomic);
+
+  // With contention, use copies if they fit, or shards otherwise.
+  d = Decision::Decide(2 * Small, 64, 0.01);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::PerFillContext);
+  d = Decision::Decide(Large / 8, 64, 0.01);
+  EXPECT_EQ(d.fStrategy, EPHist::ParallelFillStrategy::Sharded);
+  EXPECT_EQ(d.fNumShards, 8);
+  EXPECT_FALSE(d.fReason.empty());
+}
+
+TEST(ParallelHelperAutomatic, Strategy) {
+  static constexpr std::size_t Bins = 20;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  EPHist::ParallelHelper helper(h1);
+  EXPECT_EQ(helper.GetStrategy(), EPHist::ParallelFillStrategy::PerFillContext);
+  EXPECT_FALSE(helper.GetStrategyReason().empty());
+
+  EPHist::ParallelHelper helperAtomic(h1, EPHist::ParallelFillStrategy::Atomic);
+  EXPECT_EQ(helperAtomic.GetStrategy(), EPHist::ParallelFillStrategy::Atomic);
+}
+
+TEST(ParallelHelperAutomatic, Probe) {
+  // Enough bins to require a contention probe.
+  using Decision = EPHist::Internal::AutomaticStrategyDecision;
+  static constexpr std::size_t Bins = 2 * Decision::MaxSmallHistogramBytes;
+  static constexpr std::size_t ProbeFills =
+      EPHist::FillContext<int>::ProbeFills;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  {
+    EPHist::ParallelHelper helper(h1);
+    ASSERT_EQ(helper.GetStrategy(), EPHist::ParallelFillStrategy::Automatic);
+
+    auto context1 = helper.CreateFillContext();
+    auto context2 = helper.CreateFillContext();
+    for (std::size_t i = 0; i < ProbeFills - 1; i++) {
+      context1->Fill(i % 4);
+    }
+    EXPECT_EQ(helper.GetStrategy(), EPHist::ParallelFillStrategy::Automatic);
+    // The last fill of the probe decides the strategy, and all contexts must
+    // switch to it.
+    context1->Fill(0);
+    EXPECT_NE(helper.GetStrategy(), EPHist::ParallelFillStrategy::Automatic);
+    EXPECT_FALSE(helper.GetStrategyReason().empty());
+
+    context1->Fill(1);
+    context2->Fill(2);
+    auto context3 = helper.CreateFillContext();
+    context3->Fill(3);
+  }
+
+  EXPECT_EQ(h1->GetBinContent(0), ProbeFills / 4 + 1);
+  EXPECT_EQ(h1->GetBinContent(1), ProbeFills / 4 + 1);
+  EXPECT_EQ(h1->GetBinContent(2), ProbeFills / 4 + 1);
+  EXPECT_EQ(h1->GetBinContent(3), ProbeFills / 4);
+}
+
+TEST(ParallelHelperAutomatic, ProbeFillN) {
+  using Decision = EPHist::Internal::AutomaticStrategyDecision;
+  static constexpr std::size_t Bins = 2 * Decision::MaxSmallHistogramBytes;
+  static constexpr std::size_t ProbeFills =
+      EPHist::FillContext<int>::ProbeFills;
+  auto h1 = std::make_shared<EPHist::EPHist<int>>(Bins, 0, Bins);
+
+  // The probe finishes in the middle of the array.
+  std::vector<double> x(ProbeFills + 1000);
+  for (std::size_t i = 0; i < x.size(); i++) {
+    x[i] = i;
+  }
+  {
+    EPHist::ParallelHelper helper(h1);
+    auto context = helper.CreateFillContext();
+    context->FillN(x.size(), x.data());
+    EXPECT_NE(helper.GetStrategy(), EPHist::ParallelFillStrategy::Automatic);
+  }
+
+  for (std::size_t i = 0; i < x.size(); i++) {
+    ASSERT_EQ(h1->GetBinContent(i), 1);
+  }
+  EXPECT_EQ(h1->GetBinContent(x.size()), 0);
+}
+
+class ParallelHelperProfile
+    : public testing::TestWithParam<EPHist::ParallelFillStrategy> {};
+
+TEST_P(ParallelHelperProfile, Threads) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr std::size_t Threads = 4;
+  static constexpr std::size_t Fills = 1000;
+  auto p = std::make_shared<EPHist::Profile<true>>(
+      std::vector<EPHist::AxisVariant>{EPHist::RegularAxis(Bins, 0, Bins)});
+
+  {
+    EPHist::ParallelHelper helper(p, GetParam());
+    EXPECT_NE(helper.GetStrategy(), EPHist::ParallelFillStrategy::Automatic);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < Threads; t++) {
+      threads.emplace_back([&helper] {
+        auto context = helper.CreateFillContext();
+        for (std::size_t j = 0; j < Fills; j++) {
+          for (std::size_t i = 0; i < Bins; i++) {
+            context->Fill(i, 2 * i);
+            context->Fill(std::make_tuple(i), 2 * i, EPHist::Weight(0.5));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = p->GetBinContentAt(EPHist::BinIndex(i));
+    const double entries = Threads * Fills;
+    EXPECT_FLOAT_EQ(binContent.fSumValues, 1.5 * entries * 2 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, 1.5 * entries * 4 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1.5 * entries);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1.25 * entries);
+  }
+}
+
+TEST_P(ParallelHelperProfile, Flush) {
+  static constexpr std::size_t Bins = 20;
+  auto p = std::make_shared<EPHist::Profile<false>>(
+      std::vector<EPHist::AxisVariant>{EPHist::RegularAxis(Bins, 0, Bins)});
+
+  EPHist::ParallelHelper helper(p, GetParam());
+  {
+    auto context = helper.CreateFillContext();
+    context->Fill(1, 2);
+    context->Flush();
+    EXPECT_FLOAT_EQ(p->GetBinContentAt(EPHist::BinIndex(1)).fSum, 1);
+  }
+  // The destructor of the context must not add the content again.
+  EXPECT_FLOAT_EQ(p->GetBinContentAt(EPHist::BinIndex(1)).fSumValues, 2);
+  EXPECT_FLOAT_EQ(p->GetBinContentAt(EPHist::BinIndex(1)).fSum, 1);
+}
+
+TEST_P(ParallelHelperProfile, ReuseFillContext) {
+  static constexpr std::size_t Bins = 20;
+  auto p = std::make_shared<EPHist::Profile<true>>(
+      std::vector<EPHist::AxisVariant>{EPHist::RegularAxis(Bins, 0, Bins)});
+
+  {
+    EPHist::ParallelHelper helper(p, GetParam());
+    auto context1 = helper.CreateFillContext();
+    context1->Fill(1, 2);
+
+    // Released contexts are flushed and reused.
+    const auto *released = context1.get();
+    context1.reset();
+    EXPECT_FLOAT_EQ(p->GetBinContentAt(EPHist::BinIndex(1)).fSum, 1);
+    auto context2 = helper.CreateFillContext();
+    EXPECT_EQ(context2.get(), released);
+    context2->Fill(std::make_tuple(1), 4, EPHist::Weight(0.5));
+    context2->Fill(std::make_tuple(2, 3));
+  }
+
+  auto &&bin1 = p->GetBinContentAt(EPHist::BinIndex(1));
+  EXPECT_FLOAT_EQ(bin1.fSumValues, 4);
+  EXPECT_FLOAT_EQ(bin1.fSumValues2, 12);
+  EXPECT_FLOAT_EQ(bin1.fSum, 1.5);
+  EXPECT_FLOAT_EQ(bin1.fSum2, 1.25);
+  EXPECT_FLOAT_EQ(p->GetBinContentAt(EPHist::BinIndex(2)).fSumValues, 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Strategies, ParallelHelperProfile,
+    testing::Values(EPHist::ParallelFillStrategy::Automatic,
+                    EPHist::ParallelFillStrategy::Atomic,
+                    EPHist::ParallelFillStrategy::PerFillContext),
+    PrintStrategy);
+
+TEST(ParallelHelperProfileStrategy, Unsupported) {
+  static constexpr std::size_t Bins = 20;
+  using ParallelHelper = EPHist::ParallelHelper<EPHist::Profile<true>>;
+  auto p = std::make_shared<EPHist::Profile<true>>(
+      std::vector<EPHist::AxisVariant>{EPHist::RegularAxis(Bins, 0, Bins)});
+
+  EXPECT_THROW(ParallelHelper(p, EPHist::ParallelFillStrategy::Sharded),
+               std::invalid_argument);
+  EXPECT_THROW(ParallelHelper(p, EPHist::ParallelFillStrategy::HotBinCache),
+               std::invalid_argument);
+  EXPECT_THROW(ParallelHelper(p, EPHist::ParallelFillStrategy::Buffered),
+               std::invalid_argument);
+}
@@ -376,3 +376,68 @@ TEST(ProfileWithoutError1D, FillTupleValueWeight) {
     EXPECT_FLOAT_EQ(binContent.fSum, weight);
   }
 }
+
+TEST(ProfileWithError1D, FillAtomic) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::Profile<true> withError({axis});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    withError.FillAtomic(i, 2 * i);
+    withError.FillAtomic(std::make_tuple(i), 2 * i,
+                         EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = withError.GetBinContentAt(EPHist::BinIndex(i));
+    const double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(binContent.fSumValues, (1 + weight) * 2 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, (1 + weight) * 4 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1 + weight);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1 + weight * weight);
+  }
+}
+
+TEST(ProfileWithError1D, AddAtomic) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::Profile<true> p1({axis});
+  EPHist::Profile<true> p2({axis});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    p1.Fill(i, 2 * i);
+    p2.Fill(i, 3 * i, EPHist::Weight(0.5));
+  }
+
+  p1.AddAtomic(p2);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = p1.GetBinContentAt(EPHist::BinIndex(i));
+    EXPECT_FLOAT_EQ(binContent.fSumValues, 2 * i + 0.5 * 3 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, 4 * i * i + 0.5 * 9 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1.5);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1.25);
+  }
+
+  EPHist::Profile<true> p3({EPHist::RegularAxis(Bins / 2, 0, Bins)});
+  EXPECT_THROW(p1.AddAtomic(p3), std::invalid_argument);
+}
+
+TEST(ProfileWithoutError1D, FillAtomic) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::Profile<false> withoutError({axis});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    withoutError.FillAtomic(std::make_tuple(i, 2 * i));
+    withoutError.FillAtomic(i, 2 * i, EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = withoutError.GetBinContentAt(EPHist::BinIndex(i));
+    const double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(binContent.fSumValues, (1 + weight) * 2 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, (1 + weight) * 4 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1 + weight);
+  }
+}
@@ -3,12 +3,16 @@
 #include <EPHist/BinIndex.hxx>
 #include <EPHist/EPHist.hxx>
 #include <EPHist/RegularAxis.hxx>
+#include <EPHist/SIMD.hxx>
 
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <limits>
+#include <random>
 #include <tuple>
 #include <variant>
+#include <vector>
 
 TEST(RegularAxis, Constructor) {
   static constexpr std::size_t Bins = 20;
@@ -146,6 +150,96 @@ TEST(RegularAxis, ComputeBin) {
   }
 }
 
+static void CheckComputeBinsRegular(
+    const EPHist::RegularAxis &axis,
+    void (*kernel)(const EPHist::Internal::RegularAxisParameters &,
+                   const double *, std::size_t, std::size_t *)) {
+  std::vector<double> x = {-std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::quiet_NaN(),
+                           axis.GetLow(),
+                           axis.GetHigh(),
+                           std::nextafter(axis.GetLow(), -1e300),
+                           std::nextafter(axis.GetHigh(), -1e300)};
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dis(axis.GetLow() - 1, axis.GetHigh() + 1);
+  // Use a number of values that is not a multiple of the vector width to
+  // exercise the scalar remainder loop.
+  for (std::size_t i = 0; i < 1001; i++) {
+    x.push_back(dis(gen));
+  }
+
+  EPHist::Internal::RegularAxisParameters p;
+  p.fLow = axis.GetLow();
+  p.fHigh = axis.GetHigh();
+  p.fInvBinWidth = axis.GetNumBins() / (axis.GetHigh() - axis.GetLow());
+  p.fUnderflowBin = axis.AreFlowBinsEnabled() ? axis.GetNumBins()
+                                              : EPHist::Internal::InvalidBin;
+  p.fOverflowBin = axis.AreFlowBinsEnabled() ? axis.GetNumBins() + 1
+                                             : EPHist::Internal::InvalidBin;
+
+  std::vector<std::size_t> bins(x.size());
+  kernel(p, x.data(), x.size(), bins.data());
+  for (std::size_t i = 0; i < x.size(); i++) {
+    auto axisBin = axis.ComputeBin(x[i]);
+    if (axisBin.second) {
+      EXPECT_EQ(bins[i], axisBin.first) << "x = " << x[i];
+    } else {
+      EXPECT_EQ(bins[i], EPHist::Internal::InvalidBin) << "x = " << x[i];
+    }
+  }
+
+  // Also check the dispatching member function.
+  std::vector<std::size_t> bins2(x.size());
+  axis.ComputeBins(x.data(), x.size(), bins2.data());
+  EXPECT_EQ(bins, bins2);
+}
+
+TEST(RegularAxis, ComputeBinsScalar) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::RegularAxis axisNoFlowBins(Bins, 0, Bins, /*enableFlowBins=*/false);
+  EPHist::RegularAxis axisOdd(37, -1.3, 2.9);
+
+  for (const auto &a : {axis, axisNoFlowBins, axisOdd}) {
+    CheckComputeBinsRegular(a, EPHist::Internal::ComputeBinsRegularScalar);
+  }
+}
+
+#ifdef EPHIST_SIMD_X86
+TEST(RegularAxis, ComputeBinsAVX2) {
+  if (EPHist::Internal::GetSIMDLevel() < EPHist::Internal::SIMDLevel::AVX2) {
+    // Not supported on this machine.
+    return;
+  }
+
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::RegularAxis axisNoFlowBins(Bins, 0, Bins, /*enableFlowBins=*/false);
+  EPHist::RegularAxis axisOdd(37, -1.3, 2.9);
+
+  for (const auto &a : {axis, axisNoFlowBins, axisOdd}) {
+    CheckComputeBinsRegular(a, EPHist::Internal::ComputeBinsRegularAVX2);
+  }
+}
+
+TEST(RegularAxis, ComputeBinsAVX512) {
+  if (EPHist::Internal::GetSIMDLevel() < EPHist::Internal::SIMDLevel::AVX512) {
+    // Not supported on this machine.
+    return;
+  }
+
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::RegularAxis axisNoFlowBins(Bins, 0, Bins, /*enableFlowBins=*/false);
+  EPHist::RegularAxis axisOdd(37, -1.3, 2.9);
+
+  for (const auto &a : {axis, axisNoFlowBins, axisOdd}) {
+    CheckComputeBinsRegular(a, EPHist::Internal::ComputeBinsRegularAVX512);
+  }
+}
+#endif
+
 TEST(RegularAxis, Slice) {
   static constexpr std::size_t Bins = 20;
   EPHist::RegularAxis axis(Bins, 0, Bins);
@@ -7,6 +7,11 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
 TEST(Slicing, MixedTypes) {
   static constexpr std::size_t Bins = 20;
   EPHist::RegularAxis regularAxis(Bins, 0, Bins);
@@ -407,3 +412,83 @@ TEST(Slicing, Slice3D) {
     EXPECT_EQ(sliced.GetBinContentAt(overflow, overflow, overflow), 61);
   }
 }
+
+TEST(Slicing, CategoricalOverflow) {
+  std::vector<std::string> categories = {"a", "b", "c", "d"};
+  EPHist::CategoricalAxis categoricalAxis(categories);
+  EPHist::EPHist<int> h1(categoricalAxis);
+  for (auto &&category : categories) {
+    h1.Fill(category);
+  }
+  h1.Fill("e");
+
+  // Categories before and after the range go into the overflow bin.
+  const auto slice = h1.Slice(EPHist::BinIndexRange(1, 3));
+  ASSERT_EQ(slice.GetTotalNumBins(), 3);
+  EXPECT_EQ(slice.GetBinContent(0), 1);
+  EXPECT_EQ(slice.GetBinContent(1), 1);
+  EXPECT_EQ(slice.GetBinContent(2), 3);
+}
+
+TEST(Slicing, Slice4DMixedTypes) {
+  EPHist::RegularAxis regularAxis(10, 0, 10);
+  EPHist::RegularAxis noFlowAxis(6, 0, 6, /*enableFlowBins=*/false);
+  EPHist::VariableBinAxis variableBinAxis({0, 1, 2, 4, 8, 16});
+  std::vector<std::string> categories = {"a", "b", "c", "d"};
+  EPHist::CategoricalAxis categoricalAxis(categories);
+  const std::vector<EPHist::AxisVariant> axes = {
+      regularAxis, variableBinAxis, categoricalAxis, noFlowAxis};
+
+  EPHist::EPHist<int> h(axes);
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dist(-1, 17);
+  std::uniform_int_distribution<> categoryDist(0, categories.size());
+  for (std::size_t i = 0; i < 10000; i++) {
+    const double x = dist(gen), y = dist(gen), z = dist(gen) / 2;
+    const std::size_t c = categoryDist(gen);
+    const std::string category = c < categories.size() ? categories[c] : "e";
+    h.Fill(x, y, category, z);
+  }
+
+  const std::array<EPHist::BinIndexRange, 4> ranges = {
+      EPHist::BinIndexRange(2, 7), EPHist::BinIndexRange(1, 4),
+      EPHist::BinIndexRange(1, 3), EPHist::BinIndexRange(1, 5)};
+  const auto slice = h.Slice(ranges);
+  // Walk all bins of the original histogram to compute the reference, instead
+  // of using the runs of bins computed by SliceBinMap.
+  const EPHist::Detail::Axes origAxes(axes);
+  const EPHist::Detail::Axes sliceAxes(slice.GetAxes());
+  std::vector<int> reference(slice.GetTotalNumBins());
+  origAxes.ForEachSliceBin(ranges, sliceAxes,
+                           [&](std::size_t origBin, std::size_t sliceBin) {
+                             reference[sliceBin] += h.GetBinContent(origBin);
+                           });
+  for (std::size_t bin = 0; bin < slice.GetTotalNumBins(); bin++) {
+    EXPECT_EQ(slice.GetBinContent(bin), reference[bin]);
+  }
+}
+
+TEST(Slicing, Threads) {
+  // Enough bins to be split between threads, see BulkOperations.hxx.
+  static constexpr std::size_t Bins = 80;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::EPHist<int> h({axis, axis, axis});
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dist(-1, Bins + 1);
+  for (std::size_t i = 0; i < 100000; i++) {
+    h.Fill(dist(gen), dist(gen), dist(gen));
+  }
+
+  const auto range = EPHist::BinIndexRange(10, 70);
+  const std::array<EPHist::BinIndexRange, 3> ranges = {range, range, range};
+  const auto slice = h.Slice(ranges);
+  const auto sliceThreads = h.Slice(ranges, 4);
+  ASSERT_EQ(slice.GetAxes(), sliceThreads.GetAxes());
+  int sum = 0;
+  for (std::size_t bin = 0; bin < slice.GetTotalNumBins(); bin++) {
+    ASSERT_EQ(slice.GetBinContent(bin), sliceThreads.GetBinContent(bin));
+    sum += slice.GetBinContent(bin);
+  }
+  // All entries end up in some bin of the slice.
+  EXPECT_EQ(sum, 100000);
+}
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/BinIndexRange.hxx>
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/Profile.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/SoAHist.hxx>
+#include <EPHist/SoAProfile.hxx>
+#include <EPHist/Weight.hxx>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using SoAHist = EPHist::SoAHist<EPHist::DoubleBinWithError>;
+
+TEST(SoAHist, Constructor) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  SoAHist h1(axis);
+  EXPECT_EQ(h1.GetTotalNumBins(), Bins + 2);
+  EXPECT_EQ(h1.GetNumDimensions(), 1);
+  EXPECT_EQ(SoAHist::NumColumns, 2);
+
+  SoAHist h2({axis, axis});
+  EXPECT_EQ(h2.GetTotalNumBins(), (Bins + 2) * (Bins + 2));
+  EXPECT_EQ(h2.GetColumn(0).size(), (Bins + 2) * (Bins + 2));
+  EXPECT_THROW(h2.GetColumn(2), std::invalid_argument);
+}
+
+TEST(SoAHist, Fill) {
+  static constexpr std::size_t Bins = 20;
+  SoAHist h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i);
+    h1.Fill(std::make_tuple(i), EPHist::Weight(0.5 + i * 0.1));
+  }
+  h1.Fill(-100);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto &&binContent = h1.GetBinContentAt(EPHist::BinIndex(i));
+    const double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(binContent.fSum, 1 + weight);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1 + weight * weight);
+    EXPECT_FLOAT_EQ(h1.GetColumn(0)[i], 1 + weight);
+    EXPECT_FLOAT_EQ(h1.GetColumn(1)[i], 1 + weight * weight);
+  }
+  EXPECT_EQ(h1.GetBinContentAt(EPHist::BinIndex::Underflow()).fSum, 1);
+}
+
+TEST(SoAHist, FillInvalidNumberOfArguments) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  SoAHist h2({axis, axis});
+
+  EXPECT_THROW(h2.Fill(1), std::invalid_argument);
+  EXPECT_NO_THROW(h2.Fill(1, 2));
+  EXPECT_THROW(h2.Fill(1, 2, 3), std::invalid_argument);
+  EXPECT_THROW(h2.Fill(1, EPHist::Weight(1)), std::invalid_argument);
+  EXPECT_NO_THROW(h2.Fill(1, 2, EPHist::Weight(1)));
+  EXPECT_THROW(h2.Fill(std::make_tuple(1)), std::invalid_argument);
+  EXPECT_THROW(h2.FillAtomic(std::make_tuple(1), EPHist::Weight(1)),
+               std::invalid_argument);
+}
+
+TEST(SoAHist, FillAtomicThreads) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr std::size_t Threads = 4;
+  static constexpr std::size_t Fills = 1000;
+  SoAHist h1(Bins, 0, Bins);
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < Threads; t++) {
+    threads.emplace_back([&h1] {
+      for (std::size_t j = 0; j < Fills; j++) {
+        for (std::size_t i = 0; i < Bins; i++) {
+          h1.FillAtomic(i);
+          h1.FillAtomic(i, EPHist::Weight(0.5));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    auto binContent = h1.GetBinContent(i);
+    EXPECT_FLOAT_EQ(binContent.fSum, Threads * Fills * 1.5);
+    EXPECT_FLOAT_EQ(binContent.fSum2, Threads * Fills * 1.25);
+  }
+}
+
+TEST(SoAHist, AddClearClone) {
+  static constexpr std::size_t Bins = 20;
+  SoAHist h1(Bins, 0, Bins);
+  SoAHist h2(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i, EPHist::Weight(2));
+    h2.Fill(i);
+  }
+
+  h1.Add(h2);
+  h1.AddAtomic(h2);
+  SoAHist h3 = h1.Clone();
+  h1.Clear();
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_EQ(h1.GetBinContent(i).fSum, 0);
+    EXPECT_EQ(h1.GetBinContent(i).fSum2, 0);
+    EXPECT_EQ(h3.GetBinContent(i).fSum, 4);
+    EXPECT_EQ(h3.GetBinContent(i).fSum2, 6);
+  }
+
+  SoAHist h4(Bins / 2, 0, Bins);
+  EXPECT_THROW(h1.Add(h4), std::invalid_argument);
+  EXPECT_THROW(h1.AddAtomic(h4), std::invalid_argument);
+}
+
+TEST(SoAHist, Convert) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::DoubleBinWithError> h1(Bins, 0, Bins);
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i, EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  SoAHist soa(h1);
+  auto h2 = soa.ToEPHist();
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(soa.GetBinContent(i).fSum, h1.GetBinContent(i).fSum);
+    EXPECT_EQ(soa.GetBinContent(i).fSum2, h1.GetBinContent(i).fSum2);
+    EXPECT_EQ(h2.GetBinContent(i).fSum, h1.GetBinContent(i).fSum);
+    EXPECT_EQ(h2.GetBinContent(i).fSum2, h1.GetBinContent(i).fSum2);
+  }
+}
+
+TEST(SoAHist, Slice) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::EPHist<EPHist::DoubleBinWithError> h2({axis, axis});
+  SoAHist soa({axis, axis});
+  for (std::size_t i = 0; i < Bins; i++) {
+    for (std::size_t j = 0; j < Bins; j++) {
+      h2.Fill(i, j, EPHist::Weight(i + 0.5 * j));
+      soa.Fill(i, j, EPHist::Weight(i + 0.5 * j));
+    }
+  }
+
+  auto range = EPHist::BinIndexRange(5, 15);
+  auto expected = h2.Slice(range, EPHist::BinIndexRange::Full(Bins));
+  auto slice = soa.Slice(range, EPHist::BinIndexRange::Full(Bins));
+  ASSERT_EQ(slice.GetTotalNumBins(), expected.GetTotalNumBins());
+  for (std::size_t i = 0; i < expected.GetTotalNumBins(); i++) {
+    EXPECT_EQ(slice.GetBinContent(i).fSum, expected.GetBinContent(i).fSum);
+    EXPECT_EQ(slice.GetBinContent(i).fSum2, expected.GetBinContent(i).fSum2);
+  }
+
+  EXPECT_THROW(soa.Slice(range), std::invalid_argument);
+}
+
+TEST(SoAProfile, Fill) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SoAProfile<true> withError({axis});
+  EPHist::SoAProfile<false> withoutError({axis});
+  EXPECT_EQ(EPHist::SoAProfile<true>::NumColumns, 4);
+  EXPECT_EQ(EPHist::SoAProfile<false>::NumColumns, 3);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    const EPHist::Weight w(0.5 + i * 0.1);
+    withError.Fill(i, 2 * i);
+    withError.Fill(std::make_tuple(i), 2 * i, w);
+    withoutError.FillAtomic(std::make_tuple(i, 2 * i));
+    withoutError.FillAtomic(i, 2 * i, w);
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    const double weight = 0.5 + i * 0.1;
+    auto binContent = withError.GetBinContentAt(EPHist::BinIndex(i));
+    EXPECT_FLOAT_EQ(binContent.fSumValues, (1 + weight) * 2 * i);
+    EXPECT_FLOAT_EQ(binContent.fSumValues2, (1 + weight) * 4 * i * i);
+    EXPECT_FLOAT_EQ(binContent.fSum, 1 + weight);
+    EXPECT_FLOAT_EQ(binContent.fSum2, 1 + weight * weight);
+
+    auto binContentWithoutError = withoutError.GetBinContent(i);
+    EXPECT_FLOAT_EQ(binContentWithoutError.fSumValues, (1 + weight) * 2 * i);
+    EXPECT_FLOAT_EQ(withoutError.GetColumn(2)[i], 1 + weight);
+  }
+}
+
+TEST(SoAProfile, FillInvalidNumberOfArguments) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SoAProfile<true> p2({axis, axis});
+
+  EXPECT_THROW(p2.Fill(1, 2), std::invalid_argument);
+  EXPECT_NO_THROW(p2.Fill(1, 2, 3));
+  EXPECT_THROW(p2.Fill(1, 2, 3, 4), std::invalid_argument);
+  EXPECT_THROW(p2.Fill(1, 2, EPHist::Weight(1)), std::invalid_argument);
+  EXPECT_NO_THROW(p2.Fill(1, 2, 3, EPHist::Weight(1)));
+  EXPECT_THROW(p2.Fill(std::make_tuple(1), 2), std::invalid_argument);
+  EXPECT_THROW(p2.FillAtomic(std::make_tuple(1, 2), EPHist::Weight(1)),
+               std::invalid_argument);
+}
+
+TEST(SoAProfile, AddConvertSlice) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::Profile<true> p1({axis});
+  for (std::size_t i = 0; i < Bins; i++) {
+    p1.Fill(i, 2 * i, EPHist::Weight(0.5));
+  }
+
+  EPHist::SoAProfile<true> soa(p1);
+  soa.Add(EPHist::SoAProfile<true>(p1));
+  p1.Add(p1.Clone());
+  auto p2 = soa.ToProfile();
+  auto clone = soa.Clone();
+  for (std::size_t i = 0; i < p1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(p2.GetBinContent(i).fSumValues, p1.GetBinContent(i).fSumValues);
+    EXPECT_EQ(p2.GetBinContent(i).fSum2, p1.GetBinContent(i).fSum2);
+    EXPECT_EQ(clone.GetBinContent(i).fSum, p1.GetBinContent(i).fSum);
+  }
+
+  auto slice = soa.Slice(EPHist::BinIndexRange(5, 15));
+  ASSERT_EQ(slice.GetTotalNumBins(), 12);
+  EXPECT_FLOAT_EQ(slice.GetBinContentAt(EPHist::BinIndex(0)).fSumValues, 10);
+  EXPECT_FLOAT_EQ(slice.GetBinContentAt(EPHist::BinIndex::Underflow()).fSum,
+                  5);
+
+  soa.Clear();
+  EXPECT_EQ(soa.GetBinContent(1).fSum, 0);
+}
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/BinIndexRange.hxx>
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/SparseHist.hxx>
+#include <EPHist/Weight.hxx>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+TEST(SparseHist, Constructor) {
+  // A 5D histogram with 102^5 (more than 10^10) bins must not allocate them.
+  static constexpr std::size_t Bins = 100;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SparseHist<int> h5({axis, axis, axis, axis, axis});
+  EXPECT_EQ(h5.GetNumDimensions(), 5);
+  EXPECT_EQ(h5.GetTotalNumBins(), 11040808032);
+  EXPECT_EQ(h5.GetNumStoredBins(), 0);
+  EXPECT_EQ(h5.GetBinContentAt(1, 2, 3, 4, 5), 0);
+}
+
+TEST(SparseHist, Fill) {
+  static constexpr std::size_t Bins = 100;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SparseHist<int> h5({axis, axis, axis, axis, axis});
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h5.Fill(i, i, i, i, i);
+    h5.Fill(std::make_tuple(i, i, i, i, i));
+  }
+  h5.Fill(-1, 0, 0, 0, 0);
+  EXPECT_EQ(h5.GetNumStoredBins(), Bins + 1);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EPHist::BinIndex index(i);
+    EXPECT_EQ(h5.GetBinContentAt(index, index, index, index, index), 2);
+  }
+  EXPECT_EQ(h5.GetBinContentAt(0, 1, 0, 0, 0), 0);
+  EPHist::BinIndex zero(0);
+  EXPECT_EQ(
+      h5.GetBinContentAt(EPHist::BinIndex::Underflow(), zero, zero, zero, zero),
+      1);
+}
+
+TEST(SparseHist, FillWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::SparseHist<double> h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i, EPHist::Weight(0.5 + i * 0.1));
+    h1.Fill(std::make_tuple(i), EPHist::Weight(0.5));
+  }
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h1.GetBinContent(i), 1 + i * 0.1);
+  }
+}
+
+TEST(SparseHist, FillInvalidNumberOfArguments) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SparseHist<int> h2({axis, axis});
+
+  EXPECT_NO_THROW(h2.Fill(1, 2));
+  EXPECT_THROW(h2.Fill(1), std::invalid_argument);
+  EXPECT_THROW(h2.Fill(1, 2, 3), std::invalid_argument);
+  EXPECT_THROW(h2.FillAtomic(1), std::invalid_argument);
+  EXPECT_THROW(h2.GetBinContentAt(1), std::invalid_argument);
+}
+
+TEST(SparseHist, FillAtomic) {
+  static constexpr std::size_t Bins = 20;
+  static constexpr std::size_t NumThreads = 4;
+  static constexpr std::size_t Entries = 3 * Bins * Bins;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SparseHist<int> h2({axis, axis});
+  EPHist::SparseHist<double> h2Weighted({axis, axis});
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < NumThreads; t++) {
+    threads.emplace_back([&] {
+      for (std::size_t i = 0; i < Entries; i++) {
+        // Fill new bins concurrently to exercise inserting and growing.
+        h2.FillAtomic(i % Bins, i / Bins % Bins);
+        h2Weighted.FillAtomic(std::make_tuple(i % Bins, i / Bins % Bins),
+                              EPHist::Weight(0.5));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(h2.GetNumStoredBins(), Bins * Bins);
+  for (std::size_t i = 0; i < Bins; i++) {
+    for (std::size_t j = 0; j < Bins; j++) {
+      EPHist::BinIndex x(i), y(j);
+      EXPECT_EQ(h2.GetBinContentAt(x, y), 3 * NumThreads);
+      EXPECT_FLOAT_EQ(h2Weighted.GetBinContentAt(x, y), 1.5 * NumThreads);
+    }
+  }
+}
+
+TEST(SparseHist, Add) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::SparseHist<int> hA(Bins, 0, Bins);
+  EPHist::SparseHist<int> hB(Bins, 0, Bins);
+  EPHist::SparseHist<int> hC(Bins + 1, 0, Bins);
+
+  hA.Fill(1);
+  hB.Fill(1);
+  hB.Fill(2);
+  hA.Add(hB);
+  EXPECT_EQ(hA.GetBinContent(1), 2);
+  EXPECT_EQ(hA.GetBinContent(2), 1);
+  EXPECT_EQ(hA.GetNumStoredBins(), 2);
+
+  EXPECT_THROW(hA.Add(hC), std::invalid_argument);
+
+  auto hD = hA.Clone();
+  hA.Clear();
+  EXPECT_EQ(hA.GetNumStoredBins(), 0);
+  EXPECT_EQ(hA.GetBinContent(1), 0);
+  EXPECT_EQ(hD.GetBinContent(1), 2);
+}
+
+TEST(SparseHist, ToEPHist) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::SparseHist<int> sparse({axis, axis});
+  EPHist::EPHist<int> dense({axis, axis});
+  for (std::size_t i = 0; i < Bins; i += 3) {
+    sparse.Fill(i, Bins - 1 - i);
+    dense.Fill(i, Bins - 1 - i);
+  }
+
+  auto converted = sparse.ToEPHist();
+  ASSERT_EQ(converted.GetTotalNumBins(), dense.GetTotalNumBins());
+  for (std::size_t i = 0; i < dense.GetTotalNumBins(); i++) {
+    EXPECT_EQ(converted.GetBinContent(i), dense.GetBinContent(i));
+  }
+}
+
+TEST(SparseHist, Slice) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::CategoricalAxis categorical(std::vector<std::string>{"a", "b", "c"});
+  EPHist::EPHist<int> dense({axis, categorical, axis});
+  EPHist::SparseHist<int> sparse({axis, categorical, axis});
+  const std::string categories[] = {"a", "b", "c", "d"};
+  for (int i = -1; i <= static_cast<int>(Bins); i++) {
+    for (std::size_t j = 0; j < Bins; j += 2) {
+      dense.Fill(i, categories[j % 4], j);
+      sparse.Fill(i, categories[j % 4], j);
+    }
+  }
+
+  const EPHist::BinIndexRange ranges[] = {
+      EPHist::BinIndexRange(5, 15), EPHist::BinIndexRange(1, 2),
+      EPHist::BinIndexRange::Full(Bins)};
+  auto expected = dense.Slice(ranges[0], ranges[1], ranges[2]);
+  auto slice = sparse.Slice(ranges[0], ranges[1], ranges[2]);
+  ASSERT_EQ(slice.GetTotalNumBins(), expected.GetTotalNumBins());
+  for (std::size_t i = 0; i < expected.GetTotalNumBins(); i++) {
+    EXPECT_EQ(slice.GetBinContent(i), expected.GetBinContent(i));
+  }
+
+  EXPECT_THROW(sparse.Slice(ranges[0]), std::invalid_argument);
+}
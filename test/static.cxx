@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <EPHist/BinIndex.hxx>
+#include <EPHist/CategoricalAxis.hxx>
+#include <EPHist/DoubleBinWithError.hxx>
+#include <EPHist/EPHist.hxx>
+#include <EPHist/RegularAxis.hxx>
+#include <EPHist/StaticHist.hxx>
+#include <EPHist/VariableBinAxis.hxx>
+#include <EPHist/Weight.hxx>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST(StaticHist, Constructor) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::StaticHist<int, EPHist::RegularAxis> h1(axis);
+  EXPECT_EQ(h1.GetTotalNumBins(), Bins + 2);
+  EXPECT_EQ(h1.GetNumDimensions(), 1);
+  EXPECT_TRUE(std::get<0>(h1.GetAxes()) == axis);
+
+  EPHist::StaticHist<int, EPHist::RegularAxis, EPHist::RegularAxis> h2(axis,
+                                                                       axis);
+  EXPECT_EQ(h2.GetTotalNumBins(), (Bins + 2) * (Bins + 2));
+  EXPECT_EQ(h2.GetNumDimensions(), 2);
+}
+
+TEST(StaticHist, Add) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::StaticHist<int, EPHist::RegularAxis> hA(axis);
+  EPHist::StaticHist<int, EPHist::RegularAxis> hB(axis);
+  EPHist::RegularAxis axis2(Bins, 0, 2 * Bins);
+  EPHist::StaticHist<int, EPHist::RegularAxis> hC(axis2);
+
+  hA.Fill(8.5);
+  hB.Fill(9.5);
+  hA.Add(hB);
+  EXPECT_EQ(hA.GetBinContent(8), 1);
+  EXPECT_EQ(hA.GetBinContent(9), 1);
+
+  EXPECT_THROW(hA.Add(hC), std::invalid_argument);
+}
+
+TEST(StaticHist, Clone) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::StaticHist<int, EPHist::RegularAxis> hA(axis);
+  hA.Fill(8.5);
+
+  auto hB = hA.Clone();
+  hB.Fill(9.5);
+  EXPECT_EQ(hA.GetBinContent(9), 0);
+  EXPECT_EQ(hB.GetBinContent(8), 1);
+  EXPECT_EQ(hB.GetBinContent(9), 1);
+}
+
+TEST(StaticHist, Fill) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::StaticHist<int, EPHist::RegularAxis> h1(axis);
+
+  h1.Fill(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i);
+  }
+  h1.Fill(std::make_tuple(100));
+
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+  EXPECT_EQ(h1.GetBinContentAt(EPHist::BinIndex::Underflow()), 1);
+  EXPECT_EQ(h1.GetBinContentAt(EPHist::BinIndex::Overflow()), 1);
+}
+
+TEST(StaticHist, FillAtomic) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins, /*enableFlowBins=*/false);
+  EPHist::StaticHist<int, EPHist::RegularAxis> h1(axis);
+
+  h1.FillAtomic(-100);
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.FillAtomic(i);
+  }
+  h1.FillAtomic(100);
+
+  ASSERT_EQ(h1.GetTotalNumBins(), Bins);
+  for (std::size_t i = 0; i < h1.GetTotalNumBins(); i++) {
+    EXPECT_EQ(h1.GetBinContent(i), 1);
+  }
+}
+
+TEST(StaticHist, FillWeight) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis axis(Bins, 0, Bins);
+  EPHist::StaticHist<double, EPHist::RegularAxis> h1(axis);
+  EPHist::StaticHist<EPHist::DoubleBinWithError, EPHist::RegularAxis> h1E(
+      axis);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    const double weight = 0.5 + i * 0.1;
+    h1.Fill(i, EPHist::Weight(weight));
+    h1.FillAtomic(i, EPHist::Weight(weight));
+    h1E.Fill(i, EPHist::Weight(weight));
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    const double weight = 0.5 + i * 0.1;
+    EXPECT_FLOAT_EQ(h1.GetBinContentAt(i), 2 * weight);
+    auto &bin = h1E.GetBinContentAt(i);
+    EXPECT_FLOAT_EQ(bin.fSum, weight);
+    EXPECT_FLOAT_EQ(bin.fSum2, weight * weight);
+  }
+}
+
+TEST(StaticHist, FillMixed) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis regularAxis(Bins, 0, Bins);
+  std::vector<double> bins;
+  for (std::size_t i = 0; i <= Bins; i++) {
+    bins.push_back(i);
+  }
+  EPHist::VariableBinAxis variableBinAxis(bins);
+  const std::vector<std::string> categories = {"a", "b", "c"};
+  EPHist::CategoricalAxis categoricalAxis(categories);
+
+  EPHist::StaticHist<int, EPHist::RegularAxis, EPHist::VariableBinAxis,
+                     EPHist::CategoricalAxis>
+      hS(regularAxis, variableBinAxis, categoricalAxis);
+  EPHist::EPHist<int> h({regularAxis, variableBinAxis, categoricalAxis});
+  ASSERT_EQ(hS.GetTotalNumBins(), h.GetTotalNumBins());
+
+  // Both histograms must use the same bin layout.
+  for (int i = -1; i <= static_cast<int>(Bins); i++) {
+    for (int j = -1; j <= static_cast<int>(Bins); j += 3) {
+      for (const char *c : {"a", "b", "c", "d"}) {
+        hS.Fill(i + 0.5, j + 0.5, c);
+        h.Fill(i + 0.5, j + 0.5, c);
+      }
+    }
+  }
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    EXPECT_EQ(hS.GetBinContent(i), h.GetBinContent(i));
+  }
+  EXPECT_EQ(hS.GetBinContentAt(1, 2, EPHist::BinIndex::Overflow()), 1);
+}
+
+TEST(StaticHist, Conversion) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::RegularAxis regularAxis(Bins, 0, Bins);
+  std::vector<double> bins;
+  for (std::size_t i = 0; i <= Bins; i++) {
+    bins.push_back(i);
+  }
+  EPHist::VariableBinAxis variableBinAxis(bins);
+
+  using StaticHist =
+      EPHist::StaticHist<int, EPHist::RegularAxis, EPHist::VariableBinAxis>;
+  StaticHist hS(regularAxis, variableBinAxis);
+  for (std::size_t i = 0; i < Bins; i++) {
+    hS.Fill(i, Bins - 1 - i);
+  }
+
+  // Convert to a dynamic histogram and merge with another one.
+  auto h = hS.ToEPHist();
+  EXPECT_EQ(h.GetNumDimensions(), 2);
+  EPHist::EPHist<int> h2({regularAxis, variableBinAxis});
+  h2.Fill(0.5, 0.5);
+  h.Add(h2);
+  EXPECT_EQ(h.GetBinContentAt(0, Bins - 1), 1);
+  EXPECT_EQ(h.GetBinContentAt(0, 0), 1);
+
+  // And back.
+  auto hS2 = StaticHist::FromEPHist(h);
+  for (std::size_t i = 0; i < h.GetTotalNumBins(); i++) {
+    EXPECT_EQ(hS2.GetBinContent(i), h.GetBinContent(i));
+  }
+
+  // The axis types and the number of axes must match.
+  EPHist::EPHist<int> hRegular({regularAxis, regularAxis});
+  EXPECT_THROW(StaticHist::FromEPHist(hRegular), std::invalid_argument);
+  EPHist::EPHist<int> h1(regularAxis);
+  EXPECT_THROW(StaticHist::FromEPHist(h1), std::invalid_argument);
+}
@@ -6,7 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <limits>
+#include <random>
 #include <tuple>
 #include <vector>
 
@@ -172,6 +174,46 @@ TEST(VariableBinAxis, ComputeBin) {
   }
 }
 
+TEST(VariableBinAxis, ComputeBinSearch) {
+  // Test axes of different sizes to cover the linear search, the binary
+  // search, and the lookup table.
+  std::mt19937 gen;
+  for (std::size_t numBins : {1, 2, 5, 8, 9, 63, 64, 100, 1000, 10000}) {
+    // Create non-uniform bin edges with varying widths.
+    std::uniform_real_distribution<> width(0.001, 1);
+    std::vector<double> bins = {-1};
+    for (std::size_t i = 0; i < numBins; i++) {
+      double w = width(gen);
+      if (i % 7 == 0) {
+        // Create some clusters of very narrow bins.
+        w *= 1e-3;
+      }
+      bins.push_back(bins.back() + w);
+    }
+    EPHist::VariableBinAxis axis(bins);
+    ASSERT_EQ(axis.GetNumBins(), numBins);
+
+    // Check the bin edges themselves and values in between.
+    std::vector<double> x = bins;
+    std::uniform_real_distribution<> dis(bins.front(), bins.back());
+    for (std::size_t i = 0; i < 10000; i++) {
+      x.push_back(dis(gen));
+    }
+    for (double v : x) {
+      auto axisBin = axis.ComputeBin(v);
+      ASSERT_TRUE(axisBin.second);
+      if (v >= bins.back()) {
+        EXPECT_EQ(axisBin.first, numBins + 1);
+        continue;
+      }
+      auto it = std::upper_bound(bins.begin(), bins.end(), v);
+      const std::size_t expected = it - bins.begin() - 1;
+      EXPECT_EQ(axisBin.first, expected) << "numBins = " << numBins
+                                         << ", x = " << v;
+    }
+  }
+}
+
 TEST(VariableBinAxis, Slice) {
   static constexpr std::size_t Bins = 20;
   std::vector<double> bins;
@@ -2,6 +2,7 @@
 
 #include <EPHist/DoubleBinWithError.hxx>
 #include <EPHist/EPHist.hxx>
+#include <EPHist/FixedPointBin.hxx>
 #include <EPHist/Weight.hxx>
 
 #include <gtest/gtest.h>
@@ -182,3 +183,34 @@ TEST(DoubleBinWithErrorRegular1D, TemplatedFillWeight) {
     EXPECT_FLOAT_EQ(binWithError.fSum2, weight * weight);
   }
 }
+
+TEST(FixedPointBinRegular1D, Fill) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::FixedPointBin> h1(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    h1.Fill(i);
+    h1.Fill(i, EPHist::Weight(0.5 + i * 0.1));
+  }
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    EXPECT_FLOAT_EQ(h1.GetBinContent(i).GetValue(), 1.5 + i * 0.1);
+  }
+}
+
+TEST(FixedPointBinRegular1D, Add) {
+  static constexpr std::size_t Bins = 20;
+  EPHist::EPHist<EPHist::FixedPointBin> hA(Bins, 0, Bins);
+  EPHist::EPHist<EPHist::FixedPointBin> hB(Bins, 0, Bins);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    hA.Fill(i, EPHist::Weight(0.25));
+    hB.Fill(i, EPHist::Weight(-0.75));
+  }
+  hA.Add(hB);
+
+  for (std::size_t i = 0; i < Bins; i++) {
+    // Multiples of 2^-24 are represented exactly.
+    EXPECT_EQ(hA.GetBinContent(i).GetValue(), -0.5);
+  }
+}